@@ -0,0 +1,392 @@
+/**
+ * ET Output Path Benchmark
+ *
+ * Measures the frame builder's ET output path (BuilderThread::sendToET)
+ * end to end without a separately started ET system:
+ *  - LocalETSystem starts a private ET system inside this process
+ *    (et_system_start) with a configurable event count and event size, on
+ *    a temporary system file
+ *  - a drain consumer on its own blocking station takes every event the
+ *    builder puts into GRAND_CENTRAL and records the delivered rate and the
+ *    latency from the last slice of a frame entering the FrameBuilder to the
+ *    built frame reaching the consumer (keyed by user register 1, the
+ *    64-bit event number)
+ *  - the FrameBuilder is fed synthetic ROC frames for N streams; in-flight
+ *    frames are limited to half the ET events so latency is not dominated by
+ *    queueing in the builder FIFOs
+ *
+ * Every frame must be delivered exactly once; the benchmark fails otherwise.
+ * The ET system, station and temporary file are removed afterwards.
+ *
+ * Usage: et_path_bench [et_events] [et_event_size] [frames] [streams]
+ *                      [builder_threads] [words_per_roc] [server_port]
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <et.h>
+
+#include "e2sar_reassembler_framebuilder.hpp"
+#include "evio6/evio6_layout.hpp"
+#include "evio6/evio6_view.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// ============================================================================
+// Private Local ET System With a Drain Consumer
+// ============================================================================
+class LocalETSystem {
+private:
+    std::string systemFile;
+    et_sys_id systemId = nullptr;     // Handle of the in-process ET system
+    et_sys_id consumerId = nullptr;   // Client handle used by the drain thread
+    et_stat_id drainStation = 0;
+    et_att_id drainAttachment = 0;
+    bool systemStarted = false;
+    bool consumerOpen = false;
+    bool stationCreated = false;
+    bool attached = false;
+
+    std::thread drainThread;
+    std::atomic<bool> draining{false};
+
+    const std::vector<int64_t>* sendTimes = nullptr;
+    std::vector<uint8_t> seen;
+
+    void drainLoop() {
+        constexpr int CHUNK = 64;
+        et_event* events[CHUNK];
+        struct timespec wait = {0, 100 * 1000 * 1000};
+
+        while (draining) {
+            int count = 0;
+            int status = et_events_get(consumerId, drainAttachment, events, ET_TIMED, &wait, CHUNK, &count);
+            if (status == ET_ERROR_TIMEOUT || status == ET_ERROR_EMPTY) continue;
+            if (status != ET_OK) {
+                if (draining) {
+                    std::cerr << "ERROR: et_events_get failed: " << status << std::endl;
+                    getErrors++;
+                }
+                break;
+            }
+
+            const int64_t arrivalNs = nowNs();
+            for (int i = 0; i < count; i++) {
+                void* data = nullptr;
+                size_t length = 0;
+                et_event_getdata(events[i], &data);
+                et_event_getlength(events[i], &length);
+
+                evio6::RecordView record(static_cast<const uint8_t*>(data), length);
+                if (!record.valid()) {
+                    badEvents++;
+                    continue;
+                }
+                uint64_t eventNumber = record.userRegister1();
+                if (eventNumber >= seen.size() || seen[eventNumber]) {
+                    badEvents++;
+                    continue;
+                }
+                seen[eventNumber] = 1;
+                latenciesNs.push_back(arrivalNs - (*sendTimes)[eventNumber]);
+                bytes += length;
+                delivered++;
+            }
+
+            et_events_put(consumerId, drainAttachment, events, count);
+        }
+    }
+
+public:
+    // Drain results (latenciesNs and bytes are only read after stopDrain)
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> badEvents{0};    // Unparsable, unknown or duplicate frames
+    std::atomic<uint64_t> getErrors{0};
+    std::vector<int64_t> latenciesNs;
+    uint64_t bytes = 0;
+
+    ~LocalETSystem() { stop(); }
+
+    const std::string& file() const { return systemFile; }
+
+    /**
+     * Start the ET system and attach the drain consumer
+     *
+     * @return false (with a message on stderr) on any ET error
+     */
+    bool start(int events, size_t eventSize, int serverPort) {
+        systemFile = "/tmp/et_path_bench_" + std::to_string(getpid());
+        unlink(systemFile.c_str());
+
+        et_sysconfig config;
+        et_system_config_init(&config);
+        et_system_config_setevents(config, events);
+        et_system_config_setsize(config, eventSize);
+        et_system_config_setfile(config, systemFile.c_str());
+        et_system_config_setserverport(config, static_cast<unsigned short>(serverPort));
+        int status = et_system_start(&systemId, config);
+        et_system_config_destroy(config);
+        if (status != ET_OK) {
+            std::cerr << "ERROR: Cannot start local ET system " << systemFile << ": " << status << std::endl;
+            return false;
+        }
+        systemStarted = true;
+
+        et_openconfig openConfig;
+        et_open_config_init(&openConfig);
+        et_open_config_sethost(openConfig, ET_HOST_LOCAL);
+        et_open_config_setcast(openConfig, ET_DIRECT);
+        et_open_config_setserverport(openConfig, static_cast<unsigned short>(serverPort));
+        et_open_config_setwait(openConfig, ET_OPEN_WAIT);
+        struct timespec timeout = {10, 0};
+        et_open_config_settimeout(openConfig, timeout);
+        status = et_open(&consumerId, systemFile.c_str(), openConfig);
+        et_open_config_destroy(openConfig);
+        if (status != ET_OK) {
+            std::cerr << "ERROR: Cannot open local ET system " << systemFile << ": " << status << std::endl;
+            return false;
+        }
+        consumerOpen = true;
+
+        // Blocking station: every event passes through the drain consumer
+        et_statconfig stationConfig;
+        et_station_config_init(&stationConfig);
+        et_station_config_setblock(stationConfig, ET_STATION_BLOCKING);
+        et_station_config_setselect(stationConfig, ET_STATION_SELECT_ALL);
+        status = et_station_create(consumerId, &drainStation, "drain", stationConfig);
+        et_station_config_destroy(stationConfig);
+        if (status != ET_OK) {
+            std::cerr << "ERROR: Cannot create drain station: " << status << std::endl;
+            return false;
+        }
+        stationCreated = true;
+
+        status = et_station_attach(consumerId, drainStation, &drainAttachment);
+        if (status != ET_OK) {
+            std::cerr << "ERROR: Cannot attach to drain station: " << status << std::endl;
+            return false;
+        }
+        attached = true;
+        return true;
+    }
+
+    /**
+     * Start draining; frames are identified by event number 0..frames-1
+     */
+    void startDrain(const std::vector<int64_t>& sendTimesNs) {
+        sendTimes = &sendTimesNs;
+        seen.assign(sendTimesNs.size(), 0);
+        latenciesNs.reserve(sendTimesNs.size());
+        draining = true;
+        drainThread = std::thread(&LocalETSystem::drainLoop, this);
+    }
+
+    void stopDrain() {
+        if (!drainThread.joinable()) return;
+        draining = false;
+        et_wakeup_attachment(consumerId, drainAttachment);
+        drainThread.join();
+    }
+
+    /**
+     * Tear down consumer, station, system and the system file; safe to call more than once
+     */
+    void stop() {
+        stopDrain();
+        if (attached) {
+            et_station_detach(consumerId, drainAttachment);
+            attached = false;
+        }
+        if (stationCreated) {
+            et_station_remove(consumerId, drainStation);
+            stationCreated = false;
+        }
+        if (consumerOpen) {
+            et_close(consumerId);
+            consumerOpen = false;
+        }
+        if (systemStarted) {
+            et_system_close(systemId);
+            systemStarted = false;
+            unlink(systemFile.c_str());
+        }
+    }
+};
+
+// ============================================================================
+// Synthetic Input
+// ============================================================================
+/**
+ * Reassembled ROC frame as coda-fb receives it: 8-word block header
+ * (magic at word 7), ROC bank with SIB/TSS, then one data bank
+ */
+uint8_t* makeRocFrame(uint16_t rocId, uint32_t frameNumber, uint64_t timestamp,
+                      int payloadWords, size_t& bytes) {
+    std::vector<uint32_t> w = {
+        0, frameNumber, 8, 1, 0, 6, 0, evio6::MAGIC,
+        0, (static_cast<uint32_t>(rocId) << 16) | 0x1000,
+        4, (0xFF30u << 16) | 0x2000,
+        (0x31u << 24) | (1u << 16) | 3,
+        frameNumber, static_cast<uint32_t>(timestamp), static_cast<uint32_t>(timestamp >> 32),
+        static_cast<uint32_t>(payloadWords + 1), 3u << 16};
+    for (int i = 0; i < payloadWords; i++) {
+        w.push_back(frameNumber * 2654435761u + i);
+    }
+    w[evio6::RocFrame::ROC_BANK_LENGTH] = static_cast<uint32_t>(w.size() - evio6::RocFrame::ROC_BANK_HEADER);
+    w[evio6::RocFrame::BLOCK_LENGTH] = static_cast<uint32_t>(w.size());
+
+    bytes = w.size() * 4;
+    uint8_t* data = new uint8_t[bytes];
+    for (size_t i = 0; i < w.size(); i++) {
+        evio6::storeBE32(data + i * 4, w[i]);
+    }
+    return data;
+}
+
+/**
+ * Wait until at least 'target' frames were delivered
+ *
+ * @return false if delivery made no progress for 10 seconds
+ */
+bool waitForDelivered(const std::atomic<uint64_t>& delivered, uint64_t target) {
+    uint64_t last = delivered.load();
+    auto lastProgress = Clock::now();
+    while (delivered.load() < target) {
+        uint64_t d = delivered.load();
+        if (d != last) {
+            last = d;
+            lastProgress = Clock::now();
+        } else if (Clock::now() - lastProgress > std::chrono::seconds(10)) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+double percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t i = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[i] / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int etEvents = (argc > 1) ? std::atoi(argv[1]) : 256;
+    long etEventSize = (argc > 2) ? std::atol(argv[2]) : 256 * 1024;
+    int frames = (argc > 3) ? std::atoi(argv[3]) : 20000;
+    int streams = (argc > 4) ? std::atoi(argv[4]) : 3;
+    int threads = (argc > 5) ? std::atoi(argv[5]) : 2;
+    int wordsPerRoc = (argc > 6) ? std::atoi(argv[6]) : 1024;
+    int serverPort = (argc > 7) ? std::atoi(argv[7]) : 11311;
+
+    if (etEvents < 2 || etEventSize < 1024 || frames < 1 || streams < 1 || threads < 1 ||
+        wordsPerRoc < 0 || serverPort < 1 || serverPort > 65535) {
+        std::cerr << "Usage: " << argv[0] << " [et_events] [et_event_size] [frames] [streams]"
+                  << " [builder_threads] [words_per_roc] [server_port]\n";
+        return 1;
+    }
+
+    LocalETSystem et;
+    if (!et.start(etEvents, etEventSize, serverPort)) {
+        return 1;
+    }
+
+    std::vector<int64_t> sendTimesNs(frames, 0);
+    et.startDrain(sendTimesNs);
+
+    e2sar::FrameBuilder builder(et.file(), ET_HOST_LOCAL, serverPort, "", "frames",
+                                threads, static_cast<int>(etEventSize),
+                                0, 1000, streams, false);
+    if (!builder.start()) {
+        std::cerr << "ERROR: Frame builder failed to start" << std::endl;
+        return 1;
+    }
+
+    // ========================================================================
+    // Feed frames, at most etEvents/2 in flight
+    // ========================================================================
+    const uint64_t maxInFlight = static_cast<uint64_t>(etEvents / 2);
+    uint64_t inputBytes = 0;
+    auto t0 = Clock::now();
+
+    bool stalled = false;
+    for (int f = 0; f < frames && !stalled; f++) {
+        if (f >= static_cast<int>(maxInFlight)) {
+            stalled = !waitForDelivered(et.delivered, f - maxInFlight + 1);
+        }
+
+        const uint64_t timestamp = 65536ULL * 4 * f;
+        for (int s = 0; s < streams; s++) {
+            size_t bytes = 0;
+            uint8_t* data = makeRocFrame(static_cast<uint16_t>(s + 1), f, timestamp, wordsPerRoc, bytes);
+            inputBytes += bytes;
+            if (s == streams - 1) {
+                sendTimesNs[f] = nowNs();
+            }
+            builder.addTimeSlice(timestamp, f, static_cast<uint16_t>(s + 1), data, bytes);
+        }
+    }
+
+    // Wait for the tail, giving up after 10 seconds without progress
+    if (!stalled) {
+        stalled = !waitForDelivered(et.delivered, frames);
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    et.stopDrain();
+    builder.stop();
+    et.stop();
+
+    // ========================================================================
+    // Report
+    // ========================================================================
+    std::vector<int64_t> latencies = et.latenciesNs;
+    std::sort(latencies.begin(), latencies.end());
+    double meanUs = 0.0;
+    for (int64_t l : latencies) meanUs += l / 1000.0;
+    if (!latencies.empty()) meanUs /= latencies.size();
+
+    const uint64_t delivered = et.delivered.load();
+    std::cout << "=== ET Path Benchmark ===\n";
+    std::cout << "  ET Events: " << etEvents << " x " << etEventSize << " bytes\n";
+    std::cout << "  Frames: " << frames << " (" << streams << " streams x "
+              << (16 + 2 + wordsPerRoc) * 4 << " bytes)\n";
+    std::cout << "  Builder Threads: " << threads << "\n";
+    std::cout << "  Delivered: " << delivered << " (" << et.badEvents.load() << " bad)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Rate: " << (elapsed > 0 ? delivered / elapsed : 0.0) << " frames/sec, "
+              << (elapsed > 0 ? et.bytes / elapsed / 1e6 : 0.0) << " MB/sec out, "
+              << (elapsed > 0 ? inputBytes / elapsed / 1e6 : 0.0) << " MB/sec in\n";
+    std::cout << "  Latency: mean " << meanUs << " us, p50 " << percentile(latencies, 0.50)
+              << " us, p99 " << percentile(latencies, 0.99)
+              << " us, max " << percentile(latencies, 1.0) << " us\n";
+    std::cout << "=========================\n";
+
+    if (delivered != static_cast<uint64_t>(frames) || et.badEvents.load() != 0 || et.getErrors.load() != 0) {
+        std::cerr << "ERROR: " << delivered << " of " << frames << " frames delivered through ET, "
+                  << et.badEvents.load() << " bad events, " << et.getErrors.load() << " get errors" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,201 @@
+/**
+ * EVIO-6 View Overhead Benchmark
+ *
+ * Walks the same in-memory file of aggregated frames two ways:
+ *  - raw:  hand-written offset arithmetic on big-endian words (the style the
+ *          parser used before src/evio6)
+ *  - view: FileView -> RecordView -> AggregatedBankView -> TSS/AIS -> ROC banks
+ *
+ * Both walks visit every header field and every ROC payload word and fold
+ * them into a checksum; the checksums must match. The file is produced with
+ * the writer from evio6_writer.hpp, so this also checks that the views read
+ * back exactly what the writer produced.
+ *
+ * Usage: evio6_view_bench [rocs] [words_per_roc] [frames] [passes]
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+
+#include "evio6/evio6_view.hpp"
+#include "evio6/evio6_writer.hpp"
+
+namespace {
+
+// File header + one aggregated record per frame
+std::vector<uint8_t> makeFile(int rocs, int wordsPerRoc, int frames) {
+    std::mt19937 rng(12345);
+    std::vector<uint8_t> file(evio6::HEADER_BYTES);
+    evio6::encodeFileHeader(file.data());
+
+    // ROC banks: [length] [rocId | 0x10 | status] [payload words]
+    std::vector<std::vector<uint8_t>> rocBanks(rocs);
+    std::vector<uint8_t> record;
+
+    for (int f = 0; f < frames; f++) {
+        std::vector<evio6::SliceRef> slices;
+        for (int r = 0; r < rocs; r++) {
+            auto& bank = rocBanks[r];
+            bank.resize((2 + wordsPerRoc) * 4);
+            evio6::storeBE32(bank.data(), 1 + wordsPerRoc);
+            evio6::storeBE32(bank.data() + 4, evio6::bankHeader(r + 1, evio6::DataType::BANK, 0));
+            for (int w = 0; w < wordsPerRoc; w++) {
+                evio6::storeBE32(bank.data() + 8 + w * 4, rng());
+            }
+            slices.push_back({bank.data(), bank.size(), static_cast<uint16_t>(r + 1), 0});
+        }
+
+        evio6::FrameInfo info = {static_cast<uint32_t>(f + 1), static_cast<uint32_t>(f),
+                                 65536ULL * f, static_cast<uint8_t>(rocs)};
+        evio6::writeAggregatedRecord(info, slices.data(), slices.size(), record);
+        file.insert(file.end(), record.begin(), record.end());
+    }
+    return file;
+}
+
+inline uint64_t mix(uint64_t sum, uint64_t v) {
+    return (sum ^ v) * 0x100000001B3ULL;
+}
+
+// Raw walk: offsets computed by hand
+uint64_t walkRaw(const uint8_t* base, size_t size) {
+    using evio6::loadBE32;
+    uint64_t sum = 0;
+    size_t pos = loadBE32(base + 8) * 4;
+
+    while (pos + 56 <= size) {
+        size_t recEnd = pos + static_cast<size_t>(loadBE32(base + pos)) * 4;
+        if (recEnd > size) break;
+        size_t p = pos + loadBE32(base + pos + 8) * 4;
+
+        size_t aggEnd = p + (static_cast<size_t>(loadBE32(base + p)) + 1) * 4;
+        sum = mix(sum, loadBE32(base + p + 4) >> 16);
+        p += 8;
+        size_t sibEnd = p + (static_cast<size_t>(loadBE32(base + p)) + 1) * 4;
+        p += 8;
+
+        uint32_t tssHeader = loadBE32(base + p);
+        sum = mix(sum, loadBE32(base + p + 4));
+        sum = mix(sum, (static_cast<uint64_t>(loadBE32(base + p + 12)) << 32) | loadBE32(base + p + 8));
+        p += 4 + (tssHeader & 0xFFFF) * 4;
+
+        uint32_t rocCount = loadBE32(base + p) & 0xFFFF;
+        for (uint32_t i = 0; i < rocCount; i++) {
+            sum = mix(sum, loadBE32(base + p + 4 + i * 4) >> 16);
+        }
+
+        p = sibEnd;
+        while (p + 8 <= aggEnd) {
+            size_t rocEnd = p + (static_cast<size_t>(loadBE32(base + p)) + 1) * 4;
+            if (rocEnd > aggEnd) break;
+            sum = mix(sum, loadBE32(base + p + 4) >> 16);
+            for (size_t q = p + 8; q < rocEnd; q += 4) {
+                sum += loadBE32(base + q);
+            }
+            p = rocEnd;
+        }
+        pos = recEnd;
+    }
+    return sum;
+}
+
+// View walk: same visit order through the evio6 views
+uint64_t walkViews(const uint8_t* base, size_t size) {
+    uint64_t sum = 0;
+    evio6::FileView file(base, size);
+
+    for (evio6::RecordView record : file.records()) {
+        evio6::AggregatedBankView agg = evio6::aggregatedBank(record);
+        if (!agg.valid()) continue;
+        sum = mix(sum, agg.tag());
+
+        evio6::StreamInfoBankView sib = agg.streamInfo();
+        evio6::TimeSliceSegmentView tss = sib.timeSlice();
+        sum = mix(sum, tss.frameNumber());
+        sum = mix(sum, tss.timestamp());
+
+        evio6::AggregationInfoSegmentView ais = sib.aggregationInfo();
+        for (size_t i = 0; i < ais.rocCount(); i++) {
+            sum = mix(sum, ais.rocId(i));
+        }
+
+        for (evio6::RocBankView roc : agg.rocBanks()) {
+            sum = mix(sum, roc.rocId());
+            for (uint32_t word : roc.payloadWords()) {
+                sum += word;
+            }
+        }
+    }
+    return sum;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rocs = (argc > 1) ? std::atoi(argv[1]) : 8;
+    int wordsPerRoc = (argc > 2) ? std::atoi(argv[2]) : 256;
+    int frames = (argc > 3) ? std::atoi(argv[3]) : 2000;
+    int passes = (argc > 4) ? std::atoi(argv[4]) : 20;
+
+    if (rocs < 1 || wordsPerRoc < 0 || frames < 1 || passes < 1) {
+        std::cerr << "Usage: " << argv[0] << " [rocs] [words_per_roc] [frames] [passes]\n";
+        return 1;
+    }
+
+    std::vector<uint8_t> file = makeFile(rocs, wordsPerRoc, frames);
+
+    // Alternate which walk goes first and keep the best pass of each, so
+    // neither walk is favoured by cache state or clock ramp-up
+    using Clock = std::chrono::steady_clock;
+    double rawNs = 0;
+    double viewNs = 0;
+
+    auto timeWalk = [&file](uint64_t (*walk)(const uint8_t*, size_t), uint64_t& sum) {
+        auto t0 = Clock::now();
+        sum = walk(file.data(), file.size());
+        return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    };
+
+    uint64_t rawSum = 0;
+    uint64_t viewSum = 0;
+    for (int pass = 0; pass < passes; pass++) {
+        double r, v;
+        if (pass % 2 == 0) {
+            r = timeWalk(walkRaw, rawSum);
+            v = timeWalk(walkViews, viewSum);
+        } else {
+            v = timeWalk(walkViews, viewSum);
+            r = timeWalk(walkRaw, rawSum);
+        }
+        rawNs = (pass == 0) ? r : std::min(rawNs, r);
+        viewNs = (pass == 0) ? v : std::min(viewNs, v);
+
+        if (rawSum != viewSum) {
+            std::cerr << "ERROR: view walk checksum differs from raw walk\n";
+            return 1;
+        }
+    }
+
+    double bytes = static_cast<double>(file.size());
+    std::cout << "=== EVIO-6 View Overhead Benchmark ===\n";
+    std::cout << "  Frames: " << frames << " (" << rocs << " ROCs x "
+              << wordsPerRoc << " words)\n";
+    std::cout << "  File Size: " << file.size() << " bytes, Passes: " << passes << " (best pass shown)\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Raw pointer walk: " << (rawNs / frames) << " ns/frame, "
+              << (bytes / rawNs) << " GB/s\n";
+    std::cout << "  View walk:        " << (viewNs / frames) << " ns/frame, "
+              << (bytes / viewNs) << " GB/s\n";
+    std::cout << "  View/Raw time: " << (rawNs > 0 ? viewNs / rawNs : 0.0) << "x\n";
+    std::cout << "  Checksum: 0x" << std::hex << viewSum << std::dec << "\n";
+    std::cout << "======================================\n";
+    return 0;
+}
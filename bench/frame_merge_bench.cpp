@@ -0,0 +1,131 @@
+/**
+ * Frame-Level Hit Merge Benchmark
+ *
+ * Compares the two ways of producing one time-ordered FADC250 hit stream per
+ * aggregated frame:
+ *  - sort:  concatenate all per-slot hit runs, then std::stable_sort by time
+ *  - merge: k-way heap merge of the already-sorted runs (mergeTimeOrdered)
+ *
+ * Frames are synthesized with the shape evio_event_parser sees: one sorted
+ * run per (ROC, slot), hit times spread over the 14-bit, 4 ns time field.
+ * Both methods must produce identical streams; the benchmark fails otherwise.
+ *
+ * Usage: frame_merge_bench [rocs] [slots_per_roc] [hits_per_slot] [frames]
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+
+#include "fadc250.hpp"
+
+namespace {
+
+std::vector<FADCHitRun> makeFrame(std::mt19937_64& rng, int rocs, int slots, int hitsPerSlot,
+                                  uint64_t frameTimestamp) {
+    std::uniform_int_distribution<uint32_t> timeDist(0, 0x3FFF);
+    std::uniform_int_distribution<int> chanDist(0, 15);
+    std::uniform_int_distribution<int> chargeDist(0, 8191);
+
+    std::vector<FADCHitRun> runs;
+    runs.reserve(rocs * slots);
+    for (int roc = 1; roc <= rocs; roc++) {
+        for (int slot = 3; slot < 3 + slots; slot++) {
+            FADCHitRun run;
+            run.reserve(hitsPerSlot);
+            for (int h = 0; h < hitsPerSlot; h++) {
+                run.emplace_back(roc, slot, chanDist(rng), chargeDist(rng),
+                                 frameTimestamp + timeDist(rng) * 4ULL);
+            }
+            std::sort(run.begin(), run.end(),
+                      [](const FADCHit& a, const FADCHit& b) { return a.time < b.time; });
+            runs.push_back(std::move(run));
+        }
+    }
+    return runs;
+}
+
+bool sameStream(const std::vector<FADCHit>& a, const std::vector<FADCHit>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].time != b[i].time || a[i].crate != b[i].crate || a[i].slot != b[i].slot ||
+            a[i].channel != b[i].channel || a[i].charge != b[i].charge) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rocs = (argc > 1) ? std::atoi(argv[1]) : 3;
+    int slots = (argc > 2) ? std::atoi(argv[2]) : 16;
+    int hitsPerSlot = (argc > 3) ? std::atoi(argv[3]) : 64;
+    int frames = (argc > 4) ? std::atoi(argv[4]) : 2000;
+
+    if (rocs < 1 || slots < 1 || hitsPerSlot < 0 || frames < 1) {
+        std::cerr << "Usage: " << argv[0] << " [rocs] [slots_per_roc] [hits_per_slot] [frames]\n";
+        return 1;
+    }
+
+    std::mt19937_64 rng(12345);
+    std::vector<std::vector<FADCHitRun>> input;
+    input.reserve(frames);
+    for (int f = 0; f < frames; f++) {
+        input.push_back(makeFrame(rng, rocs, slots, hitsPerSlot, 65536ULL * 4 * f));
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<FADCHit> sorted;
+    std::vector<FADCHit> merged;
+    double sortNs = 0;
+    double mergeNs = 0;
+    uint64_t totalHits = 0;
+
+    for (const auto& runs : input) {
+        // Baseline: concatenate and sort the whole frame
+        auto t0 = Clock::now();
+        sorted.clear();
+        for (const auto& run : runs) {
+            sorted.insert(sorted.end(), run.begin(), run.end());
+        }
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const FADCHit& a, const FADCHit& b) { return a.time < b.time; });
+        auto t1 = Clock::now();
+
+        // K-way merge of the sorted runs
+        mergeTimeOrdered(runs, merged);
+        auto t2 = Clock::now();
+
+        sortNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        mergeNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+        totalHits += merged.size();
+
+        if (!sameStream(sorted, merged)) {
+            std::cerr << "ERROR: merged stream differs from sorted concatenation\n";
+            return 1;
+        }
+    }
+
+    std::cout << "=== Frame Hit Merge Benchmark ===\n";
+    std::cout << "  Frames: " << frames << "\n";
+    std::cout << "  Runs/Frame (k): " << (rocs * slots) << " (" << rocs << " ROCs x "
+              << slots << " slots)\n";
+    std::cout << "  Hits/Frame (n): " << (rocs * slots * hitsPerSlot) << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Sort concatenation: " << (sortNs / totalHits) << " ns/hit, "
+              << (sortNs / frames / 1000.0) << " us/frame\n";
+    std::cout << "  K-way merge:        " << (mergeNs / totalHits) << " ns/hit, "
+              << (mergeNs / frames / 1000.0) << " us/frame\n";
+    std::cout << "  Speedup: " << (mergeNs > 0 ? sortNs / mergeNs : 0.0) << "x\n";
+    std::cout << "=================================\n";
+    return 0;
+}
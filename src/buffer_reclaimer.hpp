@@ -0,0 +1,227 @@
+/**
+ * Deferred, Batched Release of Reassembled Payload Buffers
+ *
+ * Reassembled payloads are allocated by the E2SAR reassembler with new[],
+ * one buffer per event. Multi-MB buffers are above glibc's mmap threshold,
+ * so each delete[] is a munmap with a TLB shootdown on every core, paid by
+ * the thread that drops the buffer: a receive thread or a builder thread
+ * (the latter while holding its FIFO lock). BufferReclaimer takes large
+ * buffers off those threads and frees them in batches on a reclaimer thread.
+ *
+ * Buffers below minBytes are freed at once (cheap, from the arena). With the
+ * reclaimer disabled every buffer is freed at once, but the cost of freeing
+ * the large ones is still measured, so runs with and without deferral can be
+ * compared. If the reclaimer falls maxPendingBytes behind, buffers are freed
+ * inline again rather than piling up.
+ *
+ * Header-only, no dependencies beyond the standard library.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#ifndef CODA_FB_BUFFER_RECLAIMER_HPP
+#define CODA_FB_BUFFER_RECLAIMER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+namespace e2sar {
+
+/**
+ * Reclaimer statistics (see BufferReclaimer::getStatistics)
+ */
+struct ReclaimStats {
+    uint64_t largeBuffers;    // Buffers of at least minBytes released
+    uint64_t largeBytes;      // Their bytes
+    uint64_t hotNs;           // Time the releasing threads spent on them (enqueue or free)
+    uint64_t lockWaitNs;      // Time the releasing threads waited for the queue lock
+    uint64_t deferred;        // Buffers freed on the reclaimer thread
+    uint64_t inlineFrees;     // Large buffers freed at once: reclaimer off, stopped or too far behind
+    uint64_t batches;         // Batches freed by the reclaimer thread
+    uint64_t reclaimNs;       // Time the reclaimer thread spent freeing
+    size_t pending;           // Buffers waiting to be freed right now
+};
+
+class BufferReclaimer {
+private:
+    struct Buffer {
+        uint8_t* data;
+        size_t bytes;
+    };
+
+    const bool enabled;
+    const size_t minBytes;
+    const size_t batchSize;
+    const size_t maxPendingBytes;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Buffer> pending;
+    size_t pendingBytes = 0;
+    bool running = false;
+    std::thread thread;
+
+    std::atomic<uint64_t> largeBuffers{0};
+    std::atomic<uint64_t> largeBytes{0};
+    std::atomic<uint64_t> hotNs{0};
+    std::atomic<uint64_t> lockWaitNs{0};
+    std::atomic<uint64_t> deferred{0};
+    std::atomic<uint64_t> inlineFrees{0};
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> reclaimNs{0};
+    std::atomic<size_t> pendingCount{0};
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void threadFunc() {
+        std::vector<Buffer> batch;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running || !pending.empty()) {
+            // A full batch, or whatever is there every 20 ms
+            cv.wait_for(lock, std::chrono::milliseconds(20),
+                        [this] { return !running || pending.size() >= batchSize; });
+            if (pending.empty()) continue;
+
+            batch.swap(pending);
+            pendingBytes = 0;
+            lock.unlock();
+
+            uint64_t start = nowNs();
+            for (const Buffer& buffer : batch) {
+                delete[] buffer.data;
+            }
+            reclaimNs.fetch_add(nowNs() - start, std::memory_order_relaxed);
+            deferred.fetch_add(batch.size(), std::memory_order_relaxed);
+            pendingCount.fetch_sub(batch.size(), std::memory_order_relaxed);
+            batches.fetch_add(1, std::memory_order_relaxed);
+            batch.clear();
+
+            lock.lock();
+        }
+    }
+
+public:
+    /**
+     * Constructor (the reclaimer thread starts at once if enabled)
+     *
+     * @param enableDeferral  Free large buffers on the reclaimer thread
+     *                        (false: free at once, still measured)
+     * @param minBufferBytes  Buffers at least this large are deferred and
+     *                        measured (default: 128 KB, glibc's initial mmap threshold)
+     * @param batchBuffers    Buffers that wake the reclaimer early (default: 64)
+     * @param maxPending      Bytes waiting to be freed past which buffers are freed
+     *                        inline again (default: 1 GB)
+     */
+    explicit BufferReclaimer(bool enableDeferral = true,
+                             size_t minBufferBytes = 128 * 1024,
+                             size_t batchBuffers = 64,
+                             size_t maxPending = 1024ULL * 1024 * 1024)
+        : enabled(enableDeferral), minBytes(minBufferBytes),
+          batchSize(batchBuffers > 0 ? batchBuffers : 1), maxPendingBytes(maxPending) {
+        if (enabled) {
+            pending.reserve(batchSize * 2);
+            running = true;
+            thread = std::thread(&BufferReclaimer::threadFunc, this);
+        }
+    }
+
+    ~BufferReclaimer() { stop(); }
+
+    BufferReclaimer(const BufferReclaimer&) = delete;
+    BufferReclaimer& operator=(const BufferReclaimer&) = delete;
+
+    /**
+     * Release a new[]-allocated buffer (takes ownership). Thread-safe.
+     */
+    void retire(uint8_t* data, size_t bytes) {
+        if (data == nullptr) return;
+        if (bytes < minBytes) {
+            delete[] data;
+            return;
+        }
+
+        largeBuffers.fetch_add(1, std::memory_order_relaxed);
+        largeBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+        // Deferred: the enqueue is the release work; waiting for the lock is counted apart
+        if (enabled) {
+            uint64_t lockStart = nowNs();
+            std::unique_lock<std::mutex> lock(mutex);
+            uint64_t start = nowNs();
+            lockWaitNs.fetch_add(start - lockStart, std::memory_order_relaxed);
+            if (running && pendingBytes + bytes <= maxPendingBytes) {
+                pending.push_back({data, bytes});
+                pendingBytes += bytes;
+                pendingCount.fetch_add(1, std::memory_order_relaxed);
+                bool wake = pending.size() == batchSize;
+                lock.unlock();
+                if (wake) cv.notify_one();
+                hotNs.fetch_add(nowNs() - start, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        uint64_t start = nowNs();
+        delete[] data;
+        hotNs.fetch_add(nowNs() - start, std::memory_order_relaxed);
+        inlineFrees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Free everything still pending and stop the reclaimer thread; later
+     * buffers are freed inline. Safe to call more than once.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) return;
+            running = false;
+        }
+        cv.notify_one();
+        if (thread.joinable()) thread.join();
+    }
+
+    bool isEnabled() const { return enabled; }
+    size_t getMinBytes() const { return minBytes; }
+
+    void getStatistics(ReclaimStats& stats) const {
+        stats.largeBuffers = largeBuffers.load(std::memory_order_relaxed);
+        stats.largeBytes = largeBytes.load(std::memory_order_relaxed);
+        stats.hotNs = hotNs.load(std::memory_order_relaxed);
+        stats.lockWaitNs = lockWaitNs.load(std::memory_order_relaxed);
+        stats.deferred = deferred.load(std::memory_order_relaxed);
+        stats.inlineFrees = inlineFrees.load(std::memory_order_relaxed);
+        stats.batches = batches.load(std::memory_order_relaxed);
+        stats.reclaimNs = reclaimNs.load(std::memory_order_relaxed);
+        stats.pending = pendingCount.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * unique_ptr deleter handing the buffer to a reclaimer (delete[] if none)
+ */
+struct ReclaimDeleter {
+    BufferReclaimer* reclaimer = nullptr;
+    size_t bytes = 0;
+
+    void operator()(uint8_t* data) const {
+        if (reclaimer) {
+            reclaimer->retire(data, bytes);
+        } else {
+            delete[] data;
+        }
+    }
+};
+
+} // namespace e2sar
+
+#endif // CODA_FB_BUFFER_RECLAIMER_HPP
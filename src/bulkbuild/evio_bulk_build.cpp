@@ -0,0 +1,548 @@
+/**
+ * EVIO6 Offline Bulk Frame Builder
+ *
+ * Builds aggregated EVIO6 frames from recorded raw captures (reassembly-only
+ * output, one or more streams per capture) without replaying them through the
+ * live pipeline, using every core.
+ *
+ * PIPELINE:
+ *  1. Every capture is memory-mapped. Its frames come from the evio_raw_scan
+ *     index (<capture>.idx) when present and current, otherwise the capture
+ *     is scanned here.
+ *  2. Frames are grouped by ROC ID (after an optional --roc-map remapping)
+ *     and keyed by their payload frame number plus a per-ROC correction.
+ *     The 32-bit payload frame numbers are unwrapped to 64 bits per ROC (in
+ *     capture order), so runs longer than one 32-bit wrap build correctly.
+ *     As in the live builder, the default corrections align every ROC's first
+ *     frame number to the smallest one; --correction overrides them.
+ *  3. The corrected frame number space is cut into chunks of --chunk-frames
+ *     numbers. Worker threads build whole chunks in parallel: per chunk, the
+ *     ROC lists are walked together and every corrected frame number yields
+ *     one frame holding one slice per ROC (a ROC with a repeated number
+ *     yields a further, partial frame - the live builder's behavior).
+ *  4. Frames are serialized with the same evio6 serializer as the live
+ *     FrameBuilder (record header, 0xFF60 bank, SIB/TSS/AIS, ROC banks copied
+ *     verbatim; timestamp = average of the slices) into per-chunk buffers.
+ *  5. The main thread writes finished chunks strictly in chunk order into
+ *     rolled-over {out-prefix}_file{NNNN}.evio files with trailer indexes,
+ *     so the output is one frame-number-ordered stream. The number of
+ *     chunks in flight is bounded to cap memory use.
+ *
+ * Slice payloads are read straight from the mapped captures and copied once,
+ * into the chunk buffer.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include "evio6/evio6_raw.hpp"
+#include "evio6/evio6_file.hpp"
+#include "evio6/evio6_writer.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * One ROC slice in a mapped capture
+ */
+struct BulkSlice {
+    int64_t frame;            // Unwrapped, corrected frame number (aggregation key)
+    const uint8_t* data;      // ROC bank (after the CODA block header)
+    uint32_t bytes;
+    uint64_t timestamp;
+};
+
+/**
+ * All slices of one ROC, sorted by corrected frame number
+ */
+struct RocStream {
+    uint16_t rocId;
+    std::vector<BulkSlice> slices;
+    int64_t firstFrame = 0;    // Unwrapped frame number of the first slice (capture order)
+    int64_t correction = 0;
+    evio6::FrameNumberUnwrapper unwrap;
+};
+
+/**
+ * Built records of one chunk, waiting to be written in order
+ */
+struct ChunkOutput {
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> recordBytes;
+    uint64_t frames = 0;
+    uint64_t partialFrames = 0;
+    uint64_t slices = 0;
+    bool done = false;
+};
+
+struct BulkConfig {
+    std::string outDir;
+    std::string outPrefix = "frames_rebuilt";
+    uint64_t maxFileBytes = evio6::FileWriter::DEFAULT_MAX_FILE_BYTES;
+    bool trailer = true;
+    bool autoAlign = true;
+    int threads = 1;
+    int64_t chunkFrames = 4096;
+    size_t expectedStreams = 0;   // 0 = number of ROCs found
+    std::map<uint16_t, uint16_t> rocMap;
+    std::map<uint16_t, int64_t> corrections;
+};
+
+// ============================================================================
+// Capture Loading
+// ============================================================================
+
+/**
+ * Frames of one capture, from its index if it is present and current,
+ * otherwise by scanning
+ */
+bool loadCaptureFrames(const std::string& path, const evio6::MappedFile& capture,
+                       std::vector<evio6::RawIndexEntry>& frames, bool& fromIndex) {
+    frames.clear();
+    fromIndex = false;
+
+    std::error_code ec;
+    if (fs::exists(path + ".idx", ec)) {
+        evio6::MappedFile index;
+        if (index.open(path + ".idx") && index.size() >= sizeof(evio6::RawIndexHeader)) {
+            evio6::RawIndexHeader header;
+            std::memcpy(&header, index.data(), sizeof(header));
+            if (evio6::isValidIndexHeader(header) && header.captureBytes == capture.size() &&
+                index.size() == sizeof(header) + header.entryCount * sizeof(evio6::RawIndexEntry)) {
+                frames.resize(header.entryCount);
+                std::memcpy(frames.data(), index.data() + sizeof(header),
+                            header.entryCount * sizeof(evio6::RawIndexEntry));
+                fromIndex = true;
+                return true;
+            }
+        }
+        std::cerr << "WARNING: Stale or unreadable index " << path << ".idx, rescanning capture" << std::endl;
+    }
+
+    evio6::RawCaptureScanner scanner(capture.data(), capture.size());
+    evio6::RawFrame frame;
+    while (scanner.next(frame)) {
+        frames.push_back(evio6::toIndexEntry(frame));
+    }
+    if (scanner.resyncs > 0 || scanner.truncatedBytes > 0) {
+        std::cerr << "WARNING: " << path << ": " << scanner.resyncs << " resyncs ("
+                  << scanner.skippedBytes << " bytes skipped), "
+                  << scanner.truncatedBytes << " byte truncated tail" << std::endl;
+    }
+    return true;
+}
+
+// ============================================================================
+// Chunk Builder
+// ============================================================================
+
+/**
+ * Build all frames with corrected numbers in [first, last) into out
+ */
+void buildChunk(const std::vector<RocStream>& rocs, size_t expectedStreams,
+                int64_t first, int64_t last, ChunkOutput& out) {
+    // Per-ROC cursor range for this chunk
+    std::vector<size_t> pos(rocs.size());
+    std::vector<size_t> end(rocs.size());
+    auto byFrame = [](const BulkSlice& s, int64_t f) { return s.frame < f; };
+    for (size_t r = 0; r < rocs.size(); r++) {
+        const auto& slices = rocs[r].slices;
+        pos[r] = std::lower_bound(slices.begin(), slices.end(), first, byFrame) - slices.begin();
+        end[r] = std::lower_bound(slices.begin() + pos[r], slices.end(), last, byFrame) - slices.begin();
+    }
+
+    std::vector<evio6::SliceRef> refs;
+    refs.reserve(rocs.size());
+
+    while (true) {
+        // Smallest corrected frame number at the head of any ROC
+        int64_t frame = last;
+        for (size_t r = 0; r < rocs.size(); r++) {
+            if (pos[r] < end[r]) frame = std::min(frame, rocs[r].slices[pos[r]].frame);
+        }
+        if (frame == last) break;
+
+        // One slice from every ROC at this number
+        refs.clear();
+        uint64_t tsTotal = 0;
+        for (size_t r = 0; r < rocs.size(); r++) {
+            if (pos[r] < end[r] && rocs[r].slices[pos[r]].frame == frame) {
+                const BulkSlice& s = rocs[r].slices[pos[r]++];
+                refs.push_back({s.data, s.bytes, rocs[r].rocId, 0});
+                tsTotal += s.timestamp;
+            }
+        }
+
+        // Same record layout and values as FrameBuilder::buildEVIO6Frame
+        evio6::FrameInfo info;
+        info.recordNumber = 0;  // Renumbered by the file writer
+        info.frameNumber = static_cast<uint32_t>(frame);
+        info.eventNumber = static_cast<uint64_t>(frame);
+        info.timestamp = tsTotal / refs.size();
+        info.streamStatus = static_cast<uint8_t>(refs.size() & 0x7F);
+
+        const size_t payloadBytes = evio6::aggregatedPayloadBytes(refs.data(), refs.size());
+        const size_t bytes = evio6::HEADER_BYTES + evio6::aggregatedMetadataWords(refs.size()) * 4 + payloadBytes;
+        const size_t offset = out.data.size();
+        out.data.resize(offset + bytes);
+        size_t headerBytes = evio6::encodeAggregatedHeader(out.data.data() + offset, info,
+                                                            refs.data(), refs.size(), payloadBytes);
+        evio6::copyRocBanks(out.data.data() + offset + headerBytes, refs.data(), refs.size());
+
+        out.recordBytes.push_back(static_cast<uint32_t>(bytes));
+        out.frames++;
+        out.slices += refs.size();
+        if (refs.size() < expectedStreams) out.partialFrames++;
+    }
+}
+
+// ============================================================================
+// Command Line
+// ============================================================================
+
+// Parse "A=B" with integer A and B
+bool parsePair(const std::string& spec, long long& a, long long& b) {
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos || eq == 0 || eq + 1 >= spec.size()) return false;
+    char* endA = nullptr;
+    char* endB = nullptr;
+    std::string lhs = spec.substr(0, eq);
+    std::string rhs = spec.substr(eq + 1);
+    a = std::strtoll(lhs.c_str(), &endA, 10);
+    b = std::strtoll(rhs.c_str(), &endB, 10);
+    return *endA == '\0' && *endB == '\0';
+}
+
+void printHelp(const char* progName) {
+    std::cout << "EVIO6 Offline Bulk Frame Builder\n\n";
+    std::cout << "Builds aggregated EVIO6 frames from raw reassembly-only captures\n";
+    std::cout << "(e.g. events.bin, one or more streams each) in parallel.\n\n";
+    std::cout << "Usage: " << progName << " <capture>... --out-dir D [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help              Show this help message\n";
+    std::cout << "  --out-dir D             Output directory (required)\n";
+    std::cout << "  --out-prefix P          Output prefix (default: frames_rebuilt)\n";
+    std::cout << "                          Files: D/P_file*.evio\n";
+    std::cout << "  --threads N             Builder threads (default: hardware concurrency)\n";
+    std::cout << "  --chunk-frames N        Frame numbers per parallel work unit (default: 4096)\n";
+    std::cout << "  --roc-map OLD=NEW       Rewrite ROC ID OLD as NEW (repeatable)\n";
+    std::cout << "  --correction ROC=N      Add N to the frame numbers of ROC (after --roc-map;\n";
+    std::cout << "                          repeatable; overrides the automatic alignment)\n";
+    std::cout << "  --no-auto-align         Do not align the ROCs' first frame numbers\n";
+    std::cout << "  --expected-streams N    Streams per complete frame (default: ROCs found)\n";
+    std::cout << "  --max-file-size GB      Output file rollover size (default: 2)\n";
+    std::cout << "  --no-trailer            Do not write trailer indexes\n\n";
+    std::cout << "Captures with a current <capture>.idx (from evio_raw_scan) are not rescanned.\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " /data/run42/events.bin --out-dir /data/run42/rebuilt --roc-map 7=3\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    BulkConfig config;
+    config.threads = std::thread::hardware_concurrency();
+    std::vector<std::string> capturePaths;
+    double maxFileSizeGB = 2.0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        long long a = 0;
+        long long b = 0;
+
+        if (arg == "-h" || arg == "--help") {
+            printHelp(argv[0]);
+            return 0;
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            config.outDir = argv[++i];
+        } else if (arg == "--out-prefix" && i + 1 < argc) {
+            config.outPrefix = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            config.threads = std::atoi(argv[++i]);
+        } else if (arg == "--chunk-frames" && i + 1 < argc) {
+            config.chunkFrames = std::atoll(argv[++i]);
+        } else if (arg == "--roc-map" && i + 1 < argc) {
+            if (!parsePair(argv[++i], a, b) || a < 0 || a > 0xFFFF || b < 0 || b > 0xFFFF) {
+                std::cerr << "ERROR: Invalid --roc-map '" << argv[i] << "' (expected OLD=NEW)\n";
+                return 1;
+            }
+            config.rocMap[static_cast<uint16_t>(a)] = static_cast<uint16_t>(b);
+        } else if (arg == "--correction" && i + 1 < argc) {
+            if (!parsePair(argv[++i], a, b) || a < 0 || a > 0xFFFF) {
+                std::cerr << "ERROR: Invalid --correction '" << argv[i] << "' (expected ROC=N)\n";
+                return 1;
+            }
+            config.corrections[static_cast<uint16_t>(a)] = b;
+        } else if (arg == "--no-auto-align") {
+            config.autoAlign = false;
+        } else if (arg == "--expected-streams" && i + 1 < argc) {
+            config.expectedStreams = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--max-file-size" && i + 1 < argc) {
+            maxFileSizeGB = std::atof(argv[++i]);
+        } else if (arg == "--no-trailer") {
+            config.trailer = false;
+        } else if (arg[0] != '-') {
+            capturePaths.push_back(arg);
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    if (capturePaths.empty()) {
+        std::cerr << "ERROR: No capture files specified\n";
+        printHelp(argv[0]);
+        return 1;
+    }
+    if (config.outDir.empty()) {
+        std::cerr << "ERROR: --out-dir is required\n";
+        return 1;
+    }
+    if (maxFileSizeGB <= 0 || config.chunkFrames <= 0) {
+        std::cerr << "ERROR: --max-file-size and --chunk-frames must be positive\n";
+        return 1;
+    }
+    config.maxFileBytes = static_cast<uint64_t>(maxFileSizeGB * 1024 * 1024 * 1024);
+    config.threads = std::max(1, config.threads);
+
+    std::error_code ec;
+    fs::create_directories(config.outDir, ec);
+    if (ec) {
+        std::cerr << "ERROR: Cannot create output directory: " << config.outDir << " (" << ec.message() << ")\n";
+        return 1;
+    }
+
+    std::cout << "EVIO6 Offline Bulk Frame Builder\n";
+    std::cout << "================================\n";
+
+    auto start = std::chrono::steady_clock::now();
+
+    // ========================================================================
+    // Map captures and collect slices per (remapped) ROC
+    // ========================================================================
+    std::vector<evio6::MappedFile> captures;
+    std::map<uint16_t, RocStream> rocMap;
+    uint64_t inputBytes = 0;
+    uint64_t badFrames = 0;
+    std::vector<evio6::RawIndexEntry> frames;
+
+    for (const auto& path : capturePaths) {
+        evio6::MappedFile capture;
+        if (!capture.open(path)) {
+            return 1;
+        }
+
+        bool fromIndex = false;
+        loadCaptureFrames(path, capture, frames, fromIndex);
+        std::cout << "Input: " << path << " (" << capture.size() << " bytes, " << frames.size()
+                  << " frames, " << (fromIndex ? "from index" : "scanned") << ")\n";
+
+        for (const auto& f : frames) {
+            if ((f.flags & evio6::RawFlag::BAD_STRUCTURE) ||
+                f.offset + f.length > capture.size() ||
+                f.length < evio6::RocFrame::BLOCK_HEADER_BYTES) {
+                badFrames++;
+                continue;
+            }
+            auto mapped = config.rocMap.find(f.rocId);
+            uint16_t rocId = (mapped != config.rocMap.end()) ? mapped->second : f.rocId;
+
+            RocStream& roc = rocMap[rocId];
+            int64_t frameNumber = roc.unwrap(f.frameNumber);
+            if (roc.slices.empty()) {
+                roc.rocId = rocId;
+                roc.firstFrame = frameNumber;
+            }
+            roc.slices.push_back({frameNumber,
+                                  capture.data() + f.offset + evio6::RocFrame::BLOCK_HEADER_BYTES,
+                                  f.length - static_cast<uint32_t>(evio6::RocFrame::BLOCK_HEADER_BYTES),
+                                  f.timestamp});
+        }
+
+        inputBytes += capture.size();
+        captures.push_back(std::move(capture));
+    }
+    frames = std::vector<evio6::RawIndexEntry>();
+
+    if (rocMap.empty()) {
+        std::cerr << "ERROR: No frames found in the captures\n";
+        return 1;
+    }
+
+    // ========================================================================
+    // Per-ROC corrections (startup alignment, as the live builder) and sort
+    // ========================================================================
+    int64_t minFirst = INT64_MAX;
+    for (const auto& [rocId, roc] : rocMap) {
+        minFirst = std::min(minFirst, roc.firstFrame);
+    }
+
+    std::vector<RocStream> rocs;
+    uint64_t outOfRange = 0;
+    for (auto& [rocId, roc] : rocMap) {
+        auto explicitCorrection = config.corrections.find(rocId);
+        if (explicitCorrection != config.corrections.end()) {
+            roc.correction = explicitCorrection->second;
+        } else if (config.autoAlign) {
+            roc.correction = minFirst - roc.firstFrame;
+        }
+
+        size_t kept = 0;
+        for (auto& s : roc.slices) {
+            s.frame += roc.correction;
+            if (s.frame < 0) {
+                outOfRange++;
+                continue;
+            }
+            roc.slices[kept++] = s;
+        }
+        roc.slices.resize(kept);
+        std::stable_sort(roc.slices.begin(), roc.slices.end(),
+                         [](const BulkSlice& x, const BulkSlice& y) { return x.frame < y.frame; });
+
+        std::cout << "  ROC " << std::setw(5) << rocId << ": " << roc.slices.size() << " slices, first frame "
+                  << roc.firstFrame << ", correction " << (roc.correction >= 0 ? "+" : "") << roc.correction << "\n";
+        rocs.push_back(std::move(roc));
+    }
+    rocMap.clear();
+
+    size_t expectedStreams = config.expectedStreams > 0 ? config.expectedStreams : rocs.size();
+
+    int64_t firstFrame = INT64_MAX;
+    int64_t lastFrame = -1;
+    for (const auto& roc : rocs) {
+        if (roc.slices.empty()) continue;
+        firstFrame = std::min(firstFrame, roc.slices.front().frame);
+        lastFrame = std::max(lastFrame, roc.slices.back().frame);
+    }
+    if (lastFrame < firstFrame) {
+        std::cerr << "ERROR: No frames left after corrections\n";
+        return 1;
+    }
+
+    const size_t chunkCount = static_cast<size_t>((lastFrame - firstFrame) / config.chunkFrames + 1);
+    std::cout << "Frame numbers: " << firstFrame << ".." << lastFrame << " (" << chunkCount << " chunks of "
+              << config.chunkFrames << ", " << config.threads << " threads)\n";
+    std::cout << "Output: " << config.outDir << "/" << config.outPrefix << "_file*.evio\n\n";
+
+    // ========================================================================
+    // Build chunks in parallel, write them in order
+    // ========================================================================
+    std::vector<ChunkOutput> chunks(chunkCount);
+    std::mutex chunkMutex;
+    std::condition_variable chunkCV;
+    size_t nextChunk = 0;       // Next chunk to hand to a worker
+    size_t nextToWrite = 0;     // Next chunk the writer needs
+    bool abortBuild = false;
+    const size_t maxInFlight = static_cast<size_t>(config.threads) * 2;
+
+    auto worker = [&]() {
+        while (true) {
+            size_t c;
+            {
+                std::unique_lock<std::mutex> lock(chunkMutex);
+                chunkCV.wait(lock, [&]() {
+                    return abortBuild || nextChunk >= chunkCount || nextChunk < nextToWrite + maxInFlight;
+                });
+                if (abortBuild || nextChunk >= chunkCount) return;
+                c = nextChunk++;
+            }
+
+            int64_t first = firstFrame + static_cast<int64_t>(c) * config.chunkFrames;
+            buildChunk(rocs, expectedStreams, first, first + config.chunkFrames, chunks[c]);
+
+            {
+                std::lock_guard<std::mutex> lock(chunkMutex);
+                chunks[c].done = true;
+            }
+            chunkCV.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < config.threads; t++) {
+        workers.emplace_back(worker);
+    }
+
+    evio6::FileWriter writer(config.outDir, config.outPrefix, config.maxFileBytes,
+                             evio6::FileWriter::DEFAULT_BUFFER_BYTES, config.trailer);
+    bool ok = true;
+    uint64_t framesBuilt = 0;
+    uint64_t partialFrames = 0;
+    uint64_t slicesAggregated = 0;
+
+    for (size_t c = 0; c < chunkCount && ok; c++) {
+        {
+            std::unique_lock<std::mutex> lock(chunkMutex);
+            chunkCV.wait(lock, [&]() { return chunks[c].done; });
+        }
+
+        ChunkOutput& chunk = chunks[c];
+        const uint8_t* p = chunk.data.data();
+        for (uint32_t bytes : chunk.recordBytes) {
+            if (!writer.writeRecord(p, bytes, 1)) {
+                ok = false;
+                break;
+            }
+            p += bytes;
+        }
+        framesBuilt += chunk.frames;
+        partialFrames += chunk.partialFrames;
+        slicesAggregated += chunk.slices;
+        chunk = ChunkOutput();
+
+        {
+            std::lock_guard<std::mutex> lock(chunkMutex);
+            nextToWrite = c + 1;
+            if (!ok) abortBuild = true;
+        }
+        chunkCV.notify_all();
+    }
+
+    for (auto& t : workers) {
+        t.join();
+    }
+    ok = writer.close() && ok;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // ========================================================================
+    // Summary
+    // ========================================================================
+    std::cout << "=== Bulk Build Summary ===\n";
+    std::cout << "Input Captures: " << captures.size() << " (" << inputBytes << " bytes)\n";
+    std::cout << "ROCs: " << rocs.size() << " (expected streams per frame: " << expectedStreams << ")\n";
+    std::cout << "Frames Built: " << framesBuilt << " (" << partialFrames << " partial)\n";
+    std::cout << "Slices Aggregated: " << slicesAggregated << "\n";
+    std::cout << "Bad Frames Skipped: " << badFrames << "\n";
+    std::cout << "Negative Frame Numbers After Correction: " << outOfRange << "\n";
+    std::cout << "Records Written: " << writer.recordsWritten() << "\n";
+    std::cout << "Files Written: " << writer.filesWritten() << "\n";
+    std::cout << "Bytes Written: " << writer.bytesWritten() << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Elapsed: " << elapsed << " sec ("
+              << std::setprecision(1) << (elapsed > 0 ? inputBytes / elapsed / 1e6 : 0.0) << " MB/sec input, "
+              << (elapsed > 0 ? framesBuilt / elapsed : 0.0) << " frames/sec)\n";
+    std::cout << "==========================\n";
+
+    return ok ? 0 : 1;
+}
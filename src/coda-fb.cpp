@@ -16,16 +16,21 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <fstream>
 #include <vector>
 #include <cstring>
 #include <mutex>
+#include <thread>
+#include <chrono>
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 #include <locale>
 
 #include <e2sar.hpp>
+#include "buffer_reclaimer.hpp"
 #ifdef ENABLE_FRAME_BUILDER
 #include "e2sar_reassembler_framebuilder.hpp"
+#include "evio6/evio6_view.hpp"
 #include <et.h>
 #else
 // Forward declaration when frame builder is not available
@@ -49,11 +54,14 @@ using namespace e2sar;
 bool threadsRunning = true;
 Reassembler *reasPtr{nullptr};
 e2sar::FrameBuilder *frameBuilderPtr{nullptr};  // Global frame builder pointer (nullptr if not built with ET)
+std::shared_ptr<e2sar::BufferReclaimer> payloadReclaimer;  // Frees reassembled payloads off the hot threads
 std::atomic<bool> handlerTriggered{false};
 int globalOutputFd{-1};  // Global file descriptor for single output file
 std::mutex fileMutex;    // Mutex to protect file writes
 bool verboseFrameInfo = false;  // Verbose frame logging: print all frames and builder messages
 bool verboseReassemble = false;  // Print event numbers for all streams (reassembly-only mode)
+std::string tuningConfigFile;    // Builder tuning file, re-read on SIGHUP (empty: no reload)
+std::atomic<bool> reloadTuningRequested{false};
 
 // Note: Frame builder is always used when ENABLE_FRAME_BUILDER is defined
 
@@ -124,6 +132,57 @@ std::string getLocalHostIP(bool preferV6 = false) {
     return result;
 }
 
+/**
+ * Link speed in MB/s of the interface that owns the given address
+ * (from /sys/class/net/<interface>/speed; 0 if unknown, e.g. virtual interfaces)
+ */
+double getInterfaceSpeedMBps(const boost::asio::ip::address& addr) {
+    struct ifaddrs *ifaddr, *ifa;
+    char host[NI_MAXHOST];
+
+    if (getifaddrs(&ifaddr) == -1) {
+        return 0.0;
+    }
+
+    std::string ifName;
+    const std::string wanted = addr.to_string();
+    for (ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+        if (ifa->ifa_addr == nullptr)
+            continue;
+
+        int family = ifa->ifa_addr->sa_family;
+        if (family != AF_INET && family != AF_INET6)
+            continue;
+
+        if (getnameinfo(ifa->ifa_addr,
+                        (family == AF_INET) ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6),
+                        host, NI_MAXHOST, nullptr, 0, NI_NUMERICHOST) != 0) {
+            continue;
+        }
+
+        // IPv6 link-local addresses carry a %interface scope suffix
+        std::string found(host);
+        found = found.substr(0, found.find('%'));
+        if (found == wanted) {
+            ifName = ifa->ifa_name;
+            break;
+        }
+    }
+    freeifaddrs(ifaddr);
+
+    if (ifName.empty()) {
+        return 0.0;
+    }
+
+    // Mb/s, -1 when the driver does not know
+    std::ifstream speedFile("/sys/class/net/" + ifName + "/speed");
+    long mbps = 0;
+    if (!(speedFile >> mbps) || mbps <= 0) {
+        return 0.0;
+    }
+    return mbps / 8.0;
+}
+
 void ctrlCHandler(int sig)
 {
     if (handlerTriggered.exchange(true))
@@ -137,6 +196,111 @@ void ctrlCHandler(int sig)
     // The main thread will detect this and perform proper cleanup.
 }
 
+/**
+ * SIGHUP: request a reload of the builder tuning file
+ * Only sets a flag; the reception loop does the reload outside signal context.
+ */
+void sighupHandler(int sig)
+{
+    reloadTuningRequested = true;
+}
+
+#ifdef ENABLE_FRAME_BUILDER
+/**
+ * Read builder tuning from a config file (boost program_options INI syntax):
+ *
+ *   framenumber-slop = 2
+ *   frame-timeout = 500
+ *   verbose-frames = false
+ *
+ * Keys missing from the file keep the values in 'tuning'.
+ *
+ * @return false (with a message on stderr) if the file cannot be read or parsed
+ */
+bool loadTuningFile(const std::string& path, e2sar::BuilderTuning& tuning)
+{
+    po::options_description fileOpts;
+    fileOpts.add_options()
+        ("framenumber-slop", po::value<int>(&tuning.frameNumberSlop))
+        ("frame-timeout", po::value<int>(&tuning.frameTimeoutMs))
+        ("verbose-frames", po::value<bool>(&tuning.verbose));
+
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "ERROR: Cannot open config file: " << path << std::endl;
+        return false;
+    }
+
+    try {
+        po::variables_map fileVm;
+        po::store(po::parse_config_file(in, fileOpts), fileVm);
+        po::notify(fileVm);
+    } catch (const po::error& e) {
+        std::cerr << "ERROR: Bad config file " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Re-read the tuning file and push it to the frame builder
+ * On any error the running configuration is kept.
+ */
+void reloadBuilderTuning(e2sar::FrameBuilder* frameBuilder)
+{
+    if (tuningConfigFile.empty()) {
+        std::cerr << "WARNING: SIGHUP received but no --config-file given, nothing to reload" << std::endl;
+        return;
+    }
+
+    e2sar::BuilderTuning tuning = frameBuilder->getTuning();
+    if (!loadTuningFile(tuningConfigFile, tuning)) {
+        std::cerr << "WARNING: Keeping current builder configuration" << std::endl;
+        return;
+    }
+
+    uint64_t version = frameBuilder->updateTuning(tuning);
+    if (version == 0) {
+        std::cerr << "WARNING: Keeping current builder configuration" << std::endl;
+        return;
+    }
+    verboseFrameInfo = tuning.verbose;
+    std::cout << "Builder config v" << version << " loaded from " << tuningConfigFile
+              << " (framenumber-slop " << tuning.frameNumberSlop
+              << ", frame-timeout " << tuning.frameTimeoutMs << " ms"
+              << ", verbose-frames " << (tuning.verbose ? "on" : "off") << ")" << std::endl;
+}
+#endif  // ENABLE_FRAME_BUILDER
+
+/**
+ * Print payload release statistics (nothing until a large buffer was released)
+ */
+void printReclaimStatistics(const std::string& indent)
+{
+    if (payloadReclaimer == nullptr) {
+        return;
+    }
+    e2sar::ReclaimStats rs;
+    payloadReclaimer->getStatistics(rs);
+    if (rs.largeBuffers == 0) {
+        return;
+    }
+    std::cout << "--- Payload Release ---" << std::endl;
+    std::cout << indent << "Large Buffers: " << rs.largeBuffers << " (" << std::fixed << std::setprecision(2)
+              << (rs.largeBytes / (1024.0 * 1024.0)) << " MB), " << rs.deferred << " deferred in "
+              << rs.batches << " batches, " << rs.inlineFrees << " freed inline, " << rs.pending
+              << " pending" << std::endl;
+    std::cout << indent << "Hot-Thread Release Time: " << std::setprecision(0)
+              << (static_cast<double>(rs.hotNs) / rs.largeBuffers) << " ns/buffer ("
+              << std::setprecision(1) << (rs.hotNs / 1e6) << " ms total, "
+              << (rs.lockWaitNs / 1e6) << " ms lock wait)" << std::endl;
+    if (rs.deferred > 0) {
+        std::cout << indent << "Reclaimer Free Time: " << std::setprecision(0)
+                  << (static_cast<double>(rs.reclaimNs) / rs.deferred) << " ns/buffer ("
+                  << std::setprecision(1) << (rs.reclaimNs / 1e6) << " ms total)" << std::endl;
+    }
+}
+
 /**
  * Perform final cleanup and print statistics
  * Called from main thread when exiting normally
@@ -217,6 +381,7 @@ void performFinalCleanup()
         std::cout << "\tReceive Errors: " << receivedWithError << std::endl;
         std::cout << "\tPayload Validation Errors: " << payloadValidationErrors << std::endl;
         std::cout << "\tWrong Endianness Count: " << wrongEndiannessCount << std::endl;
+        printReclaimStatistics("\t");
         std::cout << "--- Runtime ---" << std::endl;
         std::cout << "\tTotal Elapsed Time: " << std::fixed << std::setprecision(1)
                   << totalElapsedSec << " sec" << std::endl;
@@ -324,43 +489,6 @@ void cleanupDirectET_REMOVED() {
 #endif  // 0 - reference code
 #endif  // ENABLE_FRAME_BUILDER
 
-/**
- * ============================================================================
- * EVIO-6 CODA Tags and Data Types
- * ============================================================================
- */
-namespace CODATag {
-    const uint16_t STREAMING_PHYS = 0xFFD0;      // Top-level streaming physics event
-    const uint16_t STREAMING_SIB_BUILT = 0xFFD1; // Stream Info Bank (built/aggregated)
-    const uint8_t  STREAMING_TSS_BUILT = 0x01;   // Time Slice Segment
-    const uint8_t  STREAMING_AIS_BUILT = 0x02;   // Aggregation Info Segment
-}
-
-namespace DataType {
-    const uint8_t BANK = 0x10;    // EVIO bank type
-    const uint8_t SEGMENT = 0x20; // EVIO segment type
-}
-
-/**
- * ============================================================================
- * Byte Swap Utility for 32-bit Words
- * ============================================================================
- *
- * Converts a 32-bit word from one endianness to another by reversing byte order.
- * Used when EVIO payload is detected to have wrong endianness.
- *
- * Example: 0x12345678 -> 0x78563412
- *
- * @param val  The 32-bit value to byte-swap
- * @return     The byte-swapped 32-bit value
- */
-inline uint32_t swap32(uint32_t val) {
-    return ((val & 0x000000FF) << 24) |  // Move byte 0 to byte 3
-           ((val & 0x0000FF00) << 8)  |  // Move byte 1 to byte 2
-           ((val & 0x00FF0000) >> 8)  |  // Move byte 2 to byte 1
-           ((val & 0xFF000000) >> 24);   // Move byte 3 to byte 0
-}
-
 /**
  * ============================================================================
  * Parse EVIO Payload and Extract Metadata
@@ -395,18 +523,18 @@ EVIOMetadata parseEVIOPayload(const u_int8_t* payload, size_t payloadSize) {
     // STEP 1: Validate Minimum Payload Size
     // ========================================================================
     // We need at least 16 32-bit words (64 bytes) to access all required fields
-    if (payloadSize < 64) {
+    if (payloadSize < evio6::RocFrame::MIN_BYTES) {
         std::cerr << "ERROR: Payload too small for EVIO format: " << payloadSize
                   << " bytes (minimum: 64 bytes)" << std::endl;
         return meta;  // Return invalid metadata
     }
 
     // ========================================================================
-    // STEP 2: Interpret Payload as Array of 32-bit Words
+    // STEP 2: Wrap Payload in a ROC Frame View
     // ========================================================================
-    // Cast byte array to 32-bit word array for easier access
-    // NOTE: Assumes payload is properly aligned (should be from network stack)
-    const uint32_t* words = reinterpret_cast<const uint32_t*>(payload);
+    // The view reads words with memcpy (no alignment assumption) and detects
+    // the byte order from the magic number; see evio6/evio6_view.hpp
+    evio6::RocFrameView frame(payload, payloadSize);
 
     // ========================================================================
     // STEP 3: Check Magic Number at Word 8 (Index 7 in 0-Based Array)
@@ -415,81 +543,47 @@ EVIOMetadata parseEVIOPayload(const u_int8_t* payload, size_t payloadSize) {
     // 1. Verifies frame was correctly reassembled (no missing/corrupt packets)
     // 2. Indicates correct byte ordering (endianness)
 
-    uint32_t magic = words[7];  // Word 8 in 1-based indexing
-    bool needsSwap = false;
-
-    if (magic == 0xc0da0100) {
-        // SUCCESS: Correct magic number and correct endianness
-        needsSwap = false;
-
-    } else if (magic == 0x0001dac0) {
-        // WARNING: Magic number is byte-swapped (wrong endianness detected)
-        // We can still use the data, but need to swap all words
-        needsSwap = true;
-        meta.wrongEndian = true;
-
-    } else {
+    if (!frame.hasValidMagic()) {
         // FAILURE: Invalid magic number - frame is corrupted or incorrectly assembled
-        std::cerr << "ERROR: Invalid EVIO magic number at word 8: 0x" << std::hex << magic
+        std::cerr << "ERROR: Invalid EVIO magic number at word 8: 0x" << std::hex << frame.rawMagic()
                   << std::dec << " (expected 0xc0da0100 or 0x0001dac0)" << std::endl;
         return meta;  // Return invalid metadata
     }
 
-    // ========================================================================
-    // STEP 4: Define Helper Function for Reading Words with Byte Swapping
-    // ========================================================================
-    // This lambda automatically swaps bytes if wrong endianness was detected
-    auto readWord = [&](size_t index) -> uint32_t {
-        return needsSwap ? swap32(words[index]) : words[index];
-    };
+    // WARNING: Magic number is byte-swapped (wrong endianness detected)
+    // We can still use the data; the view swaps every word it reads
+    meta.wrongEndian = frame.isByteSwapped();
 
     // ========================================================================
-    // STEP 5: Extract and Validate ROC_ID from Word 10 (Index 9)
+    // STEP 4: Extract and Validate ROC_ID from Word 10 (Index 9)
     // ========================================================================
     // Word 10 format: ROC_ID (16 bits) + 0x10 + StreamStatus (8 bits)
     //   - Upper 16 bits (bits 31-16): ROC_ID (readout controller identifier)
     //   - Next 8 bits (bits 15-8) must be 0x10 (fixed identifier)
     //   - Lowest 8 bits (bits 7-0) = StreamStatus flags
 
-    uint32_t word10 = readWord(9);  // Word 10 in 1-based indexing
-
-    // Extract the three components of word 10
-    uint16_t upper16 = (word10 >> 16) & 0xFFFF;  // Bits 31-16 (ROC_ID)
-    uint8_t  next8   = (word10 >> 8)  & 0xFF;    // Bits 15-8 (must be 0x10)
-    uint8_t  ss      = word10 & 0xFF;             // Bits 7-0 (StreamStatus)
-
     // Validate only the middle byte (0x10) - upper 16 bits may vary by format version
-    if (next8 != 0x10) {
-        std::cerr << "ERROR: Invalid ROC_ID format at word 10: 0x" << std::hex << word10
+    if (frame.rocBankType() != evio6::DataType::BANK) {
+        std::cerr << "ERROR: Invalid ROC_ID format at word 10: 0x" << std::hex << frame.rocBankHeader()
                   << std::dec << " (expected middle byte 0x10)" << std::endl;
         return meta;  // Return invalid metadata
     }
 
     // Extract the ROC/Stream ID from the upper 16 bits
-    meta.dataId = upper16;
-
-    // ========================================================================
-    // STEP 6: Extract Frame Number from Word 14 (Index 13)
-    // ========================================================================
-    // This is a simple 32-bit sequence number identifying this frame
-    meta.frameNumber = readWord(13);  // Word 14 in 1-based indexing
+    meta.dataId = frame.rocId();
 
     // ========================================================================
-    // STEP 7: Extract 64-bit Timestamp from Words 15-16 (Indices 14-15)
+    // STEP 5: Extract Frame Number (Word 14) and Timestamp (Words 15-16)
     // ========================================================================
-    // The timestamp is split across two consecutive 32-bit words:
+    // Frame number is a simple 32-bit sequence number identifying this frame;
+    // the timestamp is split across two consecutive 32-bit words:
     //   - Word 15: Lower 32 bits [31:0]
     //   - Word 16: Upper 32 bits [63:32]
-
-    uint32_t ts_low  = readWord(14);  // Word 15: timestamp bits [31:0]
-    uint32_t ts_high = readWord(15);  // Word 16: timestamp bits [63:32]
-
-    // Combine the two 32-bit halves into a single 64-bit timestamp
-    // Example: ts_high=0x12345678, ts_low=0x9ABCDEF0 => 0x123456789ABCDEF0
-    meta.timestamp = (static_cast<uint64_t>(ts_high) << 32) | ts_low;
+    meta.frameNumber = frame.frameNumber();
+    meta.timestamp = frame.timestamp();
 
     // ========================================================================
-    // STEP 8: Mark Metadata as Valid
+    // STEP 6: Mark Metadata as Valid
     // ========================================================================
     // All validation checks passed - metadata is ready to use
     meta.valid = true;
@@ -497,6 +591,109 @@ EVIOMetadata parseEVIOPayload(const u_int8_t* payload, size_t payloadSize) {
     return meta;
 }
 
+#ifdef ENABLE_FRAME_BUILDER
+/**
+ * ============================================================================
+ * Load Balancer Weight Calibration
+ * ============================================================================
+ *
+ * Measures how fast this node can build and sink frames, so that it can
+ * register with the control plane for a share of the traffic that matches
+ * its cores and disks instead of E2SAR's default weight.
+ *
+ * A private FrameBuilder with the configured builder threads and stream
+ * count is fed synthetic 64 KB ROC frames for durationMs, as fast as it
+ * builds them (at most 64 frames per builder thread in flight), and writes
+ * to a scratch directory that is removed afterwards. The file sink is used
+ * even when the live sink is ET so that calibration never puts events into
+ * a running ET system.
+ *
+ * @param durationMs    Length of the measurement
+ * @param threads       Builder threads (as for the live builder)
+ * @param streams       Streams per frame (as for the live builder)
+ * @param scratchParent Directory to create the scratch directory in (empty: system temp dir)
+ * @return              Built bytes per second in MB/s, or 0 if the run failed
+ */
+double calibrateBuildCapacity(int durationMs, int threads, int streams, const std::string& scratchParent)
+{
+    constexpr int PAYLOAD_WORDS = 16 * 1024;  // 64 KB of data per ROC frame
+
+    boost::system::error_code ec;
+    bfs::path scratchDir = scratchParent.empty() ? bfs::temp_directory_path(ec) : bfs::path(scratchParent);
+    scratchDir /= bfs::unique_path(".lb_calibration_%%%%%%%%", ec);
+    if (ec) {
+        std::cerr << "WARNING: No scratch directory for calibration: " << ec.message() << std::endl;
+        return 0.0;
+    }
+
+    // One template frame per stream; the builder takes ownership, so copies are fed
+    std::vector<std::vector<uint8_t>> templates(streams);
+    for (int s = 0; s < streams; s++) {
+        std::vector<uint32_t> w = {
+            0, 0, 8, 1, 0, 6, 0, evio6::MAGIC,
+            0, (static_cast<uint32_t>(s + 1) << 16) | 0x1000,
+            4, (0xFF30u << 16) | 0x2000,
+            (0x31u << 24) | (1u << 16) | 3,
+            0, 0, 0,
+            static_cast<uint32_t>(PAYLOAD_WORDS + 1), 3u << 16};
+        for (int i = 0; i < PAYLOAD_WORDS; i++) {
+            w.push_back(i * 2654435761u);
+        }
+        w[evio6::RocFrame::ROC_BANK_LENGTH] = static_cast<uint32_t>(w.size() - evio6::RocFrame::ROC_BANK_HEADER);
+        w[evio6::RocFrame::BLOCK_LENGTH] = static_cast<uint32_t>(w.size());
+
+        templates[s].resize(w.size() * 4);
+        for (size_t i = 0; i < w.size(); i++) {
+            evio6::storeBE32(templates[s].data() + i * 4, w[i]);
+        }
+    }
+
+    double capacity = 0.0;
+    {
+        e2sar::FrameBuilder builder("", "", 0, scratchDir.string(), "calibration",
+                                    threads, 1024*1024, 0, 1000, streams, false);
+        if (!builder.start()) {
+            std::cerr << "WARNING: Calibration frame builder failed to start" << std::endl;
+            bfs::remove_all(scratchDir, ec);
+            return 0.0;
+        }
+
+        const uint64_t maxInFlight = 64ULL * threads;
+        uint64_t built = 0, slices = 0, errors = 0, bytes = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        auto deadline = t0 + std::chrono::milliseconds(durationMs);
+
+        for (uint64_t f = 0; std::chrono::steady_clock::now() < deadline; f++) {
+            while (f >= built + maxInFlight && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                builder.getStatistics(built, slices, errors, bytes);
+            }
+
+            const uint64_t timestamp = 65536ULL * 4 * f;
+            for (int s = 0; s < streams; s++) {
+                const std::vector<uint8_t>& frame = templates[s];
+                uint8_t* data = new uint8_t[frame.size()];
+                std::memcpy(data, frame.data(), frame.size());
+                evio6::storeBE32(data + evio6::RocFrame::FRAME_NUMBER * 4, static_cast<uint32_t>(f));
+                evio6::storeBE32(data + evio6::RocFrame::TIMESTAMP_LO * 4, static_cast<uint32_t>(timestamp));
+                evio6::storeBE32(data + evio6::RocFrame::TIMESTAMP_HI * 4, static_cast<uint32_t>(timestamp >> 32));
+                builder.addTimeSlice(timestamp, f, static_cast<uint16_t>(s + 1), data, frame.size());
+            }
+        }
+
+        builder.getStatistics(built, slices, errors, bytes);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (elapsed > 0 && errors == 0) {
+            capacity = bytes / elapsed / 1e6;
+        }
+        builder.stop();
+    }
+
+    bfs::remove_all(scratchDir, ec);
+    return capacity;
+}
+#endif
+
 result<int> prepareToReceive(Reassembler &r)
 {
     // Get hostname and register with control plane
@@ -563,6 +760,13 @@ result<int> receiveAndWriteFrames(Reassembler *r, int outputFd, e2sar::FrameBuil
     // Continue processing until Ctrl+C is pressed (threadsRunning = false)
     while(threadsRunning)
     {
+#ifdef ENABLE_FRAME_BUILDER
+        // Runtime reconfiguration requested with SIGHUP
+        if (frameBuilder != nullptr && reloadTuningRequested.exchange(false)) {
+            reloadBuilderTuning(frameBuilder);
+        }
+#endif
+
         // ====================================================================
         // STEP 1: Receive Next Reassembled Frame
         // ====================================================================
@@ -599,7 +803,7 @@ result<int> receiveAndWriteFrames(Reassembler *r, int outputFd, e2sar::FrameBuil
             std::cerr << "Skipping frame " << eventNum << " due to invalid payload" << std::endl;
 
             // Clean up the unusable frame buffer
-            delete[] eventBuf;
+            payloadReclaimer->retire(eventBuf, eventSize);
             eventBuf = nullptr;
             continue;  // Skip to next frame
         }
@@ -622,7 +826,7 @@ result<int> receiveAndWriteFrames(Reassembler *r, int outputFd, e2sar::FrameBuil
         // Use reassembler's eventNum for frame building (stream-independent numbering).
 
         uint64_t timestamp   = meta.timestamp;     // 64-bit timestamp from payload words 15-16
-        uint32_t frameNumber = eventNum;           // Use reassembler's event number for alignment
+        uint64_t frameNumber = eventNum;           // Reassembler's 64-bit event number, used for alignment
         uint16_t rocId       = meta.dataId;        // ROC ID from payload word 10
         uint32_t payloadFrameNum = meta.frameNumber;  // Frame number from payload (for reference)
 
@@ -705,8 +909,8 @@ result<int> receiveAndWriteFrames(Reassembler *r, int outputFd, e2sar::FrameBuil
             // STEP 6: Clean Up Frame Buffer
             // ====================================================================
             // The event buffer was allocated by the reassembler's recvEvent()
-            // We must delete it here to avoid memory leaks
-            delete[] eventBuf;
+            // We must release it here to avoid memory leaks
+            payloadReclaimer->retire(eventBuf, eventSize);
             eventBuf = nullptr;
         }
 
@@ -740,6 +944,9 @@ result<int> receiveAndWriteFrames(Reassembler *r, int outputFd, e2sar::FrameBuil
         frameBuilder->stop();
     }
 
+    // Free the payloads still waiting for the reclaimer
+    payloadReclaimer->stop();
+
     // Close output file if open.
     if (outputFd >= 0) {
         std::cout << "Closing output file..." << std::endl;
@@ -808,6 +1015,60 @@ void statsReportingThread(Reassembler *r)
                   << (frameBuilderPtr != nullptr ? "events" : "frames") << "/sec" << std::endl;
         std::cout << "  Data Rate: " << std::fixed << std::setprecision(2)
                   << buildEventDataRateMBps << " MB/sec" << std::endl;
+        if (frameBuilderPtr != nullptr) {
+            uint64_t checked, failed, skipped;
+            frameBuilderPtr->getValidationStatistics(checked, failed, skipped);
+            if (checked > 0 || skipped > 0) {
+                std::cout << "--- Sampled Validation ---" << std::endl;
+                std::cout << "  Frames Checked: " << checked << " (" << skipped << " skipped)" << std::endl;
+                std::cout << "  Failures: " << failed << " (" << std::fixed << std::setprecision(3)
+                          << (checked > 0 ? 100.0 * failed / checked : 0.0) << "%)" << std::endl;
+            }
+        }
+        if (frameBuilderPtr != nullptr) {
+            uint64_t ingested, written, lost, duplicates, late;
+            frameBuilderPtr->getAuditStatistics(ingested, written, lost, duplicates, late);
+            if (ingested > 0) {
+                std::cout << "--- Slice Audit ---" << std::endl;
+                std::cout << "  Ingested: " << ingested << ", Written: " << written << std::endl;
+                std::cout << "  Lost: " << lost << " (" << std::fixed << std::setprecision(3)
+                          << (100.0 * lost / ingested) << "%), Duplicates: " << duplicates
+                          << ", Late: " << late << std::endl;
+            }
+        }
+        if (frameBuilderPtr != nullptr) {
+            std::vector<e2sar::FrameRouteStats> routes;
+            frameBuilderPtr->getRouteStatistics(routes);
+            if (!routes.empty()) {
+                std::cout << "--- Frame Routing ---" << std::endl;
+                for (const auto& r : routes) {
+                    std::cout << "  " << r.spec << ": " << r.written << " written, " << r.dropped
+                              << " dropped, " << r.errors << " errors, " << r.queued << " queued" << std::endl;
+                }
+            }
+        }
+        if (frameBuilderPtr != nullptr) {
+            uint64_t bypassedSlices, bypassedBytes, bypassEpisodes;
+            int bypassActive;
+            frameBuilderPtr->getOverloadStatistics(bypassedSlices, bypassedBytes, bypassEpisodes, bypassActive);
+            if (bypassEpisodes > 0) {
+                std::cout << "--- Overload Passthrough ---" << std::endl;
+                std::cout << "  Episodes: " << bypassEpisodes << " (" << bypassActive << " threads now)" << std::endl;
+                std::cout << "  Bypassed: " << bypassedSlices << " slices, " << std::fixed << std::setprecision(2)
+                          << (bypassedBytes / (1024.0 * 1024.0)) << " MB" << std::endl;
+            }
+        }
+        if (frameBuilderPtr != nullptr) {
+            uint64_t stallEpisodes, stallMs;
+            int stallsActive;
+            frameBuilderPtr->getStallStatistics(stallEpisodes, stallMs, stallsActive);
+            if (stallEpisodes > 0) {
+                std::cout << "--- Builder Stalls ---" << std::endl;
+                std::cout << "  Episodes: " << stallEpisodes << " (" << stallsActive << " ongoing)" << std::endl;
+                std::cout << "  Stalled Time: " << stallMs << " ms" << std::endl;
+            }
+        }
+        printReclaimStatistics("  ");
         std::cout << "--- Errors ---" << std::endl;
         std::cout << "  Write Errors: " << writeErrors << std::endl;
         std::cout << "  Receive Errors: " << receivedWithError << std::endl;
@@ -838,6 +1099,8 @@ int main(int argc, char **argv)
     std::vector<int> coreList;
     int numaNode;
     bool autoIP, withCP, preferV6, validate;
+    int lbCalibrateMs;
+    double lbCalibrateRef;
 
     auto opts = od.add_options()("help,h", "show this help message");
 
@@ -873,6 +1136,23 @@ int main(int argc, char **argv)
     int timestampSlop;
     int frameTimeout;
     int expectedStreams;
+    bool fbLittleEndian;
+    bool alignPayloadFrame;
+    double fbValidateFraction;
+    size_t fbAuditWindow;
+    int fbStallThreshold;
+    std::vector<std::string> fbRouteSpecs;
+    uint64_t fbFileSizeMB;
+    int fbFileSeconds;
+    uint64_t fbFileFrames;
+    size_t fbOverloadBacklog;
+    size_t fbOverloadResume;
+    std::string fbOverloadDir;
+    size_t reclaimMinKB;
+    bool noReclaim;
+#ifdef ENABLE_FRAME_BUILDER
+    std::vector<e2sar::FrameRoute> fbRoutes;
+#endif
 
     // Framebuilding control option
     opts("enable-framebuild", po::value<bool>(&enableFramebuild)->default_value(false),
@@ -895,6 +1175,50 @@ int main(int argc, char **argv)
          "frame builder file output prefix (default: frames)");
     opts("fb-threads", po::value<int>(&fbThreads)->default_value(1),
          "number of parallel frame builder threads (default: 1)");
+    opts("fb-file-size-mb", po::value<uint64_t>(&fbFileSizeMB)->default_value(2048),
+         "roll output files over at this size in MB; 0 = no size limit (default: 2048)");
+    opts("fb-file-seconds", po::value<int>(&fbFileSeconds)->default_value(0),
+         "roll output files over this many seconds after they were opened; 0 = no time limit (default: 0)");
+    opts("fb-file-frames", po::value<uint64_t>(&fbFileFrames)->default_value(0),
+         "roll output files over after this many frames; 0 = no frame limit (default: 0)");
+    opts("align-payload-frame", po::bool_switch(&alignPayloadFrame)->default_value(false),
+         "align streams on the ROC frame number in the payload (word 14) instead of the reassembler "
+         "event number; no startup correction factors. Use when all ROCs share a trigger-supervised "
+         "frame count. The event number is still cross-checked per stream (default: false)");
+    opts("fb-validate-fraction", po::value<double>(&fbValidateFraction)->default_value(0.0),
+         "fraction of built frames (0..1, e.g. 0.01) checked in the background with the "
+         "evio_event_parser structure rules; failures and their rate are reported in the stats "
+         "(default: 0, disabled)");
+    opts("fb-audit-window", po::value<size_t>(&fbAuditWindow)->default_value(0),
+         "audit slice conservation: fingerprint every slice at ingest and match it against the "
+         "frames actually written. A slice not written within this many later slices of its stream "
+         "is counted lost; losses, duplicates and late arrivals are reported per stream "
+         "(default: 0, disabled)");
+    opts("fb-stall-threshold", po::value<int>(&fbStallThreshold)->default_value(5000),
+         "stall watchdog threshold in milliseconds: a builder thread busy this long without "
+         "outputting a frame (e.g. blocked in et_events_new or a file write) is reported with its "
+         "stage, queue depths, last event and backtrace; 0 disables (default: 5000)");
+    opts("fb-route", po::value<std::vector<std::string>>(&fbRouteSpecs)->composing(),
+         "routing rule \"MATCH DEST [divert] [queue=N]\", repeatable. MATCH: all, or conditions "
+         "joined by '&': partial, complete, every=N[+R] (frame number mod N), rocs=A,B (streams "
+         "present). DEST: file:DIR or et:N (ET control word 0 = N, for select-mode stations). "
+         "Matching frames are copied to DEST through its own bounded queue (default 256 frames, "
+         "dropped when full); 'divert' keeps them out of the main output");
+    opts("fb-overload-backlog", po::value<size_t>(&fbOverloadBacklog)->default_value(0),
+         "overload passthrough: when this many slices are queued in a builder thread, its new slices "
+         "bypass alignment and are written unaggregated as raw ROC frames to "
+         "{prefix}_overload_file{N}.bin (re-aggregate offline with evio_bulk_build) until the backlog "
+         "clears; 0 disables (default: 0)");
+    opts("fb-overload-resume", po::value<size_t>(&fbOverloadResume)->default_value(0),
+         "backlog at which a builder thread in overload passthrough resumes aggregating "
+         "(default: 0, half of --fb-overload-backlog)");
+    opts("fb-overload-dir", po::value<std::string>(&fbOverloadDir)->default_value(""),
+         "overload passthrough capture directory (default: --fb-output-dir)");
+    opts("fb-little-endian", po::bool_switch(&fbLittleEndian)->default_value(false),
+         "write EVIO-6 file/record/frame headers little-endian (host order on x86, no byte swapping; "
+         "record bit info bit 31 cleared). ROC banks are copied verbatim either way. "
+         "evio_event_parser reads both orders; the other offline tools read big-endian only "
+         "(default: false, big-endian)");
 
     // Frame building options
     opts("framenumber-slop", po::value<int>(&timestampSlop)->default_value(0),
@@ -910,6 +1234,9 @@ int main(int argc, char **argv)
     opts("verbose-frames", po::bool_switch(&verboseFrameInfo)->default_value(false),
          "enable verbose frame logging: print all frames and frame builder alignment messages "
          "(default: false)");
+    opts("config-file", po::value<std::string>(&tuningConfigFile)->default_value(""),
+         "builder tuning file (framenumber-slop, frame-timeout, verbose-frames), applied at "
+         "startup and re-read on SIGHUP to change these at runtime (default: none)");
     opts("verbose-reassemble", po::bool_switch(&verboseReassemble)->default_value(false),
          "print reassembler event numbers for all streams (works in reassembly-only mode, "
          "i.e., --enable-framebuild=0) (default: false)");
@@ -921,6 +1248,13 @@ int main(int argc, char **argv)
          "socket buffer size in bytes (default: 3MB)");
     opts("timeout", po::value<int>(&eventTimeoutMS)->default_value(500), 
          "event reassembly timeout in milliseconds (default: 500)");
+    opts("reclaim-min-kb", po::value<size_t>(&reclaimMinKB)->default_value(128),
+         "reassembled payload buffers of at least this many KB are freed in batches on a reclaimer "
+         "thread instead of the receive/builder thread that drops them (each free of a buffer above "
+         "glibc's mmap threshold is a munmap); the time the hot threads spend releasing them is "
+         "reported in the stats (default: 128)");
+    opts("no-reclaim", po::bool_switch(&noReclaim)->default_value(false),
+         "free payload buffers at once on the thread that drops them (still measured, for comparison)");
 
     // Control plane parameters
     opts("withcp,c", po::bool_switch(&withCP)->default_value(true), 
@@ -929,6 +1263,13 @@ int main(int argc, char **argv)
          "prefer IPv6 for control plane connections");
     opts("novalidate,v", po::bool_switch()->default_value(false), 
          "don't validate TLS certificates");
+    opts("lb-calibrate-ms", po::value<int>(&lbCalibrateMs)->default_value(0),
+         "before registering, build and write synthetic frames for this many milliseconds with the "
+         "configured builder threads and streams (to a scratch directory, never to ET), cap the "
+         "measured MB/s at the NIC speed and register with weight = capacity / --lb-calibrate-ref, "
+         "so faster nodes get a larger share. Needs --enable-framebuild=1 (default: 0, E2SAR default weight)");
+    opts("lb-calibrate-ref", po::value<double>(&lbCalibrateRef)->default_value(1000.0),
+         "capacity in MB/s that maps to registration weight 1.0 (default: 1000)");
 
     // Advanced parameters
     opts("cores", po::value<std::vector<int>>(&coreList)->multitoken(), 
@@ -1069,10 +1410,47 @@ int main(int argc, char **argv)
             std::cerr << "Frame builder threads must be between 1 and 32" << std::endl;
             return -1;
         }
+        if (fbValidateFraction < 0.0 || fbValidateFraction > 1.0) {
+            std::cerr << "Validation sampling fraction must be between 0 and 1" << std::endl;
+            return -1;
+        }
+        if (fbFileSeconds < 0) {
+            std::cerr << "File rollover time must be >= 0" << std::endl;
+            return -1;
+        }
+        if (lbCalibrateMs < 0 || lbCalibrateRef <= 0.0) {
+            std::cerr << "Calibration time must be >= 0 and reference capacity > 0" << std::endl;
+            return -1;
+        }
 
         bool hasETOutput = !etFile.empty();
         bool hasFileOutput = !fbOutputDir.empty();
 
+        if (fbOverloadBacklog > 0) {
+            if (fbOverloadDir.empty() && !hasFileOutput) {
+                std::cerr << "ERROR: --fb-overload-backlog needs --fb-overload-dir or --fb-output-dir" << std::endl;
+                return -1;
+            }
+            if (fbOverloadResume >= fbOverloadBacklog) {
+                std::cerr << "ERROR: --fb-overload-resume must be below --fb-overload-backlog" << std::endl;
+                return -1;
+            }
+        }
+
+        for (const auto& spec : fbRouteSpecs) {
+            e2sar::FrameRoute route;
+            std::string error;
+            if (!e2sar::parseFrameRoute(spec, route, error)) {
+                std::cerr << "ERROR: Bad --fb-route '" << spec << "': " << error << std::endl;
+                return -1;
+            }
+            if (route.sink == e2sar::FrameRoute::Sink::ET && !hasETOutput) {
+                std::cerr << "ERROR: --fb-route '" << spec << "' needs ET output (--et-file)" << std::endl;
+                return -1;
+            }
+            fbRoutes.push_back(route);
+        }
+
         std::cout << "Frame builder: ENABLED" << std::endl;
         if (hasETOutput) {
             std::cout << "  ET output: " << etFile;
@@ -1092,8 +1470,9 @@ int main(int argc, char **argv)
     std::cout << "Frame builder: NOT COMPILED (reassembly-only mode)" << std::endl;
 #endif
 
-    // Set up signal handler
+    // Set up signal handlers
     signal(SIGINT, ctrlCHandler);
+    signal(SIGHUP, sighupHandler);
 
     std::cout << "CODA Frame Builder v" << CODA_FB_VERSION << std::endl;
     std::cout << "Using E2SAR library v" << get_Version() << std::endl;
@@ -1161,6 +1540,35 @@ int main(int argc, char **argv)
             data_ip = boost::asio::ip::make_address(recvIP);
         }
 
+        // Registration weight proportional to measured build capacity
+        if (lbCalibrateMs > 0) {
+#ifdef ENABLE_FRAME_BUILDER
+            if (!enableFramebuild) {
+                std::cerr << "WARNING: --lb-calibrate-ms needs frame building, using default weight" << std::endl;
+            } else if (!withCP) {
+                std::cerr << "WARNING: --lb-calibrate-ms has no effect without the control plane" << std::endl;
+            } else {
+                std::cout << "Calibrating build capacity (" << lbCalibrateMs << " ms)..." << std::endl;
+                double capacity = calibrateBuildCapacity(lbCalibrateMs, fbThreads, expectedStreams, fbOutputDir);
+                double nicSpeed = getInterfaceSpeedMBps(data_ip);
+                if (capacity <= 0.0) {
+                    std::cerr << "WARNING: Build capacity calibration failed, using default weight" << std::endl;
+                } else {
+                    std::cout << std::fixed << std::setprecision(1)
+                              << "  Build capacity: " << capacity << " MB/s" << std::endl;
+                    if (nicSpeed > 0.0) {
+                        std::cout << "  NIC speed: " << nicSpeed << " MB/s" << std::endl;
+                        capacity = std::min(capacity, nicSpeed);
+                    }
+                    rflags.weight = static_cast<float>(capacity / lbCalibrateRef);
+                    std::cout << "  Registration weight: " << std::setprecision(3) << rflags.weight << std::endl;
+                }
+            }
+#else
+            std::cerr << "WARNING: --lb-calibrate-ms needs the frame builder, using default weight" << std::endl;
+#endif
+        }
+
         // Create reassembler with multithreaded UDP reception
         if (coreList.size() > 0) {
             reasPtr = new Reassembler(uri, data_ip, recvStartPort, coreList, rflags);
@@ -1189,11 +1597,24 @@ int main(int argc, char **argv)
 
         std::cout << "Receiver started successfully. Press Ctrl+C to stop." << std::endl;
 
+        // Payload buffers dropped by the receive loop and the builder threads
+        payloadReclaimer = std::make_shared<e2sar::BufferReclaimer>(!noReclaim, reclaimMinKB * 1024);
+
         // Initialize frame builder (only if enabled)
 #ifdef ENABLE_FRAME_BUILDER
         if (enableFramebuild) {
             std::cout << "\nInitializing frame builder..." << std::endl;
 
+            e2sar::FileRollover fileRollover;
+            fileRollover.maxBytes = fbFileSizeMB * 1024 * 1024;
+            fileRollover.maxSeconds = fbFileSeconds;
+            fileRollover.maxFrames = fbFileFrames;
+
+            e2sar::OverloadBypass overloadBypass;
+            overloadBypass.enterSlices = fbOverloadBacklog;
+            overloadBypass.resumeSlices = fbOverloadResume;
+            overloadBypass.dir = fbOverloadDir;
+
             frameBuilderPtr = new e2sar::FrameBuilder(
                 etFile,
                 etHost,
@@ -1205,7 +1626,16 @@ int main(int argc, char **argv)
                 timestampSlop,
                 frameTimeout,
                 expectedStreams,  // Number of expected data streams for aggregation
-                verboseFrameInfo  // Enable verbose logging
+                verboseFrameInfo,  // Enable verbose logging
+                fbLittleEndian,    // EVIO-6 header byte order
+                alignPayloadFrame,  // Alignment key: payload frame number instead of event number
+                fbValidateFraction,  // Fraction of built frames validated in the background
+                fbAuditWindow,      // Slice audit window per stream (0 = no audit)
+                fbStallThreshold,   // Stall watchdog threshold in ms (0 = no watchdog)
+                fbRoutes,           // Routing rules for built frames
+                fileRollover,       // Output file size/time/frame limits
+                overloadBypass,     // Raw passthrough when a builder thread falls behind
+                payloadReclaimer    // Batched release of payload buffers
             );
 
             if (!frameBuilderPtr->start()) {
@@ -1216,6 +1646,11 @@ int main(int argc, char **argv)
                 return -1;
             }
 
+            // Tuning file values override the command line; re-read on SIGHUP
+            if (!tuningConfigFile.empty()) {
+                reloadBuilderTuning(frameBuilderPtr);
+            }
+
             std::cout << "Frame builder started successfully\n" << std::endl;
         } else {
             // Reassembly-only mode - create direct output file
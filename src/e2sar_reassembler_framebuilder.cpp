@@ -34,6 +34,16 @@
  *    - Continue advancing only the lagging streams until alignment is restored
  * 8. After alignment is restored, resume reading from all FIFOs normally
  *
+ * ALTERNATIVE KEY - PAYLOAD FRAME NUMBER:
+ * With payload alignment enabled, the ROC's own frame number (payload word 14)
+ * replaces the event number as the key. It is extended to 64 bits against the
+ * highest key seen so far (signed 32-bit distance), so it survives wraps.
+ * ROCs sharing a trigger-supervised frame count already agree on it: no
+ * correction factors are computed and building starts with the first slice.
+ * In either mode, each stream's event number minus payload frame number is
+ * tracked per builder thread; slices where it changes from the stream's first
+ * value are counted as key mismatches (a slipped correction or a lost frame).
+ *
  * KEY BEHAVIORS:
  * - Per-stream correction factors are computed once at startup and remain constant
  * - Never consume from a FIFO that already has a larger corrected event number
@@ -58,6 +68,9 @@
  */
 
 #include "e2sar_reassembler_framebuilder.hpp"
+#include "evio6/evio6_view.hpp"
+#include "evio6/evio6_writer.hpp"
+#include "evio6/evio6_validate.hpp"
 #include <et.h>
 #include <iostream>
 #include <iomanip>
@@ -65,7 +78,9 @@
 #include <vector>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -78,41 +93,38 @@
 #include <iomanip>
 #include <sstream>
 #include <filesystem>
+#include <cerrno>
+#include <fcntl.h>
 #include <sys/stat.h>
-#include <arpa/inet.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#endif
 
 namespace e2sar {
 
-// EVIO-6 CODA Tags (from EMU Evio.java)
-namespace CODATag {
-    constexpr uint16_t STREAMING_PHYS = 0xFFD0;        // Streaming physics event
-    constexpr uint16_t STREAMING_SIB_BUILT = 0xFFD1;   // Stream Info Bank (built)
-    constexpr uint16_t STREAMING_TSS_BUILT = 0x01;     // Time Slice Segment (built)
-    constexpr uint16_t STREAMING_AIS_BUILT = 0x02;     // Aggregation Info Segment (built)
-}
-
-namespace DataType {
-    constexpr uint8_t BANK = 0x10;
-    constexpr uint8_t SEGMENT = 0x20;
-}
-
 /**
  * Structure representing a single reassembled time slice from one stream
  */
 struct TimeSlice {
     uint64_t timestamp;      // Frame timestamp
-    uint32_t frameNumber;    // Frame number
+    uint64_t frameNumber;    // Event number (64-bit, as delivered by the reassembler)
     uint16_t dataId;         // Data source ID (ROC ID, stream ID, etc.)
     uint16_t streamStatus;   // Stream status bits
-    std::unique_ptr<uint8_t[]> payloadPtr;  // Owns the reassembled payload buffer
+    std::unique_ptr<uint8_t[], ReclaimDeleter> payloadPtr;  // Owns the reassembled payload buffer
     size_t payloadSize;                      // Size of payload in bytes
 
     TimeSlice() : timestamp(0), frameNumber(0), dataId(0), streamStatus(0), payloadSize(0) {}
 
-    // Transfer ownership constructor - takes ownership of the buffer pointer
-    TimeSlice(uint64_t ts, uint32_t frame, uint16_t id, uint8_t* data, size_t len)
+    // Transfer ownership constructor - takes ownership of the buffer pointer,
+    // which goes to the reclaimer (if any) when the slice is destroyed
+    TimeSlice(uint64_t ts, uint64_t frame, uint16_t id, uint8_t* data, size_t len,
+              BufferReclaimer* reclaimer = nullptr)
         : timestamp(ts), frameNumber(frame), dataId(id), streamStatus(0)
-        , payloadPtr(data), payloadSize(len) {}
+        , payloadPtr(data, ReclaimDeleter{reclaimer, len}), payloadSize(len) {}
 };
 
 /**
@@ -126,7 +138,7 @@ struct TimeSlice {
  */
 struct AggregatedFrame {
     uint64_t timestamp;       // Average timestamp (for validation and output)
-    uint32_t frameNumber;     // PRIMARY KEY for aggregation
+    uint64_t frameNumber;     // PRIMARY KEY for aggregation (corrected 64-bit event number)
     std::vector<TimeSlice> slices;
     std::chrono::steady_clock::time_point arrivalTime;  // When first slice arrived
 
@@ -150,486 +162,1418 @@ struct AggregatedFrame {
 };
 
 /**
- * Individual Builder Thread
- * Each thread builds frames assigned to it by hash of frame number
+ * Builder thread stages, as reported by the stall watchdog
  */
-class BuilderThread {
-private:
-    int threadIndex;
-    int threadCount;
-    std::string threadName;
+enum class BuilderStage : int {
+    WAITING,      // Waiting for slices or for a partial frame to time out
+    ALIGNING,     // Picking the next frame from the stream FIFOs
+    BUILDING,     // Serializing the EVIO-6 record
+    ET_NEW,       // et_events_new (2 s timeouts)
+    ET_PUT,       // et_events_put
+    FILE_WRITE    // Writing or rolling over the output file
+};
 
-    // ET system access (shared)
-    et_sys_id etSystem;
-    et_att_id etAttachment;
-    bool useET;
+static const char* builderStageName(BuilderStage stage) {
+    switch (stage) {
+        case BuilderStage::WAITING:    return "waiting for data";
+        case BuilderStage::ALIGNING:   return "aligning streams";
+        case BuilderStage::BUILDING:   return "building frame";
+        case BuilderStage::ET_NEW:     return "et_events_new";
+        case BuilderStage::ET_PUT:     return "et_events_put";
+        case BuilderStage::FILE_WRITE: return "file write";
+        default:                       return "unknown";
+    }
+}
 
-    // File output
-    std::string outputDir;
-    std::string outputPrefix;
-    bool useFileOutput;
-    std::ofstream outputFile;
-    uint64_t currentFileSize;
-    uint64_t maxFileSize;  // 2GB
-    int currentFileNumber;
-    std::mutex fileMutex;
+static int64_t steadyNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-    // ALIGNMENT-BASED FRAME BUILDING:
-    // Each stream has its own FIFO queue of reassembled frames.
-    // Frames are built only when all streams are aligned on the same frame number.
-    std::unordered_map<uint16_t, std::queue<TimeSlice>> streamFIFOs;  // Key: dataId (stream ID)
+#if defined(__GLIBC__)
+// Watchdog backtrace request: the stalled thread prints its own stack
+static void backtraceSignalHandler(int) {
+    void* frames[64];
+    int depth = backtrace(frames, 64);
+    backtrace_symbols_fd(frames, depth, STDERR_FILENO);
+}
+#endif
 
-    // Track first arrival time for each frame number (for timeout handling)
-    std::unordered_map<uint32_t, std::chrono::steady_clock::time_point> frameArrivalTimes;
+// Built frame shared by the validator and the routing destinations
+// (moved in after output, never copied)
+using SharedFrame = std::shared_ptr<const std::vector<uint8_t>>;
 
-    // PER-STREAM EVENT NUMBER CORRECTION FACTORS:
-    // At startup, if streams have misaligned event numbers, we compute a constant
-    // correction factor for each stream to align them to the minimum observed event number.
-    // These corrections remain fixed for the entire run.
-    std::unordered_map<uint16_t, int64_t> streamEventNumCorrections;  // streamId -> offset
-    bool correctionFactorsInitialized{false};
-    uint32_t minInitialEventNum{UINT32_MAX};  // Lowest event number seen at startup
+/**
+ * Sampled Validator - background EVIO-6 structure check of built frames
+ *
+ * Builder threads hand over a sampled fraction of their frames after output,
+ * moved into a shared buffer (no copy). One thread at idle scheduling priority
+ * validates them with the evio_event_parser rules (evio6_validate.hpp). The
+ * queue is bounded: when the validator falls behind, samples are skipped and
+ * counted, never waited for, so the builders are not slowed down.
+ */
+class SampledValidator {
+private:
+    static constexpr size_t MAX_QUEUED_FRAMES = 64;
+    static constexpr uint64_t MAX_REPORTED_FAILURES = 10;
 
-    std::mutex frameMutex;
-    std::condition_variable frameCV;
+    double fraction;
+    bool littleEndian;
 
-    // Thread control
+    std::mutex queueMutex;
+    std::condition_variable queueCV;
+    std::queue<SharedFrame> queue;
+    bool running{false};
     std::thread thread;
-    std::atomic<bool> running{false};
 
-    // Configuration
-    int frameNumberSlop;       // Max allowed frame number difference for validation (after correction)
-    int frameTimeoutMs;        // How long to wait for all expected streams before partial build
-    int etEventSize;
-    int expectedStreamCount;   // Number of expected data streams per frame number
-    bool verboseLogging;       // Enable verbose logging of frame building progress
+    // Statistics
+    std::atomic<uint64_t> sampled{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> skipped{0};
+    std::atomic<uint64_t> errorCounts[static_cast<size_t>(evio6::RecordError::COUNT)] = {};
+
+    void validate(const std::vector<uint8_t>& frame) {
+        evio6::RecordError error = littleEndian ?
+            evio6::validateAggregatedRecord<evio6::LittleEndian>(frame.data(), frame.size()) :
+            evio6::validateAggregatedRecord<evio6::BigEndian>(frame.data(), frame.size());
+        sampled++;
+        if (error == evio6::RecordError::NONE) return;
+
+        errorCounts[static_cast<size_t>(error)]++;
+        if (failed++ < MAX_REPORTED_FAILURES) {
+            uint64_t eventNum = frame.size() < evio6::HEADER_BYTES ? 0 : littleEndian ?
+                evio6::BasicRecordView<evio6::LittleEndian>(frame.data(), frame.size()).userRegister1() :
+                evio6::RecordView(frame.data(), frame.size()).userRegister1();
+            std::cerr << "[Validator] ERROR: Built frame for event number " << eventNum
+                      << " (" << frame.size() << " bytes) failed validation: "
+                      << evio6::recordErrorName(error) << std::endl;
+        }
+    }
 
-    // Statistics (thread-local, no contention)
-    uint64_t framesBuilt{0};
-    uint64_t slicesProcessed{0};
-    uint64_t buildErrors{0};
-    uint64_t frameNumberErrors{0};
-    uint64_t filesCreated{0};
-    uint64_t bytesWritten{0};
+    void threadFunc() {
+        // Only use CPU time nothing else wants
+#ifdef SCHED_IDLE
+        sched_param param{};
+        if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0) {
+            std::cerr << "[Validator] WARNING: Could not lower thread priority" << std::endl;
+        }
+#endif
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
+            queueCV.wait(lock, [this]() { return !queue.empty() || !running; });
+            if (queue.empty()) break;  // Stopped and drained
+
+            SharedFrame frame = std::move(queue.front());
+            queue.pop();
+            lock.unlock();
+            validate(*frame);
+            frame.reset();  // Release the buffer outside the lock
+            lock.lock();
+        }
+    }
 
 public:
-    BuilderThread(int index, int count, et_sys_id sys, et_att_id att,
-                  int fnSlop, int timeout, int evtSize,
-                  bool enableET, bool enableFile,
-                  const std::string& fileDir, const std::string& filePrefix,
-                  int numExpectedStreams, bool verbose)
-        : threadIndex(index)
-        , threadCount(count)
-        , etSystem(sys)
-        , etAttachment(att)
-        , useET(enableET)
-        , outputDir(fileDir)
-        , outputPrefix(filePrefix)
-        , useFileOutput(enableFile)
-        , currentFileSize(0)
-        , maxFileSize(2ULL * 1024 * 1024 * 1024)  // 2GB
-        , currentFileNumber(0)
-        , frameNumberSlop(fnSlop)
-        , frameTimeoutMs(timeout)
-        , etEventSize(evtSize)
-        , expectedStreamCount(numExpectedStreams)
-        , verboseLogging(verbose)
-    {
-        threadName = "Builder-" + std::to_string(index);
+    SampledValidator(double sampleFraction, bool littleEndianFrames)
+        : fraction(sampleFraction), littleEndian(littleEndianFrames) {}
+
+    ~SampledValidator() { stop(); }
+
+    double getFraction() const { return fraction; }
+
+    void start() {
+        running = true;
+        thread = std::thread(&SampledValidator::threadFunc, this);
     }
 
     /**
-     * Open a new output file with sequential numbering
+     * Validate the queued samples, then stop the thread
      */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            running = false;
+        }
+        queueCV.notify_one();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
     /**
-     * Write EVIO-6 file header (14 words = 56 bytes)
-     * This should be written once at the beginning of each new file
+     * Queue a sampled frame; skipped (not blocked on) if the queue is full
      */
-    bool writeFileHeader() {
-        // NOTE: This function assumes outputFile is open and fileMutex is held
-
-        // EVIO-6 File Header: 14 words (32-bit) in BIG-ENDIAN
-        uint32_t fileHeader[14] = {
-            0x4556494F,  // WORD 0: File Type ID "EVIO" in ASCII
-            0x00000000,  // WORD 1: File Number (0 if unused)
-            0x0000000E,  // WORD 2: Header Length (14 words)
-            0x00000000,  // WORD 3: Record Count (0 if unknown)
-            0x00000000,  // WORD 4: File Index Array Length (0)
-            0x00000006,  // WORD 5: Bit Info + Version (low 8 bits = 0x06 for EVIO6)
-            0x00000000,  // WORD 6: User Header Length (0)
-            0xC0DA0100,  // WORD 7: Magic Number
-            0x00000000,  // WORD 8: User Register low 32 bits
-            0x00000000,  // WORD 9: User Register high 32 bits
-            0x00000000,  // WORD 10: Trailer Position low 32 bits (0 if no trailer)
-            0x00000000,  // WORD 11: Trailer Position high 32 bits
-            0x00000000,  // WORD 12: User Integer 1
-            0x00000000   // WORD 13: User Integer 2
-        };
-
-        // Convert to big-endian if needed
-        for (int i = 0; i < 14; i++) {
-            fileHeader[i] = htonl(fileHeader[i]);
+    void submit(SharedFrame frame) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (!running || queue.size() >= MAX_QUEUED_FRAMES) {
+                skipped++;
+                return;
+            }
+            queue.push(std::move(frame));
         }
+        queueCV.notify_one();
+    }
 
-        // Write file header
-        outputFile.write(reinterpret_cast<const char*>(fileHeader), 56);
-        if (!outputFile) {
-            std::cerr << "[" << threadName << "] Failed to write file header" << std::endl;
-            return false;
-        }
+    void getStats(uint64_t& sampledFrames, uint64_t& failedFrames, uint64_t& skippedFrames) const {
+        sampledFrames = sampled;
+        failedFrames = failed;
+        skippedFrames = skipped;
+    }
 
-        currentFileSize += 56;
-        return true;
+    /**
+     * Print sample counts, failure rate and failures per rule
+     */
+    void printStatistics() const {
+        uint64_t n = sampled;
+        uint64_t f = failed;
+        std::cout << "  Sampled Validation: " << n << " frames checked ("
+                  << (fraction * 100.0) << "% sampling), " << skipped << " skipped" << std::endl;
+        std::cout << "  Validation Failures: " << f;
+        if (n > 0) {
+            std::cout << " (" << (100.0 * f / n) << "%)";
+        }
+        std::cout << std::endl;
+        for (size_t i = 1; i < static_cast<size_t>(evio6::RecordError::COUNT); i++) {
+            if (errorCounts[i] > 0) {
+                std::cout << "    " << evio6::recordErrorName(static_cast<evio6::RecordError>(i))
+                          << ": " << errorCounts[i] << std::endl;
+            }
+        }
     }
+};
+
+/**
+ * Slice Auditor - proves every ingested slice was written exactly once
+ *
+ * A 64-bit fingerprint (stream, event number, ROC bank size, first and last
+ * ROC bank words) is recorded per slice at ingest and matched against the ROC
+ * banks of each frame the sinks accepted. Per stream, a sliding window of the
+ * last N ingested slices bounds memory: a slice still unmatched when N newer
+ * slices of its stream have arrived is counted lost. Recently written and
+ * recently lost fingerprints are remembered for another N slices, to tell
+ * duplicates and late arrivals apart from unknown output.
+ *
+ * Streams are spread over independently locked shards, so receiver and
+ * builder threads working on different streams do not contend.
+ */
+class SliceAuditor {
+public:
+    struct StreamTotals {
+        uint64_t ingested = 0;
+        uint64_t written = 0;      // Matched exactly once
+        uint64_t lost = 0;         // Left the window unmatched (minus late arrivals)
+        uint64_t duplicates = 0;   // Matched a recently written slice
+        uint64_t late = 0;         // Matched a slice already counted lost
+        uint64_t unknown = 0;      // Written but never ingested (or beyond the window)
+        uint64_t pending = 0;      // Still in the window
+    };
 
-    bool openNextFile() {
-        // NOTE: This function assumes the caller already holds fileMutex
-        // It is called from writeToFile() which holds the lock
+    /**
+     * Fingerprint of one ROC bank (ROC data of a slice, or a bank of a written frame)
+     */
+    static uint64_t fingerprint(uint16_t streamId, uint64_t eventNum, const uint8_t* rocBank, size_t bytes) {
+        evio6::RocBankView bank(rocBank, bytes);
+        size_t size = bank.valid() ? bank.sizeBytes() : bytes & ~size_t(3);
+        uint32_t first = size >= 4 ? evio6::loadBE32(rocBank) : 0;
+        uint32_t last = size >= 4 ? evio6::loadBE32(rocBank + size - 4) : 0;
+
+        // splitmix64 finalizer over the packed fields
+        auto mix = [](uint64_t h, uint64_t v) {
+            h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+            h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ULL;
+            h ^= h >> 27; h *= 0x94D049BB133111EBULL;
+            return h ^ (h >> 31);
+        };
+        uint64_t h = mix(streamId, eventNum);
+        h = mix(h, size);
+        return mix(h, (static_cast<uint64_t>(first) << 32) | last);
+    }
 
-        // Close current file if open
-        if (outputFile.is_open()) {
-            outputFile.close();
+private:
+    static constexpr size_t SHARDS = 16;
+
+    // Bounded FIFO + set of fingerprints
+    struct RecentSet {
+        std::deque<uint64_t> order;
+        std::unordered_set<uint64_t> members;
+
+        void add(uint64_t fp, size_t limit) {
+            if (members.insert(fp).second) {
+                order.push_back(fp);
+                if (order.size() > limit) {
+                    members.erase(order.front());
+                    order.pop_front();
+                }
+            }
         }
+        bool take(uint64_t fp) { return members.erase(fp) > 0; }  // Left in order, skipped on eviction
+    };
 
-        // Generate filename: {prefix}_thread{N}_file{M}.evio
-        std::ostringstream filename;
-        filename << outputDir << "/" << outputPrefix
-                 << "_thread" << threadIndex
-                 << "_file" << std::setfill('0') << std::setw(4) << currentFileNumber
-                 << ".evio";
+    struct StreamAudit {
+        std::deque<uint64_t> window;                       // Ingested fingerprints, oldest first
+        std::unordered_map<uint64_t, uint32_t> pending;    // Ingested, not yet written
+        RecentSet recentWritten;
+        RecentSet recentLost;
+        StreamTotals totals;
+    };
 
-        std::string filepath = filename.str();
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<uint16_t, StreamAudit> streams;
+    };
 
-        // Open file in binary mode
-        outputFile.open(filepath, std::ios::binary | std::ios::out | std::ios::trunc);
-        if (!outputFile) {
-            std::cerr << "[" << threadName << "] Failed to open output file: "
-                      << filepath << std::endl;
-            return false;
-        }
+    size_t windowSlices;
+    Shard shards[SHARDS];
 
-        currentFileSize = 0;
-        filesCreated++;
+    Shard& shardFor(uint16_t streamId) { return shards[streamId % SHARDS]; }
 
-        std::cout << "[" << threadName << "] Opened output file: " << filepath << std::endl;
+public:
+    explicit SliceAuditor(size_t window) : windowSlices(window) {}
 
-        // Write EVIO-6 file header at the beginning of the file
-        if (!writeFileHeader()) {
-            std::cerr << "[" << threadName << "] Failed to write EVIO-6 file header" << std::endl;
-            outputFile.close();
-            return false;
-        }
+    size_t getWindow() const { return windowSlices; }
 
-        return true;
+    /**
+     * Record a slice at ingest; slices leaving the window unmatched are counted lost
+     */
+    void recordIngested(uint16_t streamId, uint64_t fp) {
+        Shard& shard = shardFor(streamId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        StreamAudit& audit = shard.streams[streamId];
+
+        audit.totals.ingested++;
+        audit.pending[fp]++;
+        audit.window.push_back(fp);
+
+        while (audit.window.size() > windowSlices) {
+            uint64_t oldest = audit.window.front();
+            audit.window.pop_front();
+            auto it = audit.pending.find(oldest);
+            if (it != audit.pending.end()) {
+                if (--it->second == 0) audit.pending.erase(it);
+                audit.totals.lost++;
+                audit.recentLost.add(oldest, windowSlices);
+            }
+        }
     }
 
     /**
-     * Check if file rollover is needed and perform it
+     * Match a ROC bank of a written frame
      */
-    bool checkAndRollover() {
-        if (currentFileSize >= maxFileSize) {
-            std::cout << "[" << threadName << "] File size limit reached ("
-                      << currentFileSize << " bytes), rolling over..." << std::endl;
-            currentFileNumber++;
-            return openNextFile();
+    void recordWritten(uint16_t streamId, uint64_t fp) {
+        Shard& shard = shardFor(streamId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        StreamAudit& audit = shard.streams[streamId];
+
+        auto it = audit.pending.find(fp);
+        if (it != audit.pending.end()) {
+            // Stays in the window deque; skipped there once no longer pending
+            if (--it->second == 0) audit.pending.erase(it);
+            audit.totals.written++;
+            audit.recentWritten.add(fp, windowSlices);
+        } else if (audit.recentLost.take(fp)) {
+            audit.totals.lost--;
+            audit.totals.late++;
+            audit.totals.written++;
+            audit.recentWritten.add(fp, windowSlices);
+        } else if (audit.recentWritten.members.count(fp)) {
+            audit.totals.duplicates++;
+        } else {
+            audit.totals.unknown++;
         }
-        return true;
     }
 
     /**
-     * Write frame data to file
+     * Per-stream totals (pending = ingested slices still inside the window)
      */
-    bool writeToFile(const std::vector<uint8_t>& frameData) {
-        std::lock_guard<std::mutex> lock(fileMutex);
-
-        if (!outputFile.is_open()) {
-            if (!openNextFile()) {
-                std::cerr << "[" << threadName << "] Failed to open output file" << std::endl;
-                buildErrors++;
-                return false;
+    std::map<uint16_t, StreamTotals> getTotals() {
+        std::map<uint16_t, StreamTotals> result;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& [streamId, audit] : shard.streams) {
+                StreamTotals t = audit.totals;
+                for (const auto& [fp, count] : audit.pending) t.pending += count;
+                result[streamId] = t;
             }
         }
+        return result;
+    }
 
-        // Write frame data
-        outputFile.write(reinterpret_cast<const char*>(frameData.data()), frameData.size());
-
-        if (!outputFile) {
-            std::cerr << "[" << threadName << "] Error writing to file" << std::endl;
-            buildErrors++;
-            return false;
+    /**
+     * Per-stream report; slices still pending after the builders stopped are lost
+     */
+    void printStatistics(bool final) {
+        std::cout << "  Slice Audit (window " << windowSlices << " slices/stream):" << std::endl;
+        for (const auto& [streamId, t] : getTotals()) {
+            uint64_t lost = t.lost + (final ? t.pending : 0);
+            std::cout << "    Stream " << streamId << ": ingested " << t.ingested
+                      << ", written " << t.written << ", lost " << lost
+                      << " (" << (t.ingested > 0 ? 100.0 * lost / t.ingested : 0.0) << "%)"
+                      << ", duplicates " << t.duplicates << ", late " << t.late;
+            if (t.unknown > 0) std::cout << ", unknown " << t.unknown;
+            if (!final) std::cout << ", pending " << t.pending;
+            std::cout << std::endl;
         }
+    }
+};
 
-        currentFileSize += frameData.size();
-        bytesWritten += frameData.size();
+/**
+ * Rollover File - rolled-over output files with the file work off the write path
+ *
+ * Files are {dir}/{prefix}_file{NNNN}.evio. A helper thread keeps the next
+ * file created, preallocated (where the file system supports fallocate) and
+ * with its file header written, so a rollover on the write path only swaps
+ * descriptors. The finished file goes back to the helper, which appends the
+ * trailer with the record index, releases the unused preallocation, rewrites
+ * the file header with the record count and trailer position, and closes it.
+ *
+ * A file rolls over at its size, age or frame count limit, whichever comes
+ * first; the limits are checked when a frame is written. Only the owning
+ * thread writes; the helper never touches the current file.
+ */
+class RolloverFile {
+private:
+    struct OpenFile {
+        int fd{-1};
+        std::string path;
+        uint32_t number{0};
+        uint64_t bytes{0};                // File header included
+        std::vector<uint32_t> index;      // Trailer index: length in bytes, event count per record
+        std::chrono::steady_clock::time_point openedAt;
+    };
 
-        // Check if we need to rollover at 2GB
-        if (currentFileSize >= maxFileSize) {
-            std::cout << "[" << threadName << "] File size limit reached ("
-                      << (currentFileSize / (1024*1024)) << " MB), rolling over to next file..." << std::endl;
-            currentFileNumber++;
-            if (!openNextFile()) {
+    std::string outputDir;
+    std::string outputPrefix;
+    std::string name;                     // Owner, for log messages
+    FileRollover limits;
+    bool littleEndian;
+
+    OpenFile current;                     // Owner thread only
+    std::atomic<uint64_t> filesOpened{0};
+
+    // Helper thread (state below under helperMutex)
+    std::mutex helperMutex;
+    std::condition_variable helperCV;     // Work for the helper
+    std::condition_variable preparedCV;   // Next file ready (or failed)
+    std::thread helper;
+    bool helperRunning{false};
+    bool prepareRequested{false};
+    bool prepareFailed{false};
+    uint32_t nextNumber{0};
+    OpenFile prepared;                    // fd < 0 while not ready
+    std::deque<OpenFile> finishing;
+
+    static bool writeAll(int fd, const uint8_t* data, size_t bytes) {
+        while (bytes > 0) {
+            ssize_t n = ::write(fd, data, bytes);
+            if (n < 0) {
+                if (errno == EINTR) continue;
                 return false;
             }
+            data += n;
+            bytes -= n;
         }
-
         return true;
     }
 
-    /**
-     * Close output file
-     */
-    void closeFile() {
-        std::lock_guard<std::mutex> lock(fileMutex);
-        if (outputFile.is_open()) {
-            outputFile.flush();
-            outputFile.close();
-            std::cout << "[" << threadName << "] Closed output file" << std::endl;
+    void encodeHeader(uint8_t* header, const OpenFile& file, uint64_t trailerPosition, uint32_t bitInfo) const {
+        const uint32_t records = static_cast<uint32_t>(file.index.size() / evio6::TRAILER_INDEX_WORDS_PER_RECORD);
+        if (littleEndian) {
+            evio6::encodeFileHeader<evio6::LittleEndian>(header, file.number, records, trailerPosition, bitInfo);
+        } else {
+            evio6::encodeFileHeader<evio6::BigEndian>(header, file.number, records, trailerPosition, bitInfo);
         }
     }
 
     /**
-     * Add a time slice to this builder's per-stream FIFO
-     *
-     * EVENT-NUMBER-BASED AGGREGATION:
-     * - Each stream has its own FIFO queue
-     * - Slices are enqueued to their stream's FIFO
-     * - Builder thread will check alignment using corrected event numbers
-     * - Timeout tracking uses corrected event numbers (after startup)
+     * Create, preallocate and write the placeholder file header (helper thread)
      */
-    void addTimeSlice(TimeSlice&& slice) {
-        std::lock_guard<std::mutex> lock(frameMutex);
-
-        uint16_t streamId = slice.dataId;
-        uint32_t rawEventNum = slice.frameNumber;
-
-        // Compute corrected event number for timeout tracking
-        // During startup before corrections are initialized, use raw event number
-        uint32_t trackingEventNum = correctionFactorsInitialized ?
-                                    getCorrectedEventNum(streamId, rawEventNum) :
-                                    rawEventNum;
-
-        // Track first arrival time for this corrected event number (for timeout)
-        if (frameArrivalTimes.find(trackingEventNum) == frameArrivalTimes.end()) {
-            frameArrivalTimes[trackingEventNum] = std::chrono::steady_clock::now();
+    bool prepareFile(OpenFile& file, uint32_t number) {
+        std::ostringstream filename;
+        filename << outputDir << "/" << outputPrefix
+                 << "_file" << std::setfill('0') << std::setw(4) << number << ".evio";
+        file.path = filename.str();
+        file.number = number;
+
+        file.fd = ::open(file.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (file.fd < 0) {
+            std::cerr << "[" << name << "] Failed to open output file: " << file.path
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            return false;
         }
 
-        // Enqueue slice to its stream's FIFO
-        streamFIFOs[streamId].push(std::move(slice));
-        slicesProcessed++;
-
-        // Signal builder thread
-        frameCV.notify_one();
+#ifdef FALLOC_FL_KEEP_SIZE
+        // Reserve the blocks without changing the file size; not emulated where
+        // unsupported (EOPNOTSUPP), unlike posix_fallocate
+        if (limits.maxBytes > 0) {
+            fallocate(file.fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(limits.maxBytes));
+        }
+#endif
+
+        uint8_t header[evio6::HEADER_BYTES];
+        encodeHeader(header, file, 0, 0);
+        if (!writeAll(file.fd, header, evio6::HEADER_BYTES)) {
+            std::cerr << "[" << name << "] Failed to write file header: " << file.path
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            ::close(file.fd);
+            file.fd = -1;
+            return false;
+        }
+        file.bytes = evio6::HEADER_BYTES;
+        return true;
     }
 
     /**
-     * Build EVIO-6 aggregated time frame bank
+     * Trailer, file size, final file header, close (helper thread)
      */
-    bool buildEVIO6Frame(const AggregatedFrame& frame, std::vector<uint8_t>& output) {
-        // ========================================================================
-        // STEP 1: Validate and Process Input Frames
-        // ========================================================================
-        // Each slice payload contains:
-        // - Words 1-8: CODA block header (word 8 = 0xc0da0100 magic)
-        // - Words 9+: ROC bank data (to be extracted)
+    void finishFile(OpenFile& file) {
+        const uint64_t trailerPosition = file.bytes;
+        const size_t records = file.index.size() / evio6::TRAILER_INDEX_WORDS_PER_RECORD;
+        std::vector<uint8_t> trailer(evio6::trailerBytes(records));
+        if (littleEndian) {
+            evio6::encodeTrailer<evio6::LittleEndian>(trailer.data(), records + 1, file.index.data(), records);
+        } else {
+            evio6::encodeTrailer<evio6::BigEndian>(trailer.data(), records + 1, file.index.data(), records);
+        }
 
-        int sliceCount = frame.slices.size();
-        bool hasError = checkFrameNumberConsistency(frame);
-        if (hasError) frameNumberErrors++;
+        bool ok = writeAll(file.fd, trailer.data(), trailer.size());
+        const uint64_t fileBytes = trailerPosition + trailer.size();
 
-        // Calculate timestamp average
-        uint64_t tsAvg = calculateAverageTimestamp(frame);
+        // Truncating to the current size releases the preallocated blocks past it
+        ok = ftruncate(file.fd, static_cast<off_t>(fileBytes)) == 0 && ok;
 
-        // Build stream status: bit 7 = error flag, bits 0-6 = slice count
-        int streamStatus = ((hasError ? 1 : 0) << 7) | (sliceCount & 0x7F);
+        uint8_t header[evio6::HEADER_BYTES];
+        encodeHeader(header, file, trailerPosition, evio6::BitInfo::TRAILER_WITH_INDEX);
+        ok = pwrite(file.fd, header, evio6::HEADER_BYTES, 0) == static_cast<ssize_t>(evio6::HEADER_BYTES) && ok;
+        ok = ::close(file.fd) == 0 && ok;
+        file.fd = -1;
 
-        // Validate slices and calculate total ROC data size (first pass)
-        struct ValidatedSlice {
-            const uint8_t* rocData;  // Points to payload + 32 bytes
-            size_t rocSize;          // Size of ROC data (payload size - 32)
-        };
-        std::vector<ValidatedSlice> validatedSlices;
-        validatedSlices.reserve(frame.slices.size());
+        if (!ok) {
+            std::cerr << "[" << name << "] ERROR: Failed to finish output file " << file.path
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+        } else {
+            std::cout << "[" << name << "] Closed output file: " << file.path << " (" << records
+                      << " records, " << fileBytes << " bytes)" << std::endl;
+        }
+    }
 
-        for (const auto& slice : frame.slices) {
-            // Verify minimum size (8 words = 32 bytes)
-            if (slice.payloadSize < 32) {
-                std::cerr << "[" << threadName << "] ERROR: Payload too small (" << slice.payloadSize
-                         << " bytes), need at least 32 bytes for CODA header" << std::endl;
-                hasError = true;
-                continue;
+    void helperFunc() {
+        std::unique_lock<std::mutex> lock(helperMutex);
+        while (true) {
+            helperCV.wait(lock, [this]() {
+                return (prepareRequested && helperRunning) || !finishing.empty() || !helperRunning;
+            });
+
+            // The next file first: a writer may be waiting for it
+            if (prepareRequested && helperRunning) {
+                prepareRequested = false;
+                uint32_t number = nextNumber++;
+                lock.unlock();
+                OpenFile file;
+                bool ok = prepareFile(file, number);
+                lock.lock();
+                if (ok) {
+                    prepared = std::move(file);
+                } else {
+                    prepareFailed = true;
+                }
+                preparedCV.notify_all();
+            } else if (!finishing.empty()) {
+                OpenFile file = std::move(finishing.front());
+                finishing.pop_front();
+                lock.unlock();
+                finishFile(file);
+                lock.lock();
+            } else {
+                break;  // Stopped and all files finished
             }
+        }
+    }
 
-            // Validate word 8 = 0xc0da0100 (BIG endian)
-            // Word 8 is at byte offset 28 (7*4)
-            const uint32_t* words = reinterpret_cast<const uint32_t*>(slice.payloadPtr.get());
-            uint32_t magic = words[7];
-
-            // Check if magic matches (either endianness - we'll accept both)
-            if (magic != 0xc0da0100 && magic != 0x0001dac0) {
-                std::cerr << "[" << threadName << "] ERROR: Invalid CODA magic number at word 8: 0x"
-                         << std::hex << std::setfill('0') << std::setw(8) << magic << std::dec
-                         << " (expected 0xc0da0100 or 0x0001dac0)" << std::endl;
-                hasError = true;
-                continue;
+    /**
+     * Make the prepared file current and have the helper prepare the one after it
+     */
+    bool takePrepared() {
+        std::unique_lock<std::mutex> lock(helperMutex);
+        if (prepared.fd < 0 && !prepareFailed && helperRunning) {
+            auto waitStart = std::chrono::steady_clock::now();
+            preparedCV.wait(lock, [this]() { return prepared.fd >= 0 || prepareFailed || !helperRunning; });
+            auto waitedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - waitStart).count();
+            if (filesOpened > 0 && waitedMs > 0) {
+                std::cerr << "[" << name << "] WARNING: Rollover waited " << waitedMs
+                          << " ms for the next file" << std::endl;
             }
-
-            // Record validated slice (ROC data starts at byte 32)
-            ValidatedSlice vs;
-            vs.rocData = slice.payloadPtr.get() + 32;
-            vs.rocSize = slice.payloadSize - 32;
-            validatedSlices.push_back(vs);
         }
 
-        if (validatedSlices.empty()) {
-            std::cerr << "[" << threadName << "] ERROR: No valid ROC banks after CODA header validation" << std::endl;
+        prepareRequested = true;
+        helperCV.notify_one();
+        if (prepared.fd < 0) {
+            prepareFailed = false;  // Retried by the helper for the next frame
             return false;
         }
 
-        // ========================================================================
-        // STEP 2: Build EVIO-6 Record Header (14 words)
-        // ========================================================================
-        std::vector<uint32_t> eventWords;
-
-        eventWords.push_back(0);  // Word 0: recordLength (filled later)
-        eventWords.push_back(framesBuilt + 1);  // Word 1: recordNumber (1-indexed count of successfully built frames)
-        eventWords.push_back(14); // Word 2: headerLength (always 14 for EVIO-6)
-        eventWords.push_back(1);  // Word 3: eventIndexCount (1 event per record)
-        eventWords.push_back(0);  // Word 4: indexArrayLength (0 = no index)
-
-        // Word 5: bitInfo = version | flags | byteOrder
-        uint32_t bitInfo = 6 |           // version 6
-                           (1 << 9) |     // last block flag
-                           (1 << 14) |    // header type = EVIO record
-                           (1U << 31);    // BIG endian (bit 31=1)
-        eventWords.push_back(bitInfo);
-
-        eventWords.push_back(0);           // Word 6: userHeaderLength
-        eventWords.push_back(0xc0da0100);  // Word 7: magic number
-        eventWords.push_back(0);           // Word 8: uncompressedDataLength (filled later)
-
-        // Word 9: compressionType (24 bits) | compressedDataLength (8 bits)
-        eventWords.push_back(0);           // No compression
-
-        // Words 10-13: userRegisters (4 words = 2 x 64-bit registers)
-        eventWords.push_back(0);
-        eventWords.push_back(0);
-        eventWords.push_back(0);
-        eventWords.push_back(0);
-
-        // ========================================================================
-        // STEP 3: Build Aggregated Frame Bank (0xFF60 structure)
-        // ========================================================================
-
-        // Track where event data starts (after 14-word record header)
-        size_t aggregatedBankLengthIndex = eventWords.size();
-        eventWords.push_back(0);  // aggregatedBankLength (filled later)
+        current = std::move(prepared);
+        prepared = OpenFile();
+        current.openedAt = std::chrono::steady_clock::now();
+        filesOpened++;
+        lock.unlock();
 
-        // Aggregated frame bank header: 0xFF60 (tag) | 0x10 (BANK type) | streamStatus
-        uint32_t aggBankHeader = (0xFF60 << 16) | (0x10 << 8) | streamStatus;
-        eventWords.push_back(aggBankHeader);
+        std::cout << "[" << name << "] Opened output file: " << current.path << std::endl;
+        return true;
+    }
 
-        // ========================================================================
-        // STEP 4: Build Stream Info Bank (0xFF31 structure)
-        // ========================================================================
+    /**
+     * Hand the current file to the helper for finishing
+     */
+    void retireCurrent() {
+        if (current.fd < 0) return;
+        {
+            std::lock_guard<std::mutex> lock(helperMutex);
+            finishing.push_back(std::move(current));
+        }
+        current = OpenFile();
+        helperCV.notify_one();
+    }
 
-        size_t streamInfoLengthIndex = eventWords.size();
-        eventWords.push_back(0);  // streamInfoLength (filled later)
+    bool rolloverDue(size_t bytes) const {
+        const uint64_t frames = current.index.size() / evio6::TRAILER_INDEX_WORDS_PER_RECORD;
+        if (frames == 0) return false;
+        if (limits.maxBytes > 0 && current.bytes + bytes > limits.maxBytes) return true;
+        if (limits.maxFrames > 0 && frames >= limits.maxFrames) return true;
+        return limits.maxSeconds > 0 &&
+               std::chrono::steady_clock::now() - current.openedAt >= std::chrono::seconds(limits.maxSeconds);
+    }
 
-        // Stream info bank header: 0xFF31 (tag) | 0x20 (SEGMENT type) | streamStatus
-        uint32_t streamInfoHeader = (0xFF31 << 16) | (0x20 << 8) | streamStatus;
-        eventWords.push_back(streamInfoHeader);
+public:
+    RolloverFile(const std::string& dir, const std::string& prefix, const std::string& owner,
+                 const FileRollover& rollover, bool littleEndianFiles)
+        : outputDir(dir)
+        , outputPrefix(prefix)
+        , name(owner)
+        , limits(rollover)
+        , littleEndian(littleEndianFiles) {}
 
-        // --- Time Slice Segment (TSS) ---
-        // Tag (8 bits) | type (8 bits) | length (16 bits)
-        uint32_t tssHeader = (0x32 << 24) | (0x01 << 16) | 3;  // 3 words of data
-        eventWords.push_back(tssHeader);
+    ~RolloverFile() { close(); }
 
-        // TSS data: frameNumber, timestamp (64-bit split into 2 words)
-        eventWords.push_back(static_cast<uint32_t>(frame.frameNumber));
-        eventWords.push_back(static_cast<uint32_t>(tsAvg & 0xFFFFFFFF));        // timestamp low
-        eventWords.push_back(static_cast<uint32_t>((tsAvg >> 32) & 0xFFFFFFFF)); // timestamp high
+    RolloverFile(const RolloverFile&) = delete;
+    RolloverFile& operator=(const RolloverFile&) = delete;
 
-        // --- Aggregation Info Segment (AIS) ---
-        // Tag (8 bits) | type (8 bits) | length (16 bits)
-        uint32_t aisHeader = (0x42 << 24) | (0x01 << 16) | sliceCount;
-        eventWords.push_back(aisHeader);
+    /**
+     * Start the helper, which prepares the first file right away
+     */
+    void start() {
+        std::lock_guard<std::mutex> lock(helperMutex);
+        helperRunning = true;
+        prepareRequested = true;
+        helper = std::thread(&RolloverFile::helperFunc, this);
+    }
 
-        // AIS data: ROC IDs (one word per ROC)
-        // Format per word: ROC_ID (16 bits) | reserved (8 bits) | stream_status (8 bits)
-        for (const auto& slice : frame.slices) {
-            uint32_t aisEntry = (slice.dataId << 16) | slice.streamStatus;
-            eventWords.push_back(aisEntry);
+    /**
+     * Append one record, rolling over first if a limit is reached
+     *
+     * @return false if no file could be opened or the write failed
+     */
+    bool write(const uint8_t* data, size_t bytes) {
+        if (current.fd >= 0 && rolloverDue(bytes)) {
+            std::cout << "[" << name << "] File limit reached (" << (current.bytes / (1024*1024)) << " MB, "
+                      << current.index.size() / evio6::TRAILER_INDEX_WORDS_PER_RECORD
+                      << " frames), rolling over to next file..." << std::endl;
+            retireCurrent();
+        }
+        if (current.fd < 0 && !takePrepared()) {
+            return false;
         }
 
-        // Calculate streamInfoLength (words after length field up to here)
-        size_t streamInfoLength = eventWords.size() - streamInfoLengthIndex - 1;
-        eventWords[streamInfoLengthIndex] = static_cast<uint32_t>(streamInfoLength);
+        if (!writeAll(current.fd, data, bytes)) {
+            std::cerr << "[" << name << "] Error writing to file " << current.path
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            return false;
+        }
+        current.bytes += bytes;
+        current.index.push_back(static_cast<uint32_t>(bytes));
+        current.index.push_back(1);  // One aggregated frame per record
+        return true;
+    }
 
-        // ========================================================================
-        // STEP 5: Calculate Total Payload Size
-        // ========================================================================
+    /**
+     * Finish all files, remove the unused prepared one and stop the helper;
+     * safe to call more than once
+     */
+    void close() {
+        retireCurrent();
+        {
+            std::lock_guard<std::mutex> lock(helperMutex);
+            helperRunning = false;
+        }
+        helperCV.notify_one();
+        preparedCV.notify_all();
+        if (helper.joinable()) {
+            helper.join();
+        }
+        if (prepared.fd >= 0) {
+            ::close(prepared.fd);
+            ::unlink(prepared.path.c_str());
+            prepared = OpenFile();
+        }
+    }
+
+    uint64_t filesCreated() const { return filesOpened; }
+};
+
+/**
+ * Route Sink - one routing destination with its own queue and thread
+ *
+ * Builder threads evaluate the precompiled rule on each built frame
+ * (matches(): a few compares, plus one scan of the slice IDs per required
+ * stream) and hand matching frames over as shared buffers, so the main
+ * output, the validator and any number of routes use one copy. Each
+ * destination has a bounded queue and a thread of its own: a full queue
+ * drops the frame and counts it, so a slow destination never blocks the
+ * builders, the main output or the other destinations.
+ */
+class RouteSink {
+private:
+    static constexpr uint64_t MAX_FILE_SIZE = 2ULL * 1024 * 1024 * 1024;  // 2GB
+
+    FrameRoute route;
+    std::string name;          // "Route-N"
+
+    // ET destination (shared system, own attachment)
+    et_sys_id etSystem;
+    et_att_id etAttachment;
+    int etEventSize;
+
+    std::mutex queueMutex;
+    std::condition_variable queueCV;
+    std::queue<SharedFrame> queue;
+    bool running{false};
+    std::thread thread;
+
+    // File destination (null for ET)
+    std::unique_ptr<RolloverFile> outputFile;
+
+    // Statistics
+    std::atomic<uint64_t> matched{0};
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> bytes{0};
+
+    bool sendToET(const std::vector<uint8_t>& frameData) {
+        et_event* events[1];
+        int numRead = 0;
+        struct timespec timeout;
+        timeout.tv_sec = 2;
+        timeout.tv_nsec = 0;
+
+        int status = et_events_new(etSystem, etAttachment, events, ET_TIMED,
+                                   &timeout, etEventSize, 1, &numRead);
+        if (status != ET_OK) {
+            std::cerr << "[" << name << "] Failed to get new ET event: " << status << std::endl;
+            return false;
+        }
+
+        void* eventData;
+        size_t eventLength;
+        et_event_getdata(events[0], &eventData);
+        et_event_getlength(events[0], &eventLength);
+        if (frameData.size() > eventLength) {
+            std::cerr << "[" << name << "] Frame data too large for ET event: "
+                      << frameData.size() << " > " << eventLength << std::endl;
+            et_events_dump(etSystem, etAttachment, events, 1);
+            return false;
+        }
+
+        std::memcpy(eventData, frameData.data(), frameData.size());
+        et_event_setlength(events[0], frameData.size());
+
+        // Stations in select mode "match" on word 0 pick these events up
+        int control[1] = {route.etControl};
+        et_event_setcontrol(events[0], control, 1);
+
+        status = et_events_put(etSystem, etAttachment, events, 1);
+        if (status != ET_OK) {
+            std::cerr << "[" << name << "] Failed to put ET event: " << status << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void threadFunc() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
+            queueCV.wait(lock, [this]() { return !queue.empty() || !running; });
+            if (queue.empty()) break;  // Stopped and drained
+
+            SharedFrame frame = std::move(queue.front());
+            queue.pop();
+            lock.unlock();
 
-        size_t totalPayloadBytes = 0;
-        for (const auto& vs : validatedSlices) {
-            totalPayloadBytes += vs.rocSize;
-            // Account for padding to 4-byte boundary
-            if (vs.rocSize % 4 != 0) {
-                totalPayloadBytes += 4 - (vs.rocSize % 4);
+            bool ok = outputFile ? outputFile->write(frame->data(), frame->size()) : sendToET(*frame);
+            if (ok) {
+                written++;
+                bytes += frame->size();
+            } else {
+                errors++;
             }
+            frame.reset();  // Release the buffer outside the lock
+            lock.lock();
+        }
+
+        if (outputFile) {
+            outputFile->close();
+        }
+    }
+
+public:
+    RouteSink(const FrameRoute& rule, int index, const std::string& prefix, bool littleEndianFrames,
+              const FileRollover& rollover, et_sys_id sys, et_att_id att, int evtSize)
+        : route(rule)
+        , name("Route-" + std::to_string(index))
+        , etSystem(sys)
+        , etAttachment(att)
+        , etEventSize(evtSize)
+    {
+        if (route.sink == FrameRoute::Sink::FILE) {
+            outputFile = std::make_unique<RolloverFile>(route.fileDir, prefix + "_route" + std::to_string(index),
+                                                        name, rollover, littleEndianFrames);
         }
+    }
+
+    ~RouteSink() { stop(); }
+
+    bool isDivert() const { return route.divert; }
 
-        size_t totalPayloadWords = totalPayloadBytes / 4;
+    /**
+     * Evaluate the rule on a frame about to be output
+     */
+    bool matches(const AggregatedFrame& frame, int expectedStreams) const {
+        const size_t slices = frame.slices.size();
+        if (route.partialOnly && slices >= static_cast<size_t>(expectedStreams)) return false;
+        if (route.completeOnly && slices < static_cast<size_t>(expectedStreams)) return false;
+        if (route.everyN != 0 && frame.frameNumber % route.everyN != route.remainder) return false;
+        for (uint16_t roc : route.rocs) {
+            bool present = false;
+            for (const auto& slice : frame.slices) {
+                if (slice.dataId == roc) {
+                    present = true;
+                    break;
+                }
+            }
+            if (!present) return false;
+        }
+        return true;
+    }
 
+    bool start() {
+        if (outputFile) {
+            std::error_code ec;
+            std::filesystem::create_directories(route.fileDir, ec);
+            if (ec) {
+                std::cerr << "[" << name << "] Failed to create output directory '" << route.fileDir
+                          << "': " << ec.message() << std::endl;
+                return false;
+            }
+            outputFile->start();
+        }
+        running = true;
+        thread = std::thread(&RouteSink::threadFunc, this);
+        return true;
+    }
+
+    /**
+     * Write out the queued frames, then stop the thread
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            running = false;
+        }
+        queueCV.notify_one();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    /**
+     * Queue a matching frame; dropped (not blocked on) if the queue is full
+     *
+     * @return true if the frame was queued
+     */
+    bool submit(const SharedFrame& frame) {
+        matched++;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (!running || queue.size() >= route.queueFrames) {
+                dropped++;
+                return false;
+            }
+            queue.push(frame);
+        }
+        queueCV.notify_one();
+        return true;
+    }
+
+    void getStats(FrameRouteStats& stats) {
+        stats.spec = route.spec;
+        stats.matched = matched;
+        stats.written = written;
+        stats.dropped = dropped;
+        stats.errors = errors;
+        stats.bytes = bytes;
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stats.queued = queue.size();
+    }
+};
+
+/**
+ * Parse a routing rule: "MATCH DEST [divert] [queue=N]"
+ */
+bool parseFrameRoute(const std::string& text, FrameRoute& route, std::string& error) {
+    route = FrameRoute();
+    route.spec = text;
+
+    std::istringstream words(text);
+    std::string match, dest, word;
+    if (!(words >> match >> dest)) {
+        error = "expected MATCH and DEST";
+        return false;
+    }
+
+    // Unsigned integer, the whole token
+    auto parseNumber = [](const std::string& token, uint64_t& value) {
+        if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos) return false;
+        try {
+            value = std::stoull(token);
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    };
+
+    // Conditions joined by '&'
+    if (match != "all") {
+        std::istringstream conditions(match);
+        std::string cond;
+        while (std::getline(conditions, cond, '&')) {
+            if (cond == "partial") {
+                route.partialOnly = true;
+            } else if (cond == "complete") {
+                route.completeOnly = true;
+            } else if (cond.rfind("every=", 0) == 0) {
+                std::string arg = cond.substr(6);
+                size_t plus = arg.find('+');
+                if (!parseNumber(arg.substr(0, plus), route.everyN) || route.everyN == 0 ||
+                    (plus != std::string::npos && !parseNumber(arg.substr(plus + 1), route.remainder)) ||
+                    route.remainder >= route.everyN) {
+                    error = "bad condition '" + cond + "' (every=N or every=N+R, R < N)";
+                    return false;
+                }
+            } else if (cond.rfind("rocs=", 0) == 0) {
+                std::istringstream ids(cond.substr(5));
+                std::string id;
+                while (std::getline(ids, id, ',')) {
+                    uint64_t roc;
+                    if (!parseNumber(id, roc) || roc > UINT16_MAX) {
+                        error = "bad stream ID '" + id + "' in '" + cond + "'";
+                        return false;
+                    }
+                    route.rocs.push_back(static_cast<uint16_t>(roc));
+                }
+                if (route.rocs.empty()) {
+                    error = "empty stream list in '" + cond + "'";
+                    return false;
+                }
+            } else {
+                error = "unknown condition '" + cond + "'";
+                return false;
+            }
+        }
+        if (route.partialOnly && route.completeOnly) {
+            error = "'partial' and 'complete' never match together";
+            return false;
+        }
+    }
+
+    if (dest.rfind("file:", 0) == 0 && dest.size() > 5) {
+        route.sink = FrameRoute::Sink::FILE;
+        route.fileDir = dest.substr(5);
+    } else if (dest.rfind("et:", 0) == 0) {
+        uint64_t control;
+        if (!parseNumber(dest.substr(3), control) || control > INT32_MAX) {
+            error = "bad ET control word in '" + dest + "'";
+            return false;
+        }
+        route.sink = FrameRoute::Sink::ET;
+        route.etControl = static_cast<int>(control);
+    } else {
+        error = "unknown destination '" + dest + "' (file:DIR or et:N)";
+        return false;
+    }
+
+    while (words >> word) {
+        uint64_t depth;
+        if (word == "divert") {
+            route.divert = true;
+        } else if (word.rfind("queue=", 0) == 0 && parseNumber(word.substr(6), depth) && depth > 0) {
+            route.queueFrames = static_cast<size_t>(depth);
+        } else {
+            error = "unknown option '" + word + "' (divert or queue=N)";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Overload Capture - raw passthrough of slices that bypass aggregation
+ *
+ * While a builder thread is overloaded, new slices are written here by the
+ * thread delivering them, the same way reassembly-only mode writes its
+ * output: raw ROC frames back to back, one write() per slice under a mutex.
+ * The CODA block header and ROC bank header of each frame carry its length,
+ * ROC ID, frame number and timestamp, so evio_raw_scan indexes the capture
+ * and evio_bulk_build re-aggregates it. Files are opened on the first bypassed
+ * slice ({prefix}_overload_file{NNNN}.bin) and roll over at the output
+ * file size limit.
+ */
+class OverloadCapture {
+private:
+    std::string outputDir;
+    std::string outputPrefix;
+    uint64_t maxBytes;             // 0 = no size limit
+
+    std::mutex mutex;              // Guards the file below
+    int fd{-1};
+    uint32_t nextNumber{0};
+    uint64_t fileBytes{0};
+
+    std::atomic<uint64_t> slices{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> files{0};
+
+    // Caller holds mutex
+    bool openNext() {
+        closeCurrent();
+        std::ostringstream filename;
+        filename << outputDir << "/" << outputPrefix << "_overload_file"
+                 << std::setfill('0') << std::setw(4) << nextNumber++ << ".bin";
+        fd = ::open(filename.str().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "[Overload] ERROR: Failed to open capture file: " << filename.str()
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            return false;
+        }
+        fileBytes = 0;
+        files++;
+        std::cout << "[Overload] Writing bypassed slices to " << filename.str() << std::endl;
+        return true;
+    }
+
+    // Caller holds mutex
+    void closeCurrent() {
+        if (fd >= 0) {
+            fsync(fd);
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+public:
+    OverloadCapture(const std::string& dir, const std::string& prefix, uint64_t fileLimit)
+        : outputDir(dir), outputPrefix(prefix), maxBytes(fileLimit) {}
+
+    ~OverloadCapture() { close(); }
+
+    bool start() {
+        std::error_code ec;
+        std::filesystem::create_directories(outputDir, ec);
+        if (ec) {
+            std::cerr << "[Overload] Failed to create capture directory '" << outputDir
+                      << "': " << ec.message() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Append one slice (thread-safe); the caller keeps ownership of data
+     */
+    bool write(const uint8_t* data, size_t length) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (fd < 0 || (maxBytes > 0 && fileBytes > 0 && fileBytes + length > maxBytes)) {
+            if (!openNext()) {
+                errors++;
+                return false;
+            }
+        }
+
+        size_t done = 0;
+        while (done < length) {
+            ssize_t n = ::write(fd, data + done, length - done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errors++ == 0) {
+                    std::cerr << "[Overload] ERROR: Capture write failed: " << std::strerror(errno) << std::endl;
+                }
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+
+        fileBytes += length;
+        slices++;
+        bytes += length;
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closeCurrent();
+    }
+
+    void getStats(uint64_t& capturedSlices, uint64_t& capturedBytes, uint64_t& writeErrors,
+                  uint64_t& capturedFiles) const {
+        capturedSlices = slices;
+        capturedBytes = bytes;
+        writeErrors = errors;
+        capturedFiles = files;
+    }
+};
+
+/**
+ * Individual Builder Thread
+ * Each thread builds frames assigned to it by hash of frame number
+ */
+class BuilderThread {
+private:
+    int threadIndex;
+    int threadCount;
+    std::string threadName;
+
+    // ET system access (shared)
+    et_sys_id etSystem;
+    et_att_id etAttachment;
+    bool useET;
+
+    // File output
+    bool useFileOutput;
+    std::unique_ptr<RolloverFile> outputFile;  // {prefix}_thread{N}_file{M}.evio
+    std::mutex fileMutex;
+
+    // Payload release: kept alive while this thread holds slices (declared
+    // before the FIFOs, whose slices point to it)
+    std::shared_ptr<BufferReclaimer> reclaimer;
+
+    // ALIGNMENT-BASED FRAME BUILDING:
+    // Each stream has its own FIFO queue of reassembled frames.
+    // Frames are built only when all streams are aligned on the same frame number.
+    std::unordered_map<uint16_t, std::queue<TimeSlice>> streamFIFOs;  // Key: dataId (stream ID)
+
+    // Track first arrival time for each frame number (for timeout handling)
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> frameArrivalTimes;
+
+    // PER-STREAM EVENT NUMBER CORRECTION FACTORS:
+    // At startup, if streams have misaligned event numbers, we compute a constant
+    // correction factor for each stream to align them to the minimum observed event number.
+    // These corrections remain fixed for the entire run.
+    std::unordered_map<uint16_t, int64_t> streamEventNumCorrections;  // streamId -> offset
+    bool correctionFactorsInitialized{false};
+    uint64_t minInitialEventNum{UINT64_MAX};  // Lowest event number seen at startup
+
+    // EVENT NUMBER / PAYLOAD FRAME NUMBER CROSS-CHECK:
+    // Low 32 bits of (event number - payload frame number) of a stream's first
+    // slice, and the number of later slices that disagree with it.
+    struct KeyCrossCheck {
+        uint32_t offset;
+        uint64_t mismatches;
+    };
+    std::unordered_map<uint16_t, KeyCrossCheck> keyCrossChecks;  // streamId -> cross-check
+
+    std::mutex frameMutex;
+    std::condition_variable frameCV;
+
+    // RUNTIME TUNING:
+    // New parameters are posted under frameMutex and picked up by the builder
+    // thread between two frames, so a frame is always built with one consistent
+    // set of values. The active values (frameNumberSlop, frameTimeoutMs,
+    // verboseLogging) are only read and written by the builder thread.
+    BuilderTuning pendingTuning{};
+    uint64_t pendingTuningVersion{1};
+    uint64_t activeTuningVersion{1};
+    uint64_t lastBuiltEventNum{0};
+    bool anyFrameBuilt{false};
+
+    // Thread control
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> finished{false};  // threadFunc has returned
+
+    // WATCHDOG STATE:
+    // Written by the builder thread only, read by the watchdog. The thread is
+    // idle while it lacks input (empty FIFOs, or streams missing at startup);
+    // the activity time is reset when it gets work after being idle and when
+    // a frame is output. Failed frames (e.g. ET timeouts) do not reset it.
+    std::atomic<int> stage{static_cast<int>(BuilderStage::WAITING)};
+    std::atomic<int64_t> stageSinceMs{0};
+    std::atomic<bool> idle{true};
+    std::atomic<int64_t> activitySinceMs{0};
+    std::atomic<uint64_t> lastOutputEventNum{0};
+    std::atomic<uint64_t> framesOutput{0};
+
+    // OVERLOAD PASSTHROUGH:
+    // Slices waiting in the FIFOs (maintained under frameMutex, read without it)
+    // and whether new slices currently bypass them for the overload capture.
+    std::atomic<size_t> queuedSlices{0};
+    std::atomic<bool> bypassing{false};
+    std::atomic<uint64_t> bypassEpisodes{0};
+
+    // Configuration
+    int frameNumberSlop;       // Max allowed frame number difference for validation (after correction)
+    int frameTimeoutMs;        // How long to wait for all expected streams before partial build
+    int etEventSize;
+    int expectedStreamCount;   // Number of expected data streams per frame number
+    bool verboseLogging;       // Enable verbose logging of frame building progress
+    bool littleEndianOutput;   // Write EVIO-6 headers little-endian (bit info bit 31 cleared)
+
+    // Sampled background validation (null if disabled)
+    SampledValidator* validator;
+
+    // Slice conservation audit of written frames (null if disabled)
+    SliceAuditor* auditor;
+
+    // Routing destinations, in rule order, and the ones the current frame matched
+    std::vector<RouteSink*> routes;
+    std::vector<RouteSink*> matchedRoutes;
+    double sampleCredit{0.0};  // Accumulates the sampling fraction per frame; sample at 1
+
+    // Statistics (thread-local, no contention)
+    uint64_t framesBuilt{0};
+    uint64_t slicesProcessed{0};
+    uint64_t buildErrors{0};
+    uint64_t frameNumberErrors{0};
+    uint64_t bytesWritten{0};
+
+public:
+    BuilderThread(int index, int count, et_sys_id sys, et_att_id att,
+                  int fnSlop, int timeout, int evtSize,
+                  bool enableET, bool enableFile,
+                  const std::string& fileDir, const std::string& filePrefix, const FileRollover& rollover,
+                  int numExpectedStreams, bool verbose, bool littleEndian, bool alignOnPayloadFrame,
+                  SampledValidator* frameValidator, SliceAuditor* sliceAuditor,
+                  const std::vector<RouteSink*>& routeSinks,
+                  std::shared_ptr<BufferReclaimer> payloadReclaimer)
+        : threadIndex(index)
+        , threadCount(count)
+        , etSystem(sys)
+        , etAttachment(att)
+        , useET(enableET)
+        , useFileOutput(enableFile)
+        , reclaimer(std::move(payloadReclaimer))
+        , frameNumberSlop(fnSlop)
+        , frameTimeoutMs(timeout)
+        , etEventSize(evtSize)
+        , expectedStreamCount(numExpectedStreams)
+        , verboseLogging(verbose)
+        , littleEndianOutput(littleEndian)
+        , validator(frameValidator)
+        , auditor(sliceAuditor)
+        , routes(routeSinks)
+    {
+        threadName = "Builder-" + std::to_string(index);
+
+        if (useFileOutput) {
+            outputFile = std::make_unique<RolloverFile>(fileDir, filePrefix + "_thread" + std::to_string(index),
+                                                        threadName, rollover, littleEndian);
+            outputFile->start();
+        }
+
+        // Payload frame numbers are already common to all streams: no corrections
+        correctionFactorsInitialized = alignOnPayloadFrame;
+    }
+
+    /**
+     * Write frame data to file (rolls over by size, age or frame count)
+     */
+    bool writeToFile(const std::vector<uint8_t>& frameData) {
+        setStage(BuilderStage::FILE_WRITE);
+        std::lock_guard<std::mutex> lock(fileMutex);
+
+        if (!outputFile->write(frameData.data(), frameData.size())) {
+            buildErrors++;
+            return false;
+        }
+
+        bytesWritten += frameData.size();
+        return true;
+    }
+
+    /**
+     * Finish the output files (trailer, final header) and stop their helper
+     */
+    void closeFile() {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        if (outputFile) {
+            outputFile->close();
+        }
+    }
+
+    /**
+     * Add a time slice to this builder's per-stream FIFO
+     *
+     * EVENT-NUMBER-BASED AGGREGATION:
+     * - Each stream has its own FIFO queue
+     * - Slices are enqueued to their stream's FIFO
+     * - Builder thread will check alignment using corrected event numbers
+     * - Timeout tracking uses corrected event numbers (after startup)
+     *
+     * @param hasKeyOffset  Whether keyOffset is known (payload frame number readable)
+     * @param keyOffset     Low 32 bits of (event number - payload frame number)
+     */
+    void addTimeSlice(TimeSlice&& slice, bool hasKeyOffset, uint32_t keyOffset) {
+        std::lock_guard<std::mutex> lock(frameMutex);
+
+        uint16_t streamId = slice.dataId;
+        uint64_t rawEventNum = slice.frameNumber;
+
+        // Cross-check the two frame counters of this stream
+        if (hasKeyOffset) {
+            auto [it, first] = keyCrossChecks.try_emplace(streamId, KeyCrossCheck{keyOffset, 0});
+            if (!first && it->second.offset != keyOffset && it->second.mismatches++ == 0) {
+                std::cerr << "[" << threadName << "] WARNING: Stream " << streamId
+                          << " event number and payload frame number slipped at key " << rawEventNum
+                          << " (offset " << static_cast<int32_t>(it->second.offset) << " -> "
+                          << static_cast<int32_t>(keyOffset) << ")" << std::endl;
+            }
+        }
+
+        // Compute corrected event number for timeout tracking
+        // During startup before corrections are initialized, use raw event number
+        uint64_t trackingEventNum = correctionFactorsInitialized ?
+                                    getCorrectedEventNum(streamId, rawEventNum) :
+                                    rawEventNum;
+
+        // Track first arrival time for this corrected event number (for timeout)
+        if (frameArrivalTimes.find(trackingEventNum) == frameArrivalTimes.end()) {
+            frameArrivalTimes[trackingEventNum] = std::chrono::steady_clock::now();
+        }
+
+        // Enqueue slice to its stream's FIFO
+        streamFIFOs[streamId].push(std::move(slice));
+        queuedSlices.fetch_add(1, std::memory_order_relaxed);
+        slicesProcessed++;
+
+        // Signal builder thread
+        frameCV.notify_one();
+    }
+
+    /**
+     * Overload passthrough decision for the next slice of this thread
+     *
+     * Switches to passthrough when the backlog reaches enterSlices and back
+     * once it is down to resumeSlices; in between the current mode holds, so
+     * the thread does not flap around one threshold. Called by the threads
+     * delivering slices, without frameMutex.
+     */
+    bool shouldBypass(size_t enterSlices, size_t resumeSlices) {
+        size_t backlog = queuedSlices.load(std::memory_order_relaxed);
+        bool active = bypassing.load(std::memory_order_relaxed);
+
+        if (!active && backlog >= enterSlices) {
+            if (bypassing.compare_exchange_strong(active, true)) {
+                bypassEpisodes++;
+                std::cerr << "[" << threadName << "] WARNING: Backlog of " << backlog
+                          << " slices, new slices go unaggregated to the overload capture" << std::endl;
+            }
+            return true;
+        }
+        if (active && backlog <= resumeSlices) {
+            if (bypassing.compare_exchange_strong(active, false)) {
+                std::cout << "[" << threadName << "] Backlog down to " << backlog
+                          << " slices, aggregation resumed" << std::endl;
+            }
+            return false;
+        }
+        return active;
+    }
+
+    bool isBypassing() const { return bypassing.load(std::memory_order_relaxed); }
+    uint64_t getBypassEpisodes() const { return bypassEpisodes; }
+
+    /**
+     * Build EVIO-6 aggregated time frame bank
+     */
+    bool buildEVIO6Frame(const AggregatedFrame& frame, std::vector<uint8_t>& output) {
         // ========================================================================
-        // STEP 6: Fill in Length Fields
+        // STEP 1: Validate and Process Input Frames
         // ========================================================================
+        // Each slice payload contains:
+        // - Words 1-8: CODA block header (word 8 = 0xc0da0100 magic)
+        // - Words 9+: ROC bank data (to be extracted)
+
+        int sliceCount = frame.slices.size();
+        bool hasError = checkFrameNumberConsistency(frame);
+        if (hasError) frameNumberErrors++;
+
+        // Calculate timestamp average
+        uint64_t tsAvg = calculateAverageTimestamp(frame);
 
-        // aggregatedBankLength = all words after this field
-        size_t aggregatedBankLength = (eventWords.size() - aggregatedBankLengthIndex - 1) + totalPayloadWords;
-        eventWords[aggregatedBankLengthIndex] = static_cast<uint32_t>(aggregatedBankLength);
+        // Build stream status: bit 7 = error flag, bits 0-6 = slice count
+        int streamStatus = ((hasError ? 1 : 0) << 7) | (sliceCount & 0x7F);
 
-        // recordLength = total words in record (header + event data)
-        size_t recordLength = 14 + aggregatedBankLength + 1;  // +1 for aggregatedBankLength field itself
-        eventWords[0] = static_cast<uint32_t>(recordLength);
+        // Validate slices (first pass); ROC data starts after the 32-byte block header
+        std::vector<evio6::SliceRef> validatedSlices;
+        validatedSlices.reserve(frame.slices.size());
 
-        // uncompressedDataLength = bytes after record header (EVIO6 spec: word 8 must be in bytes)
-        size_t uncompressedDataLength = recordLength - 14;
-        eventWords[8] = static_cast<uint32_t>(uncompressedDataLength * 4);  // Convert words to bytes
+        for (const auto& slice : frame.slices) {
+            evio6::RocFrameView roc(slice.payloadPtr.get(), slice.payloadSize);
 
-        // ========================================================================
-        // STEP 7: Byte Swap to BIG Endian and Write Header/Metadata
-        // ========================================================================
+            // Verify minimum size (8 words = 32 bytes)
+            if (!roc.hasHeader()) {
+                std::cerr << "[" << threadName << "] ERROR: Payload too small (" << slice.payloadSize
+                         << " bytes), need at least 32 bytes for CODA header" << std::endl;
+                hasError = true;
+                continue;
+            }
+
+            // Validate word 8 = 0xc0da0100 (either endianness - we'll accept both)
+            if (!roc.hasValidMagic()) {
+                std::cerr << "[" << threadName << "] ERROR: Invalid CODA magic number at word 8: 0x"
+                         << std::hex << std::setfill('0') << std::setw(8) << roc.rawMagic() << std::dec
+                         << " (expected 0xc0da0100 or 0x0001dac0)" << std::endl;
+                hasError = true;
+                continue;
+            }
 
-        // Pre-allocate full output size to avoid repeated reallocations
-        size_t totalOutputSize = eventWords.size() * 4 + totalPayloadBytes;
-        output.reserve(totalOutputSize);
-        output.resize(eventWords.size() * 4);
-        uint32_t* outputWords = reinterpret_cast<uint32_t*>(output.data());
+            validatedSlices.push_back({roc.rocData(), roc.rocBytes(), slice.dataId,
+                                       static_cast<uint8_t>(slice.streamStatus)});
+        }
 
-        // Byte swap to BIG endian
-        for (size_t i = 0; i < eventWords.size(); i++) {
-            uint32_t val = eventWords[i];
-            outputWords[i] = ((val & 0x000000FF) << 24) |
-                            ((val & 0x0000FF00) << 8) |
-                            ((val & 0x00FF0000) >> 8) |
-                            ((val & 0xFF000000) >> 24);
+        if (validatedSlices.empty()) {
+            std::cerr << "[" << threadName << "] ERROR: No valid ROC banks after CODA header validation" << std::endl;
+            return false;
         }
 
         // ========================================================================
-        // STEP 8: Append ROC Banks Directly (Preserve Original Endianness)
+        // STEP 2: Serialize Record Header, Aggregated Bank and ROC Banks
         // ========================================================================
-
-        for (const auto& vs : validatedSlices) {
-            size_t currentSize = output.size();
-            output.resize(currentSize + vs.rocSize);
-            std::memcpy(output.data() + currentSize,
-                       vs.rocData,
-                       vs.rocSize);
-
-            // Pad to 4-byte boundary if needed
-            while (output.size() % 4 != 0) {
-                output.push_back(0);
-            }
+        // Record header, 0xFF60 bank, SIB (TSS + AIS) in the output byte order
+        // (big-endian unless little-endian output is enabled), then the ROC
+        // banks copied verbatim (original endianness) - see evio6_writer.hpp
+
+        evio6::FrameInfo info;
+        info.recordNumber = framesBuilt + 1;  // 1-indexed count of successfully built frames
+        info.frameNumber = static_cast<uint32_t>(frame.frameNumber);  // TSS holds the low 32 bits
+        info.eventNumber = frame.frameNumber;                          // Full value in user register 1
+        info.timestamp = tsAvg;
+        info.streamStatus = static_cast<uint8_t>(streamStatus);
+
+        if (littleEndianOutput) {
+            evio6::writeAggregatedRecord<evio6::LittleEndian>(info, validatedSlices.data(), validatedSlices.size(), output);
+        } else {
+            evio6::writeAggregatedRecord<evio6::BigEndian>(info, validatedSlices.data(), validatedSlices.size(), output);
         }
 
         return !hasError;
@@ -649,13 +1593,13 @@ public:
         if (frame.slices.empty()) return false;
         if (frameNumberSlop <= 0) return false;  // Slop of 0 means no checking
 
-        uint32_t targetCorrectedEventNum = frame.frameNumber;  // This is the corrected event number
+        uint64_t targetCorrectedEventNum = frame.frameNumber;  // This is the corrected event number
 
         for (const auto& slice : frame.slices) {
-            uint32_t rawEventNum = slice.frameNumber;
-            uint32_t correctedEventNum = const_cast<BuilderThread*>(this)->getCorrectedEventNum(slice.dataId, rawEventNum);
+            uint64_t rawEventNum = slice.frameNumber;
+            uint64_t correctedEventNum = const_cast<BuilderThread*>(this)->getCorrectedEventNum(slice.dataId, rawEventNum);
 
-            int64_t diff = std::abs(static_cast<int64_t>(correctedEventNum) - static_cast<int64_t>(targetCorrectedEventNum));
+            int64_t diff = std::abs(static_cast<int64_t>(correctedEventNum - targetCorrectedEventNum));
             if (diff > frameNumberSlop) {
                 std::cerr << "[" << threadName << "] WARNING: Frame number inconsistency in corrected event "
                           << targetCorrectedEventNum << "! "
@@ -697,6 +1641,7 @@ public:
         timeout.tv_nsec = 0;
         int numRead = 0;
 
+        setStage(BuilderStage::ET_NEW);
         status = et_events_new(etSystem, etAttachment, events, ET_TIMED,
                                &timeout, etEventSize, numEvents, &numRead);
         if (status != ET_OK) {
@@ -724,6 +1669,7 @@ public:
         et_event_setlength(events[0], frameData.size());
 
         // Put event back to ET system
+        setStage(BuilderStage::ET_PUT);
         status = et_events_put(etSystem, etAttachment, events, numEvents);
         if (status != ET_OK) {
             std::cerr << "[" << threadName << "] Failed to put ET event: "
@@ -743,15 +1689,16 @@ public:
      *
      * Uses correction factors to align event numbers from different streams.
      */
-    std::pair<bool, uint32_t> getMinimumFrameNumber() {
+    std::pair<bool, uint64_t> getMinimumFrameNumber() {
         // NOTE: Caller must hold frameMutex
-        uint32_t minFrame = UINT32_MAX;
+        // 64-bit event numbers do not wrap within any run, so a plain minimum is safe
+        uint64_t minFrame = UINT64_MAX;
         bool found = false;
 
         for (const auto& [streamId, fifo] : streamFIFOs) {
             if (!fifo.empty()) {
-                uint32_t rawEventNum = fifo.front().frameNumber;
-                uint32_t correctedEventNum = getCorrectedEventNum(streamId, rawEventNum);
+                uint64_t rawEventNum = fifo.front().frameNumber;
+                uint64_t correctedEventNum = getCorrectedEventNum(streamId, rawEventNum);
                 minFrame = std::min(minFrame, correctedEventNum);
                 found = true;
             }
@@ -766,15 +1713,15 @@ public:
      *
      * Uses correction factors to compare event numbers after alignment.
      */
-    std::pair<bool, std::vector<uint16_t>> checkAlignment(uint32_t correctedEventNum) {
+    std::pair<bool, std::vector<uint16_t>> checkAlignment(uint64_t correctedEventNum) {
         // NOTE: Caller must hold frameMutex
         std::vector<uint16_t> alignedStreams;
         bool allAligned = true;
 
         for (const auto& [streamId, fifo] : streamFIFOs) {
             if (!fifo.empty()) {
-                uint32_t rawEventNum = fifo.front().frameNumber;
-                uint32_t streamCorrectedEventNum = getCorrectedEventNum(streamId, rawEventNum);
+                uint64_t rawEventNum = fifo.front().frameNumber;
+                uint64_t streamCorrectedEventNum = getCorrectedEventNum(streamId, rawEventNum);
 
                 if (streamCorrectedEventNum == correctedEventNum) {
                     alignedStreams.push_back(streamId);
@@ -791,7 +1738,7 @@ public:
     /**
      * Check if a frame number has timed out
      */
-    bool hasFrameTimedOut(uint32_t frameNumber) {
+    bool hasFrameTimedOut(uint64_t frameNumber) {
         // NOTE: Caller must hold frameMutex
         auto it = frameArrivalTimes.find(frameNumber);
         if (it == frameArrivalTimes.end()) {
@@ -830,10 +1777,10 @@ public:
         }
 
         // Find the minimum event number across all streams
-        minInitialEventNum = UINT32_MAX;
+        minInitialEventNum = UINT64_MAX;
         for (const auto& [streamId, fifo] : streamFIFOs) {
             if (!fifo.empty()) {
-                uint32_t streamEventNum = fifo.front().frameNumber;
+                uint64_t streamEventNum = fifo.front().frameNumber;
                 minInitialEventNum = std::min(minInitialEventNum, streamEventNum);
             }
         }
@@ -844,8 +1791,8 @@ public:
 
         for (const auto& [streamId, fifo] : streamFIFOs) {
             if (!fifo.empty()) {
-                uint32_t streamEventNum = fifo.front().frameNumber;
-                int64_t correction = static_cast<int64_t>(minInitialEventNum) - static_cast<int64_t>(streamEventNum);
+                uint64_t streamEventNum = fifo.front().frameNumber;
+                int64_t correction = static_cast<int64_t>(minInitialEventNum - streamEventNum);
                 streamEventNumCorrections[streamId] = correction;
 
                 std::cout << "[" << threadName << "]   Stream " << streamId
@@ -859,6 +1806,112 @@ public:
         std::cout << "[" << threadName << "] Correction factors initialized (fixed for this run)" << std::endl;
     }
 
+    /**
+     * Post new runtime parameters; applied by the builder thread before its next frame
+     */
+    void postTuning(const BuilderTuning& tuning, uint64_t version) {
+        {
+            std::lock_guard<std::mutex> lock(frameMutex);
+            pendingTuning = tuning;
+            pendingTuningVersion = version;
+        }
+        frameCV.notify_one();
+    }
+
+    /**
+     * Switch to posted parameters, if any, and log the event number they apply from
+     * NOTE: Caller must hold frameMutex
+     */
+    void applyPendingTuning() {
+        if (pendingTuningVersion == activeTuningVersion) return;
+
+        const BuilderTuning& t = pendingTuning;
+        std::ostringstream changes;
+        if (t.frameTimeoutMs != frameTimeoutMs) {
+            changes << " frame-timeout " << frameTimeoutMs << " -> " << t.frameTimeoutMs << " ms;";
+        }
+        if (t.frameNumberSlop != frameNumberSlop) {
+            changes << " framenumber-slop " << frameNumberSlop << " -> " << t.frameNumberSlop << ";";
+        }
+        if (t.verbose != verboseLogging) {
+            changes << " verbose " << (verboseLogging ? "on" : "off") << " -> " << (t.verbose ? "on" : "off") << ";";
+        }
+
+        frameTimeoutMs = t.frameTimeoutMs;
+        frameNumberSlop = t.frameNumberSlop;
+        verboseLogging = t.verbose;
+        activeTuningVersion = pendingTuningVersion;
+
+        // First event number built with the new values
+        auto [hasData, nextEventNum] = getMinimumFrameNumber();
+        std::cout << "[" << threadName << "] Config v" << activeTuningVersion << " applied from event number ";
+        if (hasData) {
+            std::cout << nextEventNum;
+        } else if (anyFrameBuilt) {
+            std::cout << "after " << lastBuiltEventNum;
+        } else {
+            std::cout << "of the first frame";
+        }
+        std::string changed = changes.str();
+        std::cout << ":" << (changed.empty() ? " no changes" : changed) << std::endl;
+    }
+
+    /**
+     * Match every ROC bank of a written frame against the ingest fingerprints
+     *
+     * The stream comes from the AIS entry and the ingest event number from the
+     * record's event number less the stream's correction factor.
+     */
+    template <typename Order>
+    void auditWrittenFrame(const std::vector<uint8_t>& frameData) {
+        evio6::BasicRecordView<Order> record(frameData.data(), frameData.size());
+        if (!record.valid()) return;  // Unmatched slices show up as losses
+
+        auto bank = evio6::aggregatedBank(record);
+        auto sib = bank.streamInfo();
+        if (!bank.valid() || !sib.valid() || !sib.timeSlice().valid()) return;
+        auto ais = sib.aggregationInfo();
+        if (!ais.valid()) return;
+
+        const uint64_t eventNum = record.userRegister1();
+        size_t i = 0;
+        for (auto rocBank : bank.rocBanks()) {
+            if (i >= ais.rocCount()) break;
+            uint16_t streamId = ais.rocId(i++);
+            uint64_t ingestEventNum = eventNum - static_cast<uint64_t>(getCorrection(streamId));
+            auditor->recordWritten(streamId, SliceAuditor::fingerprint(streamId, ingestEventNum,
+                                                                       rocBank.data(), rocBank.sizeBytes()));
+        }
+    }
+
+    /**
+     * Correction factor of a stream (0 before startup, for new streams, or when
+     * aligning on payload frame numbers)
+     */
+    int64_t getCorrection(uint16_t streamId) {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        auto it = streamEventNumCorrections.find(streamId);
+        return it != streamEventNumCorrections.end() ? it->second : 0;
+    }
+
+    /**
+     * Record the current stage for the watchdog
+     */
+    void setStage(BuilderStage next) {
+        stage.store(static_cast<int>(next), std::memory_order_relaxed);
+        stageSinceMs.store(steadyNowMs(), std::memory_order_relaxed);
+    }
+
+    /**
+     * Record whether the thread has input to work on; work after idling restarts the stall clock
+     */
+    void setIdle(bool nowIdle) {
+        if (idle.load(std::memory_order_relaxed) && !nowIdle) {
+            activitySinceMs.store(steadyNowMs(), std::memory_order_relaxed);
+        }
+        idle.store(nowIdle, std::memory_order_relaxed);
+    }
+
     /**
      * Get corrected event number for a stream
      *
@@ -869,10 +1922,10 @@ public:
      * @param rawEventNum  Raw event number from reassembler
      * @return Corrected event number
      */
-    uint32_t getCorrectedEventNum(uint16_t streamId, uint32_t rawEventNum) {
+    uint64_t getCorrectedEventNum(uint16_t streamId, uint64_t rawEventNum) {
         auto it = streamEventNumCorrections.find(streamId);
         if (it != streamEventNumCorrections.end()) {
-            return rawEventNum + it->second;
+            return rawEventNum + static_cast<uint64_t>(it->second);
         }
         // New stream not seen at startup - no correction
         return rawEventNum;
@@ -893,13 +1946,14 @@ public:
             std::unique_lock<std::mutex> lock(frameMutex);
 
             // Wait for data to arrive or check periodically
-            frameCV.wait_for(lock, std::chrono::milliseconds(frameTimeoutMs / 2),
+            setStage(BuilderStage::WAITING);
+            frameCV.wait_for(lock, std::chrono::milliseconds(std::max(1, frameTimeoutMs / 2)),
                 [this]() {
-                    // Wake up if any stream has data OR we're stopping
+                    // Wake up if any stream has data, new parameters were posted, OR we're stopping
                     for (const auto& [streamId, fifo] : streamFIFOs) {
                         if (!fifo.empty()) return true;
                     }
-                    return !running;
+                    return pendingTuningVersion != activeTuningVersion || !running;
                 });
 
             // Exit immediately if stopped
@@ -907,6 +1961,10 @@ public:
                 break;
             }
 
+            // Runtime parameter changes take effect between frames
+            setStage(BuilderStage::ALIGNING);
+            applyPendingTuning();
+
             // ================================================================
             // STARTUP: COMPUTE CORRECTION FACTORS (ONCE)
             // ================================================================
@@ -916,6 +1974,7 @@ public:
                 computeInitialCorrections();
                 if (!correctionFactorsInitialized) {
                     // Still waiting for all streams to send first frame
+                    setIdle(true);
                     continue;
                 }
             }
@@ -929,8 +1988,10 @@ public:
 
             if (!hasData) {
                 // No data available, wait for more
+                setIdle(true);
                 continue;
             }
+            setIdle(false);
 
             // Step 2: Check alignment - which streams have this minimum corrected event number?
             auto [allAligned, streamsWithMinFrame] = checkAlignment(minCorrectedEventNum);
@@ -974,18 +2035,22 @@ public:
             for (uint16_t streamId : streamsWithMinFrame) {
                 auto& fifo = streamFIFOs[streamId];
                 if (!fifo.empty()) {
-                    uint32_t rawEventNum = fifo.front().frameNumber;
-                    uint32_t correctedEventNum = getCorrectedEventNum(streamId, rawEventNum);
+                    uint64_t rawEventNum = fifo.front().frameNumber;
+                    uint64_t correctedEventNum = getCorrectedEventNum(streamId, rawEventNum);
 
                     if (correctedEventNum == minCorrectedEventNum) {
                         // Pop slice from this stream's FIFO
                         TimeSlice slice = std::move(fifo.front());
                         fifo.pop();
+                        queuedSlices.fetch_sub(1, std::memory_order_relaxed);
                         aggregatedFrame.addSlice(std::move(slice));
                     }
                 }
             }
 
+            lastBuiltEventNum = minCorrectedEventNum;
+            anyFrameBuilt = true;
+
             // Clean up timeout tracking for this corrected event number if all streams consumed it
             if (allAligned) {
                 frameArrivalTimes.erase(minCorrectedEventNum);
@@ -1018,10 +2083,26 @@ public:
             }
 
             // Step 6: Build EVIO-6 frame
+            setStage(BuilderStage::BUILDING);
             std::vector<uint8_t> builtFrame;
             if (buildEVIO6Frame(aggregatedFrame, builtFrame)) {
                 bool success = true;
 
+                // Routing rules; matching frames are shared with the routes, not copied
+                bool diverted = false;
+                matchedRoutes.clear();
+                for (RouteSink* route : routes) {
+                    if (route->matches(aggregatedFrame, expectedStreamCount)) {
+                        matchedRoutes.push_back(route);
+                        diverted = diverted || route->isDivert();
+                    }
+                }
+                SharedFrame sharedFrame;
+                if (!matchedRoutes.empty()) {
+                    sharedFrame = std::make_shared<const std::vector<uint8_t>>(std::move(builtFrame));
+                }
+                const std::vector<uint8_t>& frameData = sharedFrame ? *sharedFrame : builtFrame;
+
                 // Check if we should stop before ET/file operations
                 if (!running) {
                     lock.lock();
@@ -1029,8 +2110,8 @@ public:
                 }
 
                 // Send to ET if enabled
-                if (useET && running) {
-                    success = sendToET(builtFrame) && success;
+                if (useET && running && !diverted) {
+                    success = sendToET(frameData) && success;
 
                     // Check again after potentially blocking ET call
                     if (!running) {
@@ -1040,12 +2121,44 @@ public:
                 }
 
                 // Write to file if enabled
-                if (useFileOutput && running) {
-                    success = writeToFile(builtFrame) && success;
+                if (useFileOutput && running && !diverted) {
+                    success = writeToFile(frameData) && success;
+                }
+
+                // Queue for the matching routes, whether or not the main output
+                // succeeded; a diverted frame is output if any route took it
+                bool routed = false;
+                for (RouteSink* route : matchedRoutes) {
+                    routed = route->submit(sharedFrame) || routed;
+                }
+                if (diverted) {
+                    success = routed;
                 }
 
                 if (success) {
                     framesBuilt++;
+                    framesOutput.fetch_add(1, std::memory_order_relaxed);
+                    lastOutputEventNum.store(aggregatedFrame.frameNumber, std::memory_order_relaxed);
+                    activitySinceMs.store(steadyNowMs(), std::memory_order_relaxed);
+
+                    // Account for the ROC banks exactly as the sinks received them
+                    if (auditor != nullptr) {
+                        if (littleEndianOutput) {
+                            auditWrittenFrame<evio6::LittleEndian>(frameData);
+                        } else {
+                            auditWrittenFrame<evio6::BigEndian>(frameData);
+                        }
+                    }
+
+                    // Hand every 1/fraction-th frame to the validator (moved or shared, not copied)
+                    if (validator != nullptr) {
+                        sampleCredit += validator->getFraction();
+                        if (sampleCredit >= 1.0) {
+                            sampleCredit -= 1.0;
+                            validator->submit(sharedFrame ? sharedFrame :
+                                std::make_shared<const std::vector<uint8_t>>(std::move(builtFrame)));
+                        }
+                    }
                 }
             }
 
@@ -1054,6 +2167,7 @@ public:
         }
 
         std::cout << "[" << threadName << "] Builder thread stopped" << std::endl;
+        finished = true;
     }
 
     /**
@@ -1081,9 +2195,9 @@ public:
     /**
      * Wait for the thread to finish (with timeout and detach fallback)
      */
-    void waitForStop() {
+    bool waitForStop() {
         if (!thread.joinable()) {
-            return;
+            return finished;
         }
 
         // Give thread up to 1 second to finish current operation and exit
@@ -1092,18 +2206,31 @@ public:
         const int max_wait_ms = 1000;
 
         while (true) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (finished) {
+                thread.join();
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::steady_clock::now() - start);
 
             if (elapsed.count() > max_wait_ms) {
                 // Timeout - detach and let OS clean up
                 thread.detach();
-                return;
+                return false;
             }
         }
     }
 
+    /**
+     * Release the slices still queued (call only after the thread was joined)
+     */
+    void releaseQueuedSlices() {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        streamFIFOs.clear();
+        queuedSlices = 0;
+    }
+
     /**
      * Stop the builder thread (calls both signal and wait)
      */
@@ -1121,10 +2248,68 @@ public:
         slices = slicesProcessed;
         errors = buildErrors;
         fnErrors = frameNumberErrors;
-        files = filesCreated;
+        files = outputFile ? outputFile->filesCreated() : 0;
         bytes = bytesWritten;
     }
 
+    /**
+     * Milliseconds this thread has had work without outputting a frame (0 while idle)
+     */
+    int64_t busyMs(int64_t now) const {
+        if (idle.load(std::memory_order_relaxed)) return 0;
+        return now - activitySinceMs.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Watchdog diagnostics: stage, queue depths and last output event
+     *
+     * The FIFO lock is only tried, so a thread stuck while holding it cannot
+     * block the watchdog as well.
+     */
+    void dumpDiagnostics(std::ostream& out, int64_t now) {
+        BuilderStage current = static_cast<BuilderStage>(stage.load(std::memory_order_relaxed));
+        out << "[Watchdog]   " << threadName << ": stage '" << builderStageName(current) << "' for "
+            << (now - stageSinceMs.load(std::memory_order_relaxed)) << " ms, "
+            << framesOutput.load(std::memory_order_relaxed) << " frames output, last event number "
+            << lastOutputEventNum.load(std::memory_order_relaxed) << std::endl;
+
+        out << "[Watchdog]   " << threadName << ": queue depths:";
+        std::unique_lock<std::mutex> lock(frameMutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            out << " unavailable (FIFO lock held)" << std::endl;
+            return;
+        }
+        size_t total = 0;
+        for (const auto& [streamId, fifo] : streamFIFOs) {
+            out << " stream " << streamId << "=" << fifo.size();
+            total += fifo.size();
+        }
+        out << " (total " << total << ")" << std::endl;
+    }
+
+    /**
+     * Ask the thread to print its own backtrace to stderr (glibc only)
+     */
+    bool requestBacktrace() {
+#if defined(__GLIBC__)
+        if (!thread.joinable()) return false;
+        return pthread_kill(thread.native_handle(), SIGUSR2) == 0;
+#else
+        return false;
+#endif
+    }
+
+    const std::string& getName() const { return threadName; }
+
+    /**
+     * Per-stream key mismatch counts (read after the thread has stopped)
+     */
+    void getKeyMismatches(std::map<uint16_t, uint64_t>& mismatches) const {
+        for (const auto& [streamId, check] : keyCrossChecks) {
+            mismatches[streamId] += check.mismatches;
+        }
+    }
+
     bool isRunning() const { return running; }
 };
 
@@ -1141,7 +2326,16 @@ FrameBuilder::FrameBuilder(const std::string& etFile,
              int fnSlop,
              int timeout,
              int numExpectedStreams,
-             bool verboseMode)
+             bool verboseMode,
+             bool littleEndianOutput,
+             bool alignOnPayloadFrame,
+             double validateFrameFraction,
+             size_t auditWindowSlices,
+             int stallThreshold,
+             const std::vector<FrameRoute>& routes,
+             const FileRollover& rollover,
+             const OverloadBypass& overload,
+             std::shared_ptr<BufferReclaimer> payloadReclaimer)
     : etSystemFile(etFile)
     , etHostName(etHost)
     , etPort(etPort)
@@ -1150,11 +2344,20 @@ FrameBuilder::FrameBuilder(const std::string& etFile,
     , enableFileOutput(!fileDir.empty())
     , fileOutputDir(fileDir)
     , fileOutputPrefix(filePrefix)
+    , fileRollover(rollover)
+    , routeRules(routes)
+    , overloadBypass(overload)
+    , reclaimer(payloadReclaimer ? std::move(payloadReclaimer) : std::make_shared<BufferReclaimer>())
     , builderThreadCount(numBuilderThreads)
     , frameNumberSlop(fnSlop)
     , frameTimeoutMs(timeout)
     , expectedStreams(numExpectedStreams)
     , verbose(verboseMode)
+    , littleEndian(littleEndianOutput)
+    , alignPayloadFrame(alignOnPayloadFrame)
+    , validateFraction(validateFrameFraction)
+    , auditWindow(auditWindowSlices)
+    , stallThresholdMs(stallThreshold)
 {
     etSystem = nullptr;
 
@@ -1170,8 +2373,71 @@ FrameBuilder::FrameBuilder(const std::string& etFile,
         std::cout << " (dir: " << fileOutputDir << ", prefix: " << fileOutputPrefix << ")";
     }
     std::cout << std::endl;
+    if (enableFileOutput || !routeRules.empty()) {
+        std::cout << "  File rollover:";
+        if (fileRollover.maxBytes > 0) std::cout << " " << (fileRollover.maxBytes / (1024*1024)) << " MB";
+        if (fileRollover.maxSeconds > 0) std::cout << " " << fileRollover.maxSeconds << " s";
+        if (fileRollover.maxFrames > 0) std::cout << " " << fileRollover.maxFrames << " frames";
+        if (fileRollover.maxBytes == 0 && fileRollover.maxSeconds == 0 && fileRollover.maxFrames == 0) {
+            std::cout << " never";
+        }
+        std::cout << std::endl;
+    }
     std::cout << "  Expected streams: " << expectedStreams << std::endl;
     std::cout << "  Frame timeout: " << frameTimeoutMs << " ms" << std::endl;
+    std::cout << "  Byte order: " << (littleEndian ? "little-endian" : "big-endian") << std::endl;
+    std::cout << "  Alignment key: " << (alignPayloadFrame ? "payload frame number" : "event number")
+              << std::endl;
+    if (stallThresholdMs > 0) {
+        std::cout << "  Stall watchdog: " << stallThresholdMs << " ms" << std::endl;
+    }
+    if (auditWindow > 0) {
+        std::cout << "  Slice audit: window " << auditWindow << " slices per stream" << std::endl;
+    }
+    if (validateFraction > 0.0) {
+        std::cout << "  Sampled validation: " << (validateFraction * 100.0) << "% of built frames" << std::endl;
+    }
+    for (size_t i = 0; i < routeRules.size(); i++) {
+        std::cout << "  Route " << i << ": " << routeRules[i].spec << std::endl;
+    }
+
+    if (overloadBypass.enterSlices > 0) {
+        if (overloadBypass.resumeSlices == 0) {
+            overloadBypass.resumeSlices = overloadBypass.enterSlices / 2;
+        }
+        if (overloadBypass.dir.empty()) {
+            overloadBypass.dir = fileOutputDir;
+        }
+        std::cout << "  Overload passthrough: at " << overloadBypass.enterSlices << " queued slices per thread"
+                  << " (resume at " << overloadBypass.resumeSlices << "), capture dir: "
+                  << overloadBypass.dir << std::endl;
+    }
+    if (reclaimer->isEnabled()) {
+        std::cout << "  Payload release: deferred from " << (reclaimer->getMinBytes() / 1024) << " KB" << std::endl;
+    }
+
+    if (validateFraction < 0.0 || validateFraction > 1.0) {
+        std::cerr << "ERROR: Validation sampling fraction must be between 0 and 1" << std::endl;
+        throw std::invalid_argument("Invalid validation sampling fraction");
+    }
+
+    for (const auto& route : routeRules) {
+        if (route.sink == FrameRoute::Sink::ET && !enableET) {
+            std::cerr << "ERROR: Route '" << route.spec << "' sends to ET, but ET output is disabled" << std::endl;
+            throw std::invalid_argument("ET route without ET output");
+        }
+    }
+
+    if (overloadBypass.enterSlices > 0) {
+        if (overloadBypass.dir.empty()) {
+            std::cerr << "ERROR: Overload passthrough needs a capture directory (or file output)" << std::endl;
+            throw std::invalid_argument("Overload passthrough without capture directory");
+        }
+        if (overloadBypass.resumeSlices >= overloadBypass.enterSlices) {
+            std::cerr << "ERROR: Overload resume backlog must be below the passthrough backlog" << std::endl;
+            throw std::invalid_argument("Invalid overload resume backlog");
+        }
+    }
 
     // Validate that at least one output is enabled
     if (!enableET && !enableFileOutput) {
@@ -1290,8 +2556,28 @@ bool FrameBuilder::initializeET() {
         std::cout << "Created ET attachment " << i << " to GRAND_CENTRAL" << std::endl;
     }
 
+    // One more attachment per ET route, used by the route's own thread
+    for (const auto& route : routeRules) {
+        if (route.sink != FrameRoute::Sink::ET) continue;
+        et_att_id attachment;
+        status = et_station_attach(etSystem, 0, &attachment);
+        if (status != ET_OK) {
+            std::cerr << "Failed to attach to GRAND_CENTRAL (route '" << route.spec << "'): "
+                      << status << std::endl;
+            for (auto att : etAttachments) {
+                et_station_detach(etSystem, att);
+            }
+            for (auto att : routeAttachments) {
+                et_station_detach(etSystem, att);
+            }
+            et_close(etSystem);
+            return false;
+        }
+        routeAttachments.push_back(attachment);
+    }
+
     std::cout << "Successfully attached to GRAND_CENTRAL station with "
-              << builderThreadCount << " attachments" << std::endl;
+              << (etAttachments.size() + routeAttachments.size()) << " attachments" << std::endl;
     return true;
 }
 
@@ -1306,21 +2592,83 @@ bool FrameBuilder::initializeET() {
  * Each builder thread maintains separate FIFO queues for each stream.
  * Slices are enqueued to their stream's FIFO and processed by the alignment algorithm.
  */
-void FrameBuilder::addTimeSlice(uint64_t timestamp, uint32_t frameNumber, uint16_t dataId,
+void FrameBuilder::addTimeSlice(uint64_t timestamp, uint64_t frameNumber, uint16_t dataId,
                   uint8_t* data, size_t dataLen) {
 
+    // The ROC's own frame number (payload word 14), for alignment or cross-checking
+    evio6::RocFrameView roc(data, dataLen);
+    const bool hasPayloadFrame = roc.hasMetadata();
+    const uint32_t payloadFrameNumber = hasPayloadFrame ? roc.frameNumber() : 0;
+
+    uint64_t key = frameNumber;
+    if (alignPayloadFrame && hasPayloadFrame) {
+        key = extendPayloadFrameNumber(payloadFrameNumber);
+    }
+
     // Hash frame number to determine which builder thread handles this frame
     // CRITICAL: Use frame number (not timestamp) so all slices of same frame go to same thread
-    int threadIndex = static_cast<int>(frameNumber % builderThreadCount);
+    int threadIndex = static_cast<int>(key % builderThreadCount);
+
+    // Overload: the slice skips alignment and is kept as a raw frame instead
+    // (not audited: it never reaches a built frame)
+    if (overloadCapture &&
+        builderThreads[threadIndex]->shouldBypass(overloadBypass.enterSlices, overloadBypass.resumeSlices)) {
+        overloadCapture->write(data, dataLen);
+        reclaimer->retire(data, dataLen);
+        return;
+    }
+
+    // Fingerprint the ROC data the frame will carry, under the output event number
+    if (auditor) {
+        auditor->recordIngested(dataId, roc.hasHeader() ?
+            SliceAuditor::fingerprint(dataId, key, roc.rocData(), roc.rocBytes()) :
+            SliceAuditor::fingerprint(dataId, key, data, dataLen));
+    }
+
+    if (alignPayloadFrame && !hasPayloadFrame) {
+        std::cerr << "ERROR: Stream " << dataId << " event " << frameNumber
+                  << " has no payload frame number, slice dropped" << std::endl;
+        reclaimer->retire(data, dataLen);
+        slicesDropped++;
+        return;
+    }
 
     // Create time slice (transfers ownership of data buffer)
-    TimeSlice slice(timestamp, frameNumber, dataId, data, dataLen);
+    TimeSlice slice(timestamp, key, dataId, data, dataLen, reclaimer.get());
 
     // Send to appropriate builder thread's per-stream FIFO (move to avoid copy)
-    builderThreads[threadIndex]->addTimeSlice(std::move(slice));
+    builderThreads[threadIndex]->addTimeSlice(std::move(slice), hasPayloadFrame,
+                                              static_cast<uint32_t>(frameNumber) - payloadFrameNumber);
     slicesAggregated++;
 }
 
+/**
+ * Extend a 32-bit payload frame number to a 64-bit alignment key
+ *
+ * The key is the one closest to the highest key seen so far (signed 32-bit
+ * distance), which is then raised with a lock-free maximum. Safe while the
+ * streams stay within 2^31 frames of each other.
+ */
+uint64_t FrameBuilder::extendPayloadFrameNumber(uint32_t payloadFrameNumber) {
+    uint64_t reference = payloadFrameReference.load(std::memory_order_relaxed);
+    if (reference == NO_PAYLOAD_FRAME &&
+        payloadFrameReference.compare_exchange_strong(reference, payloadFrameNumber)) {
+        return payloadFrameNumber;  // First slice of the run
+    }
+
+    int32_t distance = static_cast<int32_t>(payloadFrameNumber - static_cast<uint32_t>(reference));
+    int64_t extended = static_cast<int64_t>(reference) + distance;
+    if (extended < 0) {
+        return payloadFrameNumber;  // Before the first key of the run, nothing to extend
+    }
+
+    uint64_t key = static_cast<uint64_t>(extended);
+    while (key > reference &&
+           !payloadFrameReference.compare_exchange_weak(reference, key, std::memory_order_relaxed)) {
+    }
+    return key;
+}
+
 /**
  * Start all builder threads
  */
@@ -1359,7 +2707,41 @@ bool FrameBuilder::start() {
                   << ", prefix: " << fileOutputPrefix << ")" << std::endl;
     }
 
-    // Create and start builder threads
+    if (auditWindow > 0) {
+        auditor = std::make_unique<SliceAuditor>(auditWindow);
+    }
+
+    // Start the validator before the builders that feed it
+    if (validateFraction > 0.0) {
+        validator = std::make_unique<SampledValidator>(validateFraction, littleEndian);
+        validator->start();
+    }
+
+    // Routing destinations, also before the builders
+    std::vector<RouteSink*> routes;
+    size_t etRoute = 0;
+    for (size_t i = 0; i < routeRules.size(); i++) {
+        bool toET = routeRules[i].sink == FrameRoute::Sink::ET;
+        auto sink = std::make_unique<RouteSink>(routeRules[i], static_cast<int>(i), fileOutputPrefix, littleEndian,
+                                                fileRollover, etSystem, toET ? routeAttachments[etRoute++] : 0, etEventSize);
+        if (!sink->start()) {
+            return false;
+        }
+        routes.push_back(sink.get());
+        routeSinks.push_back(std::move(sink));
+    }
+
+    // Overload capture: opened on the first bypassed slice
+    if (overloadBypass.enterSlices > 0) {
+        overloadCapture = std::make_unique<OverloadCapture>(overloadBypass.dir, fileOutputPrefix,
+                                                            fileRollover.maxBytes);
+        if (!overloadCapture->start()) {
+            return false;
+        }
+    }
+
+    // Create and start builder threads (with the current runtime tuning)
+    std::lock_guard<std::mutex> tuningLock(tuningMutex);
     for (int i = 0; i < builderThreadCount; i++) {
         et_att_id attachment = enableET ? etAttachments[i] : 0;
 
@@ -1375,18 +2757,110 @@ bool FrameBuilder::start() {
             enableFileOutput,
             fileOutputDir,
             fileOutputPrefix,
+            fileRollover,
             expectedStreams,
-            verbose
+            verbose,
+            littleEndian,
+            alignPayloadFrame,
+            validator.get(),
+            auditor.get(),
+            routes,
+            reclaimer
         );
         builder->start();
         builderThreads.push_back(std::move(builder));
     }
 
     running = true;
+
+    if (stallThresholdMs > 0) {
+#if defined(__GLIBC__)
+        // Load the unwinder now; the first backtrace() call may allocate
+        void* frames[1];
+        backtrace(frames, 1);
+        signal(SIGUSR2, backtraceSignalHandler);
+#endif
+        watchdogRunning = true;
+        watchdogThread = std::thread(&FrameBuilder::watchdogFunc, this);
+    }
+
     std::cout << "Frame builder started successfully" << std::endl;
     return true;
 }
 
+/**
+ * Stall watchdog thread
+ *
+ * Checks every builder thread four times per threshold. A thread that has
+ * had input for longer than the threshold without outputting a frame starts
+ * a stall episode: its stage, queue depths and last event are printed,
+ * followed by its backtrace. The episode ends, and its duration is recorded,
+ * once the thread outputs a frame or runs out of input.
+ */
+void FrameBuilder::watchdogFunc() {
+    std::vector<int64_t> stallStartMs(builderThreads.size(), -1);  // -1 = not stalled
+    const auto period = std::chrono::milliseconds(std::max(1, stallThresholdMs / 4));
+
+    std::unique_lock<std::mutex> lock(watchdogMutex);
+    while (watchdogRunning) {
+        watchdogCV.wait_for(lock, period, [this]() { return !watchdogRunning; });
+        if (!watchdogRunning) break;
+
+        for (size_t i = 0; i < builderThreads.size(); i++) {
+            BuilderThread& builder = *builderThreads[i];
+            int64_t now = steadyNowMs();
+            int64_t busy = builder.busyMs(now);
+
+            if (stallStartMs[i] < 0 && busy > stallThresholdMs) {
+                // New episode, dated from the thread's last activity
+                stallStartMs[i] = now - busy;
+                stallEpisodes++;
+                stallsActive++;
+                std::cerr << "[Watchdog] STALL: " << builder.getName() << " has not output a frame for "
+                          << busy << " ms (threshold " << stallThresholdMs << " ms)" << std::endl;
+                builder.dumpDiagnostics(std::cerr, now);
+                std::cerr << "[Watchdog]   " << builder.getName() << ": backtrace:" << std::endl;
+                if (!builder.requestBacktrace()) {
+                    std::cerr << "[Watchdog]   (not available)" << std::endl;
+                }
+            } else if (stallStartMs[i] >= 0 && busy <= stallThresholdMs) {
+                uint64_t duration = static_cast<uint64_t>(now - stallStartMs[i]);
+                stallStartMs[i] = -1;
+                stallsActive--;
+                stallTotalMs += duration;
+                uint64_t longest = stallLongestMs;
+                while (duration > longest && !stallLongestMs.compare_exchange_weak(longest, duration)) {
+                }
+                std::cerr << "[Watchdog] " << builder.getName() << " recovered after "
+                          << duration << " ms" << std::endl;
+            }
+        }
+    }
+
+    // Episodes still open at shutdown count up to now
+    int64_t now = steadyNowMs();
+    for (int64_t start : stallStartMs) {
+        if (start >= 0) {
+            stallTotalMs += static_cast<uint64_t>(now - start);
+            stallsActive--;
+        }
+    }
+}
+
+/**
+ * Stop the watchdog (before the builder threads, so shutdown is not a stall)
+ */
+void FrameBuilder::stopWatchdog() {
+    {
+        std::lock_guard<std::mutex> lock(watchdogMutex);
+        watchdogRunning = false;
+    }
+    watchdogCV.notify_all();
+    if (watchdogThread.joinable()) {
+        watchdogThread.join();
+    }
+}
+
 /**
  * Stop all builder threads
  */
@@ -1394,19 +2868,40 @@ void FrameBuilder::stop() {
     std::cout << "Stopping frame builder..." << std::endl;
 
     running = false;
+    stopWatchdog();
 
     // First, signal all threads to stop (set their running flags)
     for (auto& builder : builderThreads) {
         builder->signalStop();
     }
 
-    // Then, wait for all threads to finish
+    // Then, wait for all threads to finish; the slices left in the FIFOs of
+    // joined threads go to the reclaimer now, before its owner stops it
+    // (a detached thread keeps its slices, and the reclaimer with them)
+    for (auto& builder : builderThreads) {
+        if (builder->waitForStop()) {
+            builder->releaseQueuedSlices();
+        }
+    }
+
+    // Finish the last files (trailers are written by the file helpers)
     for (auto& builder : builderThreads) {
-        builder->waitForStop();
+        builder->closeFile();
     }
 
     std::cout << "All builder threads finished" << std::endl;
 
+    // Check the samples still queued and write out the routed frames
+    if (validator) {
+        validator->stop();
+    }
+    for (auto& sink : routeSinks) {
+        sink->stop();
+    }
+    if (overloadCapture) {
+        overloadCapture->close();
+    }
+
     // Collect statistics from all threads
     framesBuilt = 0;
     buildErrors = 0;
@@ -1416,7 +2911,9 @@ void FrameBuilder::stop() {
 
     std::cout << "Collecting statistics..." << std::endl;
 
+    keyMismatches.clear();
     for (auto& builder : builderThreads) {
+        builder->getKeyMismatches(keyMismatches);
         uint64_t built, slices, errors, fnErrors, files, bytes;
         builder->getStats(built, slices, errors, fnErrors, files, bytes);
         framesBuilt += built;
@@ -1441,6 +2938,10 @@ void FrameBuilder::stop() {
             et_station_detach(etSystem, attachment);
         }
         etAttachments.clear();
+        for (auto attachment : routeAttachments) {
+            et_station_detach(etSystem, attachment);
+        }
+        routeAttachments.clear();
 
         et_close(etSystem);
         etSystem = nullptr;
@@ -1460,6 +2961,46 @@ void FrameBuilder::printStatistics() const {
     std::cout << "  Slices Aggregated: " << slicesAggregated << std::endl;
     std::cout << "  Build Errors: " << buildErrors << std::endl;
     std::cout << "  Frame Number Errors: " << frameNumberErrors << std::endl;
+    if (slicesDropped > 0) {
+        std::cout << "  Slices Dropped (no payload frame number): " << slicesDropped << std::endl;
+    }
+    if (validator) {
+        validator->printStatistics();
+    }
+    if (auditor) {
+        auditor->printStatistics(!running);
+    }
+    if (stallThresholdMs > 0) {
+        std::cout << "  Stall Episodes: " << stallEpisodes << " (total " << stallTotalMs
+                  << " ms, longest " << stallLongestMs << " ms)" << std::endl;
+    }
+    for (const auto& sink : routeSinks) {
+        FrameRouteStats r;
+        sink->getStats(r);
+        std::cout << "  Route '" << r.spec << "': matched " << r.matched << ", written " << r.written
+                  << ", dropped " << r.dropped << ", errors " << r.errors << ", " << r.bytes << " bytes"
+                  << std::endl;
+    }
+    if (overloadCapture) {
+        uint64_t slices, bytes, errors, files;
+        overloadCapture->getStats(slices, bytes, errors, files);
+        uint64_t episodes = 0;
+        for (const auto& builder : builderThreads) {
+            episodes += builder->getBypassEpisodes();
+        }
+        std::cout << "  Overload Passthrough: " << slices << " slices, " << bytes << " bytes in "
+                  << episodes << " episodes (" << files << " capture files, " << errors << " write errors)"
+                  << std::endl;
+    }
+    std::cout << "  Alignment Key: " << (alignPayloadFrame ? "payload frame number" : "event number")
+              << std::endl;
+    if (!keyMismatches.empty()) {
+        std::cout << "  Event/Payload Frame Number Mismatches:";
+        for (const auto& [streamId, count] : keyMismatches) {
+            std::cout << " stream " << streamId << "=" << count;
+        }
+        std::cout << std::endl;
+    }
     if (slicesAggregated > 0 && framesBuilt > 0) {
         std::cout << "  Avg Slices/Frame: "
                   << (static_cast<double>(slicesAggregated) / framesBuilt)
@@ -1501,4 +3042,98 @@ void FrameBuilder::getStatistics(uint64_t& built, uint64_t& slices, uint64_t& er
     slices += slicesAggregated.load();
 }
 
+/**
+ * Get overload passthrough statistics
+ */
+void FrameBuilder::getOverloadStatistics(uint64_t& slices, uint64_t& bytes, uint64_t& episodes, int& active) const {
+    slices = bytes = episodes = 0;
+    active = 0;
+    if (!overloadCapture) return;
+    uint64_t errors, files;
+    overloadCapture->getStats(slices, bytes, errors, files);
+    for (const auto& builder : builderThreads) {
+        episodes += builder->getBypassEpisodes();
+        active += builder->isBypassing() ? 1 : 0;
+    }
+}
+
+/**
+ * Get per-rule routing statistics
+ */
+void FrameBuilder::getRouteStatistics(std::vector<FrameRouteStats>& stats) const {
+    stats.resize(routeSinks.size());
+    for (size_t i = 0; i < routeSinks.size(); i++) {
+        routeSinks[i]->getStats(stats[i]);
+    }
+}
+
+/**
+ * Get sampled validation statistics
+ */
+void FrameBuilder::getValidationStatistics(uint64_t& sampled, uint64_t& failed, uint64_t& skipped) const {
+    sampled = failed = skipped = 0;
+    if (validator) {
+        validator->getStats(sampled, failed, skipped);
+    }
+}
+
+/**
+ * Get stall watchdog statistics
+ */
+void FrameBuilder::getStallStatistics(uint64_t& episodes, uint64_t& totalMs, int& active) const {
+    episodes = stallEpisodes;
+    totalMs = stallTotalMs;
+    active = stallsActive;
+}
+
+/**
+ * Get slice audit totals over all streams
+ */
+void FrameBuilder::getAuditStatistics(uint64_t& ingested, uint64_t& written, uint64_t& lost,
+                                      uint64_t& duplicates, uint64_t& late) const {
+    ingested = written = lost = duplicates = late = 0;
+    if (!auditor) return;
+
+    for (const auto& [streamId, t] : auditor->getTotals()) {
+        ingested += t.ingested;
+        written += t.written;
+        lost += t.lost;
+        duplicates += t.duplicates;
+        late += t.late;
+    }
+}
+
+/**
+ * Change runtime-tunable parameters on every builder thread
+ *
+ * The new values are posted to each thread under its frame mutex; the thread
+ * switches to all of them together before building its next frame.
+ */
+uint64_t FrameBuilder::updateTuning(const BuilderTuning& tuning) {
+    if (tuning.frameTimeoutMs < 1 || tuning.frameNumberSlop < 0) {
+        std::cerr << "ERROR: Invalid builder parameters (frame-timeout " << tuning.frameTimeoutMs
+                  << " ms, framenumber-slop " << tuning.frameNumberSlop << ")" << std::endl;
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(tuningMutex);
+    frameNumberSlop = tuning.frameNumberSlop;
+    frameTimeoutMs = tuning.frameTimeoutMs;
+    verbose = tuning.verbose;
+    tuningVersion++;
+
+    for (auto& builder : builderThreads) {
+        builder->postTuning(tuning, tuningVersion);
+    }
+    return tuningVersion;
+}
+
+/**
+ * Current runtime-tunable parameters
+ */
+BuilderTuning FrameBuilder::getTuning() const {
+    std::lock_guard<std::mutex> lock(tuningMutex);
+    return {frameNumberSlop, frameTimeoutMs, verbose};
+}
+
 } // namespace e2sar
@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <map>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -19,12 +20,105 @@
 #include <memory>
 #include <et.h>
 
+#include "buffer_reclaimer.hpp"
+
 namespace e2sar {
 
 // Forward declarations
 struct TimeSlice;
 struct AggregatedFrame;
 class BuilderThread;
+class SampledValidator;
+class SliceAuditor;
+class RouteSink;
+class OverloadCapture;
+
+/**
+ * Builder parameters that can be changed while the builder runs
+ */
+struct BuilderTuning {
+    int frameNumberSlop;   // Max allowed frame number difference for validation (after correction)
+    int frameTimeoutMs;    // How long to wait for all expected streams before partial build
+    bool verbose;          // Verbose logging of frame building progress
+};
+
+/**
+ * When an output file rolls over to the next one (0 = no limit of that kind)
+ */
+struct FileRollover {
+    uint64_t maxBytes{2ULL * 1024 * 1024 * 1024};  // File size (2GB)
+    int maxSeconds{0};                              // Time since the file was opened
+    uint64_t maxFrames{0};                          // Frames in the file
+};
+
+/**
+ * Overload passthrough (off while enterSlices is 0)
+ *
+ * A builder thread whose FIFOs hold enterSlices slices or more stops taking
+ * new slices: they bypass alignment and are written unaggregated, as raw
+ * ROC frames, to a capture that evio_raw_scan and evio_bulk_build read.
+ * Aggregation resumes once the backlog is down to resumeSlices.
+ */
+struct OverloadBypass {
+    size_t enterSlices{0};    // Slices queued in one builder thread that start the bypass
+    size_t resumeSlices{0};   // Backlog at which aggregation resumes (0 = enterSlices / 2)
+    std::string dir;          // Capture directory (empty = file output directory)
+};
+
+/**
+ * Routing rule for built frames
+ *
+ * Parsed from "MATCH DEST [divert] [queue=N]" by parseFrameRoute. A frame
+ * matches when all conditions in MATCH hold; matching frames are copied to
+ * DEST through the rule's own bounded queue and thread.
+ */
+struct FrameRoute {
+    enum class Sink { FILE, ET };
+
+    std::string spec;               // Rule as given, for reports
+
+    // Match conditions (all must hold)
+    bool partialOnly{false};        // Fewer slices than expected streams
+    bool completeOnly{false};       // A slice from every expected stream
+    uint64_t everyN{0};             // Frame (event) number % everyN == remainder (0 = any)
+    uint64_t remainder{0};
+    std::vector<uint16_t> rocs;     // Streams that must all be present
+
+    // Destination
+    Sink sink{Sink::FILE};
+    std::string fileDir;            // FILE: output directory
+    int etControl{0};               // ET: control word 0 of the events, for select-mode stations
+    bool divert{false};             // Matching frames skip the main ET/file output
+    size_t queueFrames{256};        // Frames queued before the route starts dropping
+};
+
+/**
+ * Counters of one routing rule
+ */
+struct FrameRouteStats {
+    std::string spec;
+    uint64_t matched;   // Frames that matched the rule
+    uint64_t written;   // Frames the destination accepted
+    uint64_t dropped;   // Frames dropped because the queue was full
+    uint64_t errors;    // File write or ET failures
+    uint64_t bytes;     // Bytes written to the destination
+    size_t queued;      // Frames waiting in the queue right now
+};
+
+/**
+ * Parse a routing rule
+ *
+ * MATCH is "all" or conditions joined by '&': "partial", "complete",
+ * "every=N" or "every=N+R" (frame number modulo N equals R), "rocs=A,B,..."
+ * (all listed streams present). DEST is "file:DIR" or "et:N" (events put
+ * into the builder's ET system with control word 0 = N).
+ *
+ * @param text  Rule text, e.g. "partial file:/data/diag divert"
+ * @param route Parsed rule
+ * @param error Reason, if the rule is malformed
+ * @return true if the rule was parsed
+ */
+bool parseFrameRoute(const std::string& text, FrameRoute& route, std::string& error);
 
 /**
  * Frame Builder - Multi-threaded aggregator and EVIO-6 builder
@@ -60,6 +154,27 @@ private:
     bool enableFileOutput;
     std::string fileOutputDir;
     std::string fileOutputPrefix;
+    FileRollover fileRollover;
+
+    // Background validation of sampled built frames (null if disabled); declared
+    // before the builder threads, which hold a pointer to it
+    std::unique_ptr<SampledValidator> validator;
+
+    // Input-to-output slice conservation audit (null if disabled); same as above
+    std::unique_ptr<SliceAuditor> auditor;
+
+    // Routing destinations, one per rule; same as above
+    std::vector<FrameRoute> routeRules;
+    std::vector<std::unique_ptr<RouteSink>> routeSinks;
+    std::vector<et_att_id> routeAttachments;
+
+    // Overload passthrough capture (null if disabled)
+    OverloadBypass overloadBypass;
+    std::unique_ptr<OverloadCapture> overloadCapture;
+
+    // Payload buffers are released through this (shared with the receive side);
+    // declared before the builder threads, whose slices hold a pointer to it
+    std::shared_ptr<BufferReclaimer> reclaimer;
 
     // Builder threads
     int builderThreadCount;
@@ -75,15 +190,47 @@ private:
     std::atomic<uint64_t> frameNumberErrors{0};
     std::atomic<uint64_t> filesCreated{0};
     std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> slicesDropped{0};
 
     // Configuration
     int frameNumberSlop;   // Max allowed frame number difference for validation (after correction)
     int frameTimeoutMs;    // How long to wait for all expected streams before partial build
     int expectedStreams;   // Number of expected data streams per frame number
     bool verbose;          // Enable verbose logging of frame building progress
+    bool littleEndian;     // Write EVIO-6 headers little-endian instead of big-endian
+    bool alignPayloadFrame;  // Align on the payload frame number instead of the event number
+
+    double validateFraction;  // Fraction of built frames validated in the background
+    size_t auditWindow;       // Slices per stream the auditor waits for before calling one lost
+
+    // Payload frame number alignment: highest 64-bit key so far, the reference
+    // for extending 32-bit payload frame numbers across wraps
+    static constexpr uint64_t NO_PAYLOAD_FRAME = UINT64_MAX;
+    std::atomic<uint64_t> payloadFrameReference{NO_PAYLOAD_FRAME};
+
+    // Per-stream event number / payload frame number mismatches (collected at stop)
+    std::map<uint16_t, uint64_t> keyMismatches;
+
+    // Runtime tuning (see updateTuning)
+    mutable std::mutex tuningMutex;
+    uint64_t tuningVersion{1};
+
+    // Stall watchdog: flags builder threads busy without finishing a frame
+    int stallThresholdMs;  // 0 = no watchdog
+    std::thread watchdogThread;
+    std::mutex watchdogMutex;
+    std::condition_variable watchdogCV;
+    bool watchdogRunning{false};
+    std::atomic<uint64_t> stallEpisodes{0};
+    std::atomic<uint64_t> stallTotalMs{0};
+    std::atomic<uint64_t> stallLongestMs{0};
+    std::atomic<int> stallsActive{0};
 
     // Private methods
     bool initializeET();
+    void watchdogFunc();
+    void stopWatchdog();
+    uint64_t extendPayloadFrameNumber(uint32_t payloadFrameNumber);
 
 public:
     /**
@@ -106,6 +253,34 @@ public:
      *                streams before building a partial frame (default: 1000)
      * @param expectedStreams Number of expected data streams per frame number
      * @param verbose Enable verbose logging of frame building progress (default: false)
+     * @param littleEndianOutput Write file, record and frame headers little-endian, with
+     *               record bit info bit 31 cleared (default: false, big-endian). ROC banks
+     *               are copied verbatim either way.
+     * @param alignOnPayloadFrame Align streams on the ROC frame number in the payload
+     *               (word 14, extended to 64 bits) instead of the reassembler event number.
+     *               No startup correction factors are computed, so building starts without
+     *               waiting for every stream. The event number is kept as a cross-check
+     *               (default: false)
+     * @param validateFraction Fraction (0..1) of built frames handed to a low-priority
+     *               background thread for full EVIO-6 structure validation (default: 0, off)
+     * @param auditWindowSlices Audit slice conservation: fingerprint every slice at ingest
+     *               and match it against the ROC banks of written frames. A slice not written
+     *               within this many later slices of its stream is counted lost (default: 0, off)
+     * @param stallThreshold Watchdog threshold in milliseconds: a builder thread busy this
+     *               long without finishing a frame is reported with its stage, queue depths,
+     *               last event and a backtrace; episodes are counted and timed (default: 0, off)
+     * @param routes Routing rules evaluated on every built frame; each rule has its own
+     *               destination, bounded queue and thread (default: none). ET destinations
+     *               need ET output enabled.
+     * @param rollover When output files (main and routes) roll over: size, age and/or frame
+     *               count (default: 2GB). The next file is prepared and the finished one gets
+     *               its trailer index in the background.
+     * @param overload Overload passthrough: backlog per builder thread past which new slices
+     *               are written unaggregated to a raw capture, and the backlog at which
+     *               aggregation resumes (default: off)
+     * @param payloadReclaimer Releases the payload buffers of finished or dropped slices off
+     *               the builder threads, in batches (default: null, a reclaimer of our own
+     *               deferring buffers of 128 KB and up)
      *
      * Note: At least one output mode (ET or file) must be enabled.
      *       - To enable ET output: provide valid etFile and stationName
@@ -122,7 +297,16 @@ public:
                  int fnSlop = 0,
                  int timeout = 1000,
                  int expectedStreams = 1,
-                 bool verbose = false);
+                 bool verbose = false,
+                 bool littleEndianOutput = false,
+                 bool alignOnPayloadFrame = false,
+                 double validateFraction = 0.0,
+                 size_t auditWindowSlices = 0,
+                 int stallThreshold = 0,
+                 const std::vector<FrameRoute>& routes = {},
+                 const FileRollover& rollover = FileRollover(),
+                 const OverloadBypass& overload = OverloadBypass(),
+                 std::shared_ptr<BufferReclaimer> payloadReclaimer = nullptr);
 
     /**
      * Destructor
@@ -139,12 +323,13 @@ public:
      * The caller must NOT delete the buffer after calling this function.
      *
      * @param timestamp Frame timestamp (used for aggregation and distribution)
-     * @param frameNumber Frame number
+     * @param frameNumber Event number (64-bit; aggregation key and thread shard, or
+     *                    cross-check only when aligning on the payload frame number)
      * @param dataId Data source identifier (ROC ID, stream ID)
      * @param data Pointer to reassembled payload data (ownership transferred)
      * @param dataLen Length of payload data in bytes
      */
-    void addTimeSlice(uint64_t timestamp, uint32_t frameNumber, uint16_t dataId,
+    void addTimeSlice(uint64_t timestamp, uint64_t frameNumber, uint16_t dataId,
                       uint8_t* data, size_t dataLen);
 
     /**
@@ -180,6 +365,70 @@ public:
      */
     void getStatistics(uint64_t& built, uint64_t& slices, uint64_t& errors, uint64_t& bytes) const;
 
+    /**
+     * Get sampled validation statistics (all zero if validation is disabled)
+     *
+     * @param sampled Frames validated so far
+     * @param failed Validated frames that broke an EVIO-6 structure rule
+     * @param skipped Sampled frames dropped because the validator was behind
+     */
+    void getValidationStatistics(uint64_t& sampled, uint64_t& failed, uint64_t& skipped) const;
+
+    /**
+     * Get slice audit totals over all streams (all zero if the audit is disabled)
+     *
+     * @param ingested Slices fingerprinted at ingest
+     * @param written Slices found exactly once in written frames
+     * @param lost Slices not written within the audit window (late arrivals taken back out)
+     * @param duplicates Slices written more than once
+     * @param late Slices written after they had been counted lost
+     */
+    void getAuditStatistics(uint64_t& ingested, uint64_t& written, uint64_t& lost,
+                            uint64_t& duplicates, uint64_t& late) const;
+
+    /**
+     * Get stall watchdog statistics (all zero if the watchdog is disabled)
+     *
+     * @param episodes Stall episodes detected so far
+     * @param totalMs Time spent stalled in finished episodes
+     * @param active Builder threads stalled right now
+     */
+    void getStallStatistics(uint64_t& episodes, uint64_t& totalMs, int& active) const;
+
+    /**
+     * Get overload passthrough statistics (all zero if the passthrough is disabled)
+     *
+     * @param slices Slices written unaggregated to the overload capture
+     * @param bytes Bytes written to the overload capture
+     * @param episodes Times a builder thread switched to passthrough
+     * @param active Builder threads in passthrough right now
+     */
+    void getOverloadStatistics(uint64_t& slices, uint64_t& bytes, uint64_t& episodes, int& active) const;
+
+    /**
+     * Get per-rule routing statistics (empty if no rules are configured)
+     *
+     * @param stats One entry per rule, in rule order
+     */
+    void getRouteStatistics(std::vector<FrameRouteStats>& stats) const;
+
+    /**
+     * Change the runtime-tunable parameters on every builder thread
+     *
+     * Thread-safe. Each builder thread switches to all new values at once,
+     * between two frames, and logs the event number from which they apply.
+     *
+     * @param tuning New parameters (frameTimeoutMs >= 1, frameNumberSlop >= 0)
+     * @return Version number of the new configuration (1 = startup values),
+     *         or 0 if the parameters are invalid
+     */
+    uint64_t updateTuning(const BuilderTuning& tuning);
+
+    /**
+     * Current runtime-tunable parameters
+     */
+    BuilderTuning getTuning() const;
+
     // Prevent copying
     FrameBuilder(const FrameBuilder&) = delete;
     FrameBuilder& operator=(const FrameBuilder&) = delete;
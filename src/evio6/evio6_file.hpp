@@ -0,0 +1,399 @@
+/**
+ * EVIO-6 File I/O for the Offline Tools
+ *
+ * MappedFile: read-only mmap of an EVIO-6 file for zero-copy access through
+ * the views in evio6_view.hpp (the kernel is told access is sequential, so
+ * readahead is large and consumed pages are dropped early).
+ *
+ * FileWriter: writes records into a set of rolled-over EVIO-6 files
+ * ({dir}/{prefix}_file{NNNN}.evio). Records are gathered into a large buffer
+ * and written with few, large sequential write() calls. Each finished file
+ * gets a trailer with a record index, and its file header is rewritten with
+ * the record count and trailer position.
+ *
+ * POSIX only, header-only, no dependencies beyond the standard library.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#ifndef CODA_FB_EVIO6_FILE_HPP
+#define CODA_FB_EVIO6_FILE_HPP
+
+#include "evio6_layout.hpp"
+#include "evio6_writer.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace evio6 {
+
+// ============================================================================
+// Memory-Mapped Input File
+// ============================================================================
+class MappedFile {
+private:
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept : base(other.base), length(other.length) {
+        other.base = nullptr;
+        other.length = 0;
+    }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            base = other.base;
+            length = other.length;
+            other.base = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * Map a whole file read-only
+     *
+     * @param sequential  Advise the kernel the file is read front to back
+     * @return false (with a message on stderr) if the file cannot be mapped
+     */
+    bool open(const std::string& path, bool sequential = true) {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "ERROR: Cannot open file: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            std::cerr << "ERROR: Cannot stat file: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+            ::close(fd);
+            return false;
+        }
+        if (st.st_size == 0) {
+            // Nothing to map; an empty file is a valid (empty) input
+            ::close(fd);
+            return true;
+        }
+
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            std::cerr << "ERROR: Cannot map file: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+            return false;
+        }
+        if (sequential) {
+            madvise(addr, st.st_size, MADV_SEQUENTIAL);
+        }
+
+        base = static_cast<const uint8_t*>(addr);
+        length = st.st_size;
+        return true;
+    }
+
+    void close() {
+        if (base != nullptr) {
+            munmap(const_cast<uint8_t*>(base), length);
+            base = nullptr;
+            length = 0;
+        }
+    }
+
+    const uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+};
+
+// ============================================================================
+// Rolled-Over Output File Set
+// ============================================================================
+class FileWriter {
+public:
+    static constexpr uint64_t DEFAULT_MAX_FILE_BYTES = 2ULL * 1024 * 1024 * 1024;  // 2GB, as coda-fb
+    static constexpr size_t DEFAULT_BUFFER_BYTES = 16 * 1024 * 1024;
+
+private:
+    std::string outputDir;
+    std::string outputPrefix;
+    uint64_t maxFileBytes;
+    bool writeTrailer;
+
+    std::vector<uint8_t> buffer;    // Pending bytes of the current file
+    size_t buffered = 0;
+
+    int fd = -1;
+    std::string path;
+    uint32_t fileNumber = 0;        // Next file number
+    uint64_t fileBytes = 0;         // Bytes in the current file, including buffered
+    uint32_t recordNumber = 1;      // Record numbers restart at 1 in every file
+    std::vector<uint32_t> index;    // Trailer index of the current file
+
+    uint64_t totalRecords = 0;
+    uint64_t totalBytes = 0;
+    uint32_t totalFiles = 0;
+
+    bool writeAll(const uint8_t* data, size_t bytes) {
+        while (bytes > 0) {
+            ssize_t n = ::write(fd, data, bytes);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "ERROR: Write failed on " << path << " (" << std::strerror(errno) << ")" << std::endl;
+                return false;
+            }
+            data += n;
+            bytes -= n;
+        }
+        return true;
+    }
+
+    bool flush() {
+        if (buffered == 0) return true;
+        bool ok = writeAll(buffer.data(), buffered);
+        buffered = 0;
+        return ok;
+    }
+
+    // Copy into the buffer, flushing when full; oversized blocks are written directly
+    bool append(const uint8_t* data, size_t bytes) {
+        if (buffered + bytes > buffer.size()) {
+            if (!flush()) return false;
+            if (bytes > buffer.size()) {
+                return writeAll(data, bytes);
+            }
+        }
+        std::memcpy(buffer.data() + buffered, data, bytes);
+        buffered += bytes;
+        return true;
+    }
+
+    bool openNext() {
+        std::ostringstream name;
+        name << outputDir << "/" << outputPrefix
+             << "_file" << std::setfill('0') << std::setw(4) << fileNumber << ".evio";
+        path = name.str();
+
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "ERROR: Failed to open output file: " << path
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            return false;
+        }
+
+        // Placeholder header, rewritten with the record count when the file is finished
+        uint8_t header[HEADER_BYTES];
+        encodeFileHeader(header, fileNumber);
+        fileNumber++;
+        totalFiles++;
+        fileBytes = 0;
+        recordNumber = 1;
+        index.clear();
+
+        if (!append(header, HEADER_BYTES)) return false;
+        fileBytes = HEADER_BYTES;
+        return true;
+    }
+
+    /**
+     * Flush, append the trailer (if enabled) and rewrite the file header
+     */
+    bool finishFile() {
+        if (fd < 0) return true;
+
+        bool ok = true;
+        uint64_t trailerPosition = 0;
+        uint32_t bitInfo = 0;
+
+        if (writeTrailer) {
+            trailerPosition = fileBytes;
+            bitInfo = BitInfo::TRAILER_WITH_INDEX;
+            size_t recordCount = index.size() / TRAILER_INDEX_WORDS_PER_RECORD;
+            std::vector<uint8_t> trailer(trailerBytes(recordCount));
+            encodeTrailer(trailer.data(), recordNumber, index.data(), recordCount);
+            ok = append(trailer.data(), trailer.size());
+            fileBytes += trailer.size();
+        }
+        ok = flush() && ok;
+
+        uint8_t header[HEADER_BYTES];
+        encodeFileHeader(header, fileNumber - 1, recordNumber - 1, trailerPosition, bitInfo);
+        if (ok && pwrite(fd, header, HEADER_BYTES, 0) != static_cast<ssize_t>(HEADER_BYTES)) {
+            std::cerr << "ERROR: Failed to rewrite file header of " << path
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            ok = false;
+        }
+
+        totalBytes += fileBytes;
+        if (::close(fd) != 0) ok = false;
+        fd = -1;
+        return ok;
+    }
+
+    // Roll over if needed and make sure a file is open for a record of 'bytes'
+    bool beginRecord(size_t bytes) {
+        if (fd >= 0 && fileBytes > HEADER_BYTES && fileBytes + bytes > maxFileBytes) {
+            if (!finishFile()) return false;
+        }
+        return fd >= 0 || openNext();
+    }
+
+    void endRecord(size_t bytes, uint32_t eventCount) {
+        if (writeTrailer) {
+            index.push_back(static_cast<uint32_t>(bytes));
+            index.push_back(eventCount);
+        }
+        recordNumber++;
+        fileBytes += bytes;
+        totalRecords++;
+    }
+
+public:
+    /**
+     * @param dir           Output directory (must exist)
+     * @param prefix        File name prefix ({prefix}_file{NNNN}.evio)
+     * @param maxFileBytes  Roll over to a new file before exceeding this size
+     * @param bufferBytes   Size of each sequential write
+     * @param trailer       Write a trailer with a record index to each file
+     */
+    FileWriter(const std::string& dir, const std::string& prefix,
+               uint64_t maxFileBytes = DEFAULT_MAX_FILE_BYTES,
+               size_t bufferBytes = DEFAULT_BUFFER_BYTES,
+               bool trailer = true)
+        : outputDir(dir)
+        , outputPrefix(prefix)
+        , maxFileBytes(maxFileBytes)
+        , writeTrailer(trailer)
+        , buffer(bufferBytes) {}
+
+    ~FileWriter() { close(); }
+
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    /**
+     * Append one complete record (header included); its record number is
+     * rewritten to its position in the output file
+     *
+     * @return false on I/O error
+     */
+    bool writeRecord(const uint8_t* record, size_t bytes, uint32_t eventCount) {
+        if (bytes < HEADER_BYTES) {
+            std::cerr << "ERROR: Record too small (" << bytes << " bytes)" << std::endl;
+            return false;
+        }
+        if (!beginRecord(bytes)) {
+            return false;
+        }
+
+        // Renumbered header (in the record's own byte order), then the record body
+        uint8_t header[HEADER_BYTES];
+        std::memcpy(header, record, HEADER_BYTES);
+        if (loadBE32(header + RecordWord::MAGIC * 4) == MAGIC_SWAPPED) {
+            LittleEndian::store(header + RecordWord::RECORD_NUMBER * 4, recordNumber);
+        } else {
+            BigEndian::store(header + RecordWord::RECORD_NUMBER * 4, recordNumber);
+        }
+        if (!append(header, HEADER_BYTES) || !append(record + HEADER_BYTES, bytes - HEADER_BYTES)) {
+            return false;
+        }
+
+        endRecord(bytes, eventCount);
+        return true;
+    }
+
+    /**
+     * Serialize an aggregated frame record straight into the write buffer
+     * (ROC banks are copied once, from their source to the buffer);
+     * info.recordNumber is replaced by the record's position in the file
+     *
+     * @return false on I/O error
+     */
+    bool writeAggregatedRecord(const FrameInfo& info, const SliceRef* slices, size_t count) {
+        const size_t payloadBytes = aggregatedPayloadBytes(slices, count);
+        const size_t bytes = HEADER_BYTES + aggregatedMetadataWords(count) * 4 + payloadBytes;
+        if (!beginRecord(bytes)) {
+            return false;
+        }
+
+        FrameInfo numbered = info;
+        numbered.recordNumber = recordNumber;
+
+        if (bytes > buffer.size()) {
+            // Larger than the buffer: serialize separately and write through
+            std::vector<uint8_t> record;
+            evio6::writeAggregatedRecord(numbered, slices, count, record);
+            if (!append(record.data(), record.size())) return false;
+        } else {
+            if (buffered + bytes > buffer.size() && !flush()) return false;
+            uint8_t* out = buffer.data() + buffered;
+            size_t offset = encodeAggregatedHeader(out, numbered, slices, count, payloadBytes);
+            copyRocBanks(out + offset, slices, count);
+            buffered += bytes;
+        }
+
+        endRecord(bytes, 1);
+        return true;
+    }
+
+    /**
+     * Serialize a merged frame record (see encodeMergedRecord) straight into
+     * the write buffer; the ROC bank runs are copied once, from their source
+     *
+     * @return false on I/O error
+     */
+    bool writeMergedRecord(const FrameInfo& info, const SliceRef* entries, size_t entryCount,
+                           const RocBlock* blocks, size_t blockCount) {
+        const size_t bytes = mergedRecordBytes(entryCount, blocks, blockCount);
+        if (!beginRecord(bytes)) {
+            return false;
+        }
+
+        FrameInfo numbered = info;
+        numbered.recordNumber = recordNumber;
+
+        if (bytes > buffer.size()) {
+            std::vector<uint8_t> record(bytes);
+            encodeMergedRecord(record.data(), numbered, entries, entryCount, blocks, blockCount);
+            if (!append(record.data(), record.size())) return false;
+        } else {
+            if (buffered + bytes > buffer.size() && !flush()) return false;
+            encodeMergedRecord(buffer.data() + buffered, numbered, entries, entryCount, blocks, blockCount);
+            buffered += bytes;
+        }
+
+        endRecord(bytes, 1);
+        return true;
+    }
+
+    /**
+     * Finish the current file; safe to call more than once
+     */
+    bool close() {
+        return finishFile();
+    }
+
+    uint64_t recordsWritten() const { return totalRecords; }
+    uint64_t bytesWritten() const { return totalBytes + (fd >= 0 ? fileBytes : 0); }
+    uint32_t filesWritten() const { return totalFiles; }
+};
+
+} // namespace evio6
+
+#endif // CODA_FB_EVIO6_FILE_HPP
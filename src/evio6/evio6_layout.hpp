@@ -0,0 +1,297 @@
+/**
+ * EVIO-6 Layout Definitions
+ *
+ * Single source of truth for the word layout of everything coda-fb reads or
+ * writes: EVIO-6 file and record headers, the streaming aggregated time frame
+ * (0xFF60) with its Stream Info Bank, Time Slice Segment and Aggregation Info
+ * Segment, and the raw CODA ROC frames delivered by the reassembler.
+ *
+ * Header-only, constexpr, no dependencies. Used by coda-fb (writer), by
+ * evio_event_parser and by the offline tools through evio6_view.hpp and
+ * evio6_writer.hpp.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#ifndef CODA_FB_EVIO6_LAYOUT_HPP
+#define CODA_FB_EVIO6_LAYOUT_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace evio6 {
+
+// ============================================================================
+// File and Record Identification
+// ============================================================================
+constexpr uint32_t FILE_ID = 0x4556494F;         // "EVIO" in ASCII
+constexpr uint32_t MAGIC = 0xC0DA0100;           // Magic number in writer byte order
+constexpr uint32_t MAGIC_SWAPPED = 0x0001DAC0;   // Magic number read with the other byte order
+constexpr uint32_t HEADER_WORDS = 14;            // File and record headers are 14 words
+constexpr size_t   HEADER_BYTES = HEADER_WORDS * 4;
+constexpr uint8_t  VERSION = 6;
+
+/**
+ * File header word indices (14 words)
+ */
+namespace FileWord {
+    constexpr size_t FILE_ID = 0;             // "EVIO"
+    constexpr size_t FILE_NUMBER = 1;         // Split file number (0 if unused)
+    constexpr size_t HEADER_LENGTH = 2;       // Words (14)
+    constexpr size_t RECORD_COUNT = 3;        // Records in file (0 if unknown)
+    constexpr size_t INDEX_LENGTH = 4;        // Index array length in bytes
+    constexpr size_t BIT_INFO = 5;            // Bit info | version (low 8 bits)
+    constexpr size_t USER_HEADER_LENGTH = 6;  // Bytes
+    constexpr size_t MAGIC = 7;               // 0xC0DA0100
+    constexpr size_t USER_REGISTER_LO = 8;    // 64-bit user register
+    constexpr size_t USER_REGISTER_HI = 9;
+    constexpr size_t TRAILER_POS_LO = 10;     // Byte offset of trailer (0 if none)
+    constexpr size_t TRAILER_POS_HI = 11;
+    constexpr size_t USER_INT1 = 12;
+    constexpr size_t USER_INT2 = 13;
+}
+
+/**
+ * Record header word indices (14 words)
+ */
+namespace RecordWord {
+    constexpr size_t RECORD_LENGTH = 0;        // Words, inclusive of this header
+    constexpr size_t RECORD_NUMBER = 1;
+    constexpr size_t HEADER_LENGTH = 2;        // Words (14)
+    constexpr size_t EVENT_COUNT = 3;          // Events in record
+    constexpr size_t INDEX_LENGTH = 4;         // Index array length in bytes
+    constexpr size_t BIT_INFO = 5;             // Bit info | version (low 8 bits)
+    constexpr size_t USER_HEADER_LENGTH = 6;   // Bytes
+    constexpr size_t MAGIC = 7;                // 0xC0DA0100
+    constexpr size_t UNCOMPRESSED_LENGTH = 8;  // Bytes of data after the header
+    constexpr size_t COMPRESSION = 9;          // Compression type (4 bits) | compressed length
+    constexpr size_t USER_REGISTER1_LO = 10;   // 2 x 64-bit user registers (1: 64-bit event number)
+    constexpr size_t USER_REGISTER1_HI = 11;
+    constexpr size_t USER_REGISTER2_LO = 12;
+    constexpr size_t USER_REGISTER2_HI = 13;
+}
+
+/**
+ * File and record header bit info (word 5), as written by coda-fb
+ *
+ * Bits 28-30 carry the header type. Bit 31 is coda-fb's byte order flag: set
+ * in record headers written big-endian, cleared when written little-endian.
+ */
+namespace BitInfo {
+    constexpr uint32_t VERSION_MASK = 0x000000FF;
+    constexpr uint32_t LAST_RECORD = 1u << 9;        // Last record in stream
+    constexpr uint32_t TRAILER_WITH_INDEX = 1u << 10; // File header: trailer holds a record index
+    constexpr uint32_t EVIO_RECORD = 1u << 14;       // Header type = EVIO record
+    constexpr uint32_t HEADER_TYPE_MASK = 7u << 28;
+    constexpr uint32_t TRAILER = 3u << 28;           // Header type = EVIO file trailer
+    constexpr uint32_t BIG_ENDIAN_FLAG = 1u << 31;   // Big-endian headers
+}
+
+/**
+ * File trailer: a record header with no events, followed by an index of
+ * (record length in bytes, event count) word pairs, one per record
+ */
+constexpr size_t TRAILER_INDEX_WORDS_PER_RECORD = 2;
+
+// ============================================================================
+// Streaming Aggregated Time Frame Tags and Types
+// ============================================================================
+
+/**
+ * Tags of the built (aggregated) time frame
+ */
+namespace Tag {
+    constexpr uint16_t AGGREGATED_FRAME = 0xFF60;   // Aggregated frame bank
+    constexpr uint16_t STREAM_INFO = 0xFF31;        // Stream Info Bank (built)
+    constexpr uint16_t ROC_STREAM_INFO = 0xFF30;    // Stream Info Bank inside a ROC bank
+    constexpr uint8_t  TIME_SLICE = 0x32;           // Time Slice Segment (built)
+    constexpr uint8_t  AGGREGATION_INFO = 0x42;     // Aggregation Info Segment (built)
+    constexpr uint8_t  ROC_TIME_SLICE = 0x31;       // Time Slice Segment inside a ROC bank
+}
+
+/**
+ * EMU streaming tags (from EMU Evio.java), kept for reference
+ */
+namespace CODATag {
+    constexpr uint16_t STREAMING_PHYS = 0xFFD0;        // Streaming physics event
+    constexpr uint16_t STREAMING_SIB_BUILT = 0xFFD1;   // Stream Info Bank (built)
+    constexpr uint8_t  STREAMING_TSS_BUILT = 0x01;     // Time Slice Segment (built)
+    constexpr uint8_t  STREAMING_AIS_BUILT = 0x02;     // Aggregation Info Segment (built)
+}
+
+namespace DataType {
+    constexpr uint8_t UINT32 = 0x01;
+    constexpr uint8_t BANK = 0x10;
+    constexpr uint8_t SEGMENT = 0x20;
+}
+
+/**
+ * Built frame word counts (excluding the per-ROC AIS entries)
+ */
+constexpr size_t TSS_DATA_WORDS = 3;         // frameNumber, timestamp low, timestamp high
+constexpr size_t AGG_BANK_HEADER_WORDS = 2;  // length, header
+constexpr size_t SIB_HEADER_WORDS = 2;       // length, header
+constexpr size_t TSS_WORDS = 1 + TSS_DATA_WORDS;
+constexpr size_t AIS_HEADER_WORDS = 1;
+
+// ============================================================================
+// 32-bit Frame Numbers
+// ============================================================================
+/**
+ * The TSS carries the low 32 bits of the event number, which wrap during long
+ * high-rate runs (about 12 hours at 100 kHz). Compare them by signed distance,
+ * which is correct while the two numbers are less than 2^31 apart; the full
+ * 64-bit event number is in record user register 1.
+ */
+inline int32_t frameDistance(uint32_t from, uint32_t to) {
+    return static_cast<int32_t>(to - from);
+}
+
+inline bool frameBefore(uint32_t a, uint32_t b) {
+    return frameDistance(b, a) < 0;
+}
+
+/**
+ * Extend a wrapping sequence of 32-bit frame numbers to 64 bits
+ * (each number is placed nearest to the previous one)
+ */
+class FrameNumberUnwrapper {
+private:
+    bool started = false;
+    uint32_t last = 0;
+    int64_t value = 0;
+
+public:
+    int64_t operator()(uint32_t frameNumber) {
+        value = started ? value + frameDistance(last, frameNumber) : frameNumber;
+        started = true;
+        last = frameNumber;
+        return value;
+    }
+};
+
+// Bank header: tag (16) | type (8) | num (8); length is the preceding word
+constexpr uint32_t bankHeader(uint16_t tag, uint8_t type, uint8_t num) {
+    return (static_cast<uint32_t>(tag) << 16) | (static_cast<uint32_t>(type) << 8) | num;
+}
+
+// Segment header: tag (8) | type (8) | length (16)
+constexpr uint32_t segmentHeader(uint8_t tag, uint8_t type, uint16_t length) {
+    return (static_cast<uint32_t>(tag) << 24) | (static_cast<uint32_t>(type) << 16) | length;
+}
+
+// AIS entry: ROC ID (16) | reserved (8) | stream status (8)
+constexpr uint32_t aisEntry(uint16_t rocId, uint8_t status) {
+    return (static_cast<uint32_t>(rocId) << 16) | status;
+}
+
+// ============================================================================
+// Raw CODA ROC Frame (one reassembled slice, as delivered by E2SAR)
+// ============================================================================
+/**
+ * Word 1-7:   Block header
+ * Word 8:     0xc0da0100    - Magic number (correctness and byte order check)
+ * Word 9:     ROC bank length
+ * Word 10:    ROC_ID (16) | 0x10 | stream status
+ * Word 11:    Stream info bank length
+ * Word 12:    0xFF30_20_ss  - Stream info header
+ * Word 13:    0x31_01_LLLL  - Time slice segment header
+ * Word 14:    Frame number
+ * Word 15-16: Timestamp low, high
+ */
+namespace RocFrame {
+    constexpr size_t BLOCK_LENGTH = 0;        // Block length in words
+    constexpr size_t BLOCK_HEADER_LENGTH = 2; // Block header length in words (8)
+    constexpr size_t MAGIC = 7;
+    constexpr size_t ROC_BANK_LENGTH = 8;
+    constexpr size_t ROC_BANK_HEADER = 9;
+    constexpr size_t SIB_LENGTH = 10;
+    constexpr size_t SIB_HEADER = 11;
+    constexpr size_t TSS_HEADER = 12;
+    constexpr size_t FRAME_NUMBER = 13;
+    constexpr size_t TIMESTAMP_LO = 14;
+    constexpr size_t TIMESTAMP_HI = 15;
+
+    constexpr size_t BLOCK_HEADER_WORDS = 8;
+    constexpr size_t BLOCK_HEADER_BYTES = BLOCK_HEADER_WORDS * 4;  // ROC bank starts here
+    constexpr size_t MIN_BYTES = 16 * 4;                           // Through the timestamp
+}
+
+// ============================================================================
+// Byte Order
+// ============================================================================
+inline uint32_t swap32(uint32_t val) {
+    return __builtin_bswap32(val);
+}
+
+// Load/store a 32-bit word at any byte position (no alignment requirement)
+inline uint32_t loadNative32(const uint8_t* p) {
+    uint32_t val;
+    std::memcpy(&val, p, 4);
+    return val;
+}
+
+inline uint32_t loadBE32(const uint8_t* p) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return loadNative32(p);
+#else
+    return swap32(loadNative32(p));
+#endif
+}
+
+inline void storeBE32(uint8_t* p, uint32_t val) {
+#if __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    val = swap32(val);
+#endif
+    std::memcpy(p, &val, 4);
+}
+
+inline uint32_t loadLE32(const uint8_t* p) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return swap32(loadNative32(p));
+#else
+    return loadNative32(p);
+#endif
+}
+
+inline void storeLE32(uint8_t* p, uint32_t val) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    val = swap32(val);
+#endif
+    std::memcpy(p, &val, 4);
+}
+
+/**
+ * Byte order policies for the writer (evio6_writer.hpp) and the views
+ * (evio6_view.hpp): the order is a template parameter, so it is fixed at
+ * compile time and words in host order are read and written without a swap.
+ *
+ * Big-endian is the default and what every tool reads; little-endian output
+ * saves the swaps on x86 when the builder and its consumers agree on it.
+ */
+struct BigEndian {
+    static constexpr bool IS_BIG = true;
+    static uint32_t load(const uint8_t* p) { return loadBE32(p); }
+    static void store(uint8_t* p, uint32_t val) { storeBE32(p, val); }
+};
+
+struct LittleEndian {
+    static constexpr bool IS_BIG = false;
+    static uint32_t load(const uint8_t* p) { return loadLE32(p); }
+    static void store(uint8_t* p, uint32_t val) { storeLE32(p, val); }
+};
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+using HostEndian = BigEndian;
+#else
+using HostEndian = LittleEndian;
+#endif
+
+inline size_t paddedBytes(size_t bytes) {
+    return (bytes + 3) & ~static_cast<size_t>(3);
+}
+
+} // namespace evio6
+
+#endif // CODA_FB_EVIO6_LAYOUT_HPP
@@ -0,0 +1,181 @@
+/**
+ * Raw ROC Frame Captures
+ *
+ * In reassembly-only mode coda-fb writes every reassembled ROC frame back to
+ * back into one file (events.bin by default), with no file header. This
+ * header walks such a capture and describes each frame, and defines the
+ * binary per-frame index written by evio_raw_scan so replay and offline
+ * building can seek to frames without rescanning.
+ *
+ * Frame boundaries come from the ROC bank length (word 9); the block length
+ * (word 1) is cross-checked against it. When the magic number is not where
+ * the next frame should start, the scanner steps forward one word at a time
+ * until it finds a frame again.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#ifndef CODA_FB_EVIO6_RAW_HPP
+#define CODA_FB_EVIO6_RAW_HPP
+
+#include "evio6_layout.hpp"
+#include "evio6_view.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace evio6 {
+
+/**
+ * Per-frame flags (RawFrame::flags, RawIndexEntry::flags)
+ */
+namespace RawFlag {
+    constexpr uint8_t BYTE_SWAPPED = 1u << 0;     // Frame is not in host byte order
+    constexpr uint8_t LENGTH_MISMATCH = 1u << 1;  // Block length disagrees with the ROC bank length
+    constexpr uint8_t BAD_STRUCTURE = 1u << 2;    // Bad block header length, ROC bank type, SIB or TSS
+}
+
+/**
+ * One frame found in a capture
+ */
+struct RawFrame {
+    uint64_t offset;       // Byte offset of the block header in the capture
+    uint32_t length;       // Bytes, block header through the end of the ROC bank
+    uint16_t rocId;
+    uint8_t  streamStatus;
+    uint8_t  flags;        // RawFlag bits
+    uint32_t frameNumber;
+    uint64_t timestamp;
+};
+
+// ============================================================================
+// Capture Scanner
+// ============================================================================
+class RawCaptureScanner {
+private:
+    const uint8_t* base;
+    size_t size;
+    size_t pos = 0;
+
+    // Next offset after 'from' where a frame's magic number lines up
+    size_t resync(size_t from) const {
+        for (size_t p = from + 4; p + RocFrame::BLOCK_HEADER_BYTES <= size; p += 4) {
+            uint32_t m = loadNative32(base + p + RocFrame::MAGIC * 4);
+            if (m == MAGIC || m == MAGIC_SWAPPED) return p;
+        }
+        return size;
+    }
+
+public:
+    uint64_t framesFound = 0;
+    uint64_t badFrames = 0;        // Frames with any RawFlag other than BYTE_SWAPPED
+    uint64_t resyncs = 0;          // Times the magic number was not where expected
+    uint64_t skippedBytes = 0;     // Bytes stepped over while resynchronizing
+    uint64_t truncatedBytes = 0;   // Bytes of an incomplete last frame
+
+    RawCaptureScanner(const uint8_t* data, size_t bytes) : base(data), size(bytes) {}
+
+    /**
+     * Find the next frame
+     *
+     * @return false at the end of the capture (an incomplete last frame is
+     *         counted in truncatedBytes and not returned)
+     */
+    bool next(RawFrame& frame) {
+        while (pos + RocFrame::BLOCK_HEADER_BYTES <= size) {
+            RocFrameView view(base + pos, size - pos);
+
+            if (!view.hasValidMagic()) {
+                size_t found = resync(pos);
+                resyncs++;
+                skippedBytes += found - pos;
+                pos = found;
+                continue;
+            }
+
+            if (view.available() < RocFrame::MIN_BYTES) break;
+
+            const uint64_t length = (RocFrame::BLOCK_HEADER_WORDS + 1 +
+                                     static_cast<uint64_t>(view.word(RocFrame::ROC_BANK_LENGTH))) * 4;
+            if (length > view.available()) break;
+
+            frame.offset = pos;
+            frame.length = static_cast<uint32_t>(length);
+            frame.rocId = view.rocId();
+            frame.streamStatus = view.streamStatus();
+            frame.frameNumber = view.frameNumber();
+            frame.timestamp = view.timestamp();
+            frame.flags = view.isByteSwapped() ? RawFlag::BYTE_SWAPPED : 0;
+
+            if (static_cast<uint64_t>(view.word(RocFrame::BLOCK_LENGTH)) * 4 != length) {
+                frame.flags |= RawFlag::LENGTH_MISMATCH;
+            }
+            if (length < RocFrame::MIN_BYTES ||
+                view.word(RocFrame::BLOCK_HEADER_LENGTH) != RocFrame::BLOCK_HEADER_WORDS ||
+                view.rocBankType() != DataType::BANK ||
+                (view.word(RocFrame::SIB_HEADER) >> 16) != Tag::ROC_STREAM_INFO ||
+                (view.word(RocFrame::TSS_HEADER) >> 24) != Tag::ROC_TIME_SLICE) {
+                frame.flags |= RawFlag::BAD_STRUCTURE;
+            }
+
+            framesFound++;
+            if (frame.flags & ~RawFlag::BYTE_SWAPPED) badFrames++;
+            pos += length;
+            return true;
+        }
+
+        truncatedBytes += size - pos;
+        pos = size;
+        return false;
+    }
+};
+
+// ============================================================================
+// Binary Frame Index
+// ============================================================================
+/**
+ * Index file: RawIndexHeader followed by entryCount RawIndexEntry records,
+ * in capture order, host byte order (byteOrderMark tells readers which)
+ */
+constexpr uint64_t RAW_INDEX_MAGIC = 0x3158444952424643ULL;  // "CFBRIDX1" read as little-endian
+constexpr uint32_t RAW_INDEX_VERSION = 1;
+constexpr uint32_t RAW_INDEX_BYTE_ORDER_MARK = 0x01020304;
+
+struct RawIndexHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint32_t entryBytes;   // sizeof(RawIndexEntry)
+    uint32_t reserved;
+    uint64_t entryCount;
+    uint64_t captureBytes; // Size of the indexed capture
+};
+
+struct RawIndexEntry {
+    uint64_t offset;
+    uint32_t length;
+    uint16_t rocId;
+    uint8_t  streamStatus;
+    uint8_t  flags;
+    uint32_t frameNumber;
+    uint32_t reserved;
+    uint64_t timestamp;
+};
+
+static_assert(sizeof(RawIndexHeader) == 40, "RawIndexHeader layout");
+static_assert(sizeof(RawIndexEntry) == 32, "RawIndexEntry layout");
+
+inline RawIndexEntry toIndexEntry(const RawFrame& frame) {
+    return {frame.offset, frame.length, frame.rocId, frame.streamStatus, frame.flags,
+            frame.frameNumber, 0, frame.timestamp};
+}
+
+inline bool isValidIndexHeader(const RawIndexHeader& header) {
+    return header.magic == RAW_INDEX_MAGIC && header.version == RAW_INDEX_VERSION &&
+           header.byteOrderMark == RAW_INDEX_BYTE_ORDER_MARK &&
+           header.entryBytes == sizeof(RawIndexEntry);
+}
+
+} // namespace evio6
+
+#endif // CODA_FB_EVIO6_RAW_HPP
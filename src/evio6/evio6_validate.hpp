@@ -0,0 +1,123 @@
+/**
+ * EVIO-6 Aggregated Frame Record Validation
+ *
+ * Checks one aggregated frame record (record header + 0xFF60 bank) against
+ * the rules evio_event_parser applies to every record: record header length,
+ * version and magic; 0xFF60 / 0xFF31 / 0x32 / 0x42 tags and types; TSS with
+ * frame number and timestamp; AIS and ROC banks inside their parents. On top
+ * of that the lengths must be consistent: each container is exactly filled
+ * by its children and there is one ROC bank per AIS entry.
+ *
+ * No allocation and no output: the first failed rule is returned as a code,
+ * so the check can run on sampled frames next to the builder.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#ifndef CODA_FB_EVIO6_VALIDATE_HPP
+#define CODA_FB_EVIO6_VALIDATE_HPP
+
+#include "evio6_layout.hpp"
+#include "evio6_view.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace evio6 {
+
+/**
+ * First rule a record failed (NONE = valid)
+ */
+enum class RecordError : uint8_t {
+    NONE = 0,
+    TRUNCATED,         // Shorter than a record header
+    RECORD_LENGTH,     // Record length disagrees with the record size
+    HEADER_LENGTH,     // Record header length is not 14 words
+    VERSION,           // Record version is not 6
+    MAGIC,             // Record magic number is not 0xC0DA0100
+    AGG_BANK_LENGTH,   // 0xFF60 bank does not fill the record
+    AGG_BANK_TAG,      // Not a 0xFF60 bank of banks
+    SIB_LENGTH,        // Stream info bank overruns the frame or is not filled by TSS + AIS
+    SIB_TAG,           // Not a 0xFF31 bank of segments
+    TSS_LENGTH,        // TSS shorter than frame number + timestamp
+    TSS_TAG,           // Not a 0x32 segment of UINT32
+    AIS_LENGTH,        // AIS overruns the stream info bank
+    AIS_TAG,           // Not a 0x42 segment of UINT32
+    ROC_BANK_LENGTH,   // ROC banks overrun or do not fill the 0xFF60 bank
+    ROC_COUNT,         // ROC bank count differs from the AIS entry count
+    COUNT              // Number of codes (for per-code counters)
+};
+
+inline const char* recordErrorName(RecordError error) {
+    switch (error) {
+        case RecordError::NONE:            return "none";
+        case RecordError::TRUNCATED:       return "truncated record";
+        case RecordError::RECORD_LENGTH:   return "record length";
+        case RecordError::HEADER_LENGTH:   return "record header length";
+        case RecordError::VERSION:         return "record version";
+        case RecordError::MAGIC:           return "record magic number";
+        case RecordError::AGG_BANK_LENGTH: return "aggregated bank length";
+        case RecordError::AGG_BANK_TAG:    return "aggregated bank tag/type";
+        case RecordError::SIB_LENGTH:      return "stream info bank length";
+        case RecordError::SIB_TAG:         return "stream info bank tag/type";
+        case RecordError::TSS_LENGTH:      return "time slice segment length";
+        case RecordError::TSS_TAG:         return "time slice segment tag/type";
+        case RecordError::AIS_LENGTH:      return "aggregation info segment length";
+        case RecordError::AIS_TAG:         return "aggregation info segment tag/type";
+        case RecordError::ROC_BANK_LENGTH: return "ROC bank length";
+        case RecordError::ROC_COUNT:       return "ROC bank count";
+        default:                           return "unknown";
+    }
+}
+
+/**
+ * Validate one aggregated frame record occupying exactly data[0..bytes)
+ *
+ * @tparam Order  Byte order of the record and frame headers (ROC banks are big-endian)
+ */
+template <typename Order>
+inline RecordError validateAggregatedRecord(const uint8_t* data, size_t bytes) {
+    if (bytes < HEADER_BYTES) return RecordError::TRUNCATED;
+
+    BasicRecordView<Order> record(data, bytes);
+    if (record.headerLength() != HEADER_WORDS) return RecordError::HEADER_LENGTH;
+    if (record.version() != VERSION) return RecordError::VERSION;
+    if (!record.hasExpectedMagic()) return RecordError::MAGIC;
+    if (record.sizeBytes() != bytes || !record.valid()) return RecordError::RECORD_LENGTH;
+
+    // 0xFF60 bank: the record's only event
+    BasicAggregatedBankView<Order> bank = aggregatedBank(record);
+    if (!bank.valid() || bank.sizeBytes() != record.eventBytes()) return RecordError::AGG_BANK_LENGTH;
+    if (!bank.hasExpectedTag()) return RecordError::AGG_BANK_TAG;
+
+    // Stream info bank: TSS + AIS, nothing else
+    BasicStreamInfoBankView<Order> sib = bank.streamInfo();
+    if (!sib.valid()) return RecordError::SIB_LENGTH;
+    if (!sib.hasExpectedTag()) return RecordError::SIB_TAG;
+
+    BasicTimeSliceSegmentView<Order> tss = sib.timeSlice();
+    if (!tss.valid()) return RecordError::TSS_LENGTH;
+    if (!tss.hasExpectedTag()) return RecordError::TSS_TAG;
+
+    BasicAggregationInfoSegmentView<Order> ais = sib.aggregationInfo();
+    if (!ais.valid()) return RecordError::AIS_LENGTH;
+    if (!ais.hasExpectedTag()) return RecordError::AIS_TAG;
+    if (tss.sizeBytes() + ais.sizeBytes() != sib.payloadBytes()) return RecordError::SIB_LENGTH;
+
+    // ROC banks: back to back to the end of the 0xFF60 bank, one per AIS entry
+    auto rocs = bank.rocBanks();
+    size_t rocCount = 0;
+    size_t rocBytes = 0;
+    for (auto it = rocs.begin(); it != rocs.end(); ++it) {
+        rocBytes = it.offset() + (*it).sizeBytes();
+        rocCount++;
+    }
+    if (rocBytes != rocs.sizeBytes()) return RecordError::ROC_BANK_LENGTH;
+    if (rocCount != ais.rocCount()) return RecordError::ROC_COUNT;
+
+    return RecordError::NONE;
+}
+
+} // namespace evio6
+
+#endif // CODA_FB_EVIO6_VALIDATE_HPP
@@ -0,0 +1,638 @@
+/**
+ * EVIO-6 Zero-Copy Views
+ *
+ * Non-owning, bounds-checked views over EVIO-6 data in memory (a mapped file,
+ * a file buffer or a freshly built frame). No view copies or byte-swaps the
+ * underlying data; fields are decoded on access.
+ *
+ * The file, record and aggregated frame views are templates on the byte
+ * order of the data (BigEndian or LittleEndian from evio6_layout.hpp), so a
+ * reader picks the order once per file and every header word is decoded
+ * without a runtime test; on a little-endian host, LittleEndian words are
+ * plain loads. The usual names (RecordView, AggregatedBankView, ...) are the
+ * big-endian instantiations. ROC banks are always read as big-endian: the
+ * builder copies them verbatim, whatever order it writes its own headers in.
+ *
+ * Bounds checking happens once, at construction: every view is created with
+ * the number of bytes available to it (never more than its parent's extent),
+ * and valid() reports whether its header and declared length fit. Accessors
+ * are unchecked after that, so a walk through valid views costs the same as
+ * hand-written pointer arithmetic. Structural validity and content checks
+ * are kept apart: valid() only means "safe to read"; predicates such as
+ * hasExpectedTag() tell whether it is the structure the caller expected.
+ *
+ * Structure (as written by coda-fb):
+ *   FileHeaderView                      14-word file header
+ *   RecordView                          14-word record header + event
+ *     AggregatedBankView                0xFF60 bank
+ *       StreamInfoBankView              0xFF31 bank
+ *         TimeSliceSegmentView          0x32 segment
+ *         AggregationInfoSegmentView    0x42 segment (ROC IDs)
+ *       BankRange of RocBankView        one ROC bank per aggregated slice
+ *
+ * detectByteOrder() tells which instantiation reads a given file.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#ifndef CODA_FB_EVIO6_VIEW_HPP
+#define CODA_FB_EVIO6_VIEW_HPP
+
+#include "evio6_layout.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+
+namespace evio6 {
+
+/**
+ * Base view: a byte range read as 32-bit words in byte order Order
+ */
+template <typename Order>
+class BasicWordView {
+protected:
+    const uint8_t* ptr = nullptr;
+    size_t avail = 0;   // Bytes available to this structure (bounded by parent)
+
+public:
+    using ByteOrder = Order;
+
+    BasicWordView() = default;
+    BasicWordView(const uint8_t* data, size_t bytes) : ptr(data), avail(bytes) {}
+
+    const uint8_t* data() const { return ptr; }
+    size_t available() const { return avail; }
+
+    // Word i from the start of the view (caller guarantees i is in range)
+    uint32_t word(size_t i) const { return Order::load(ptr + i * 4); }
+};
+
+/**
+ * Contiguous words in byte order Order, iterated by pointer (decoded on dereference)
+ *
+ * Loops over a WordRange compile to the same code as a hand-written pointer
+ * loop, so the compiler can unroll/vectorize them the same way.
+ */
+template <typename Order>
+class BasicWordRange {
+private:
+    const uint8_t* first = nullptr;
+    const uint8_t* last = nullptr;
+
+public:
+    class iterator {
+    private:
+        const uint8_t* p = nullptr;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = uint32_t;
+
+        iterator() = default;
+        explicit iterator(const uint8_t* ptr) : p(ptr) {}
+
+        uint32_t operator*() const { return Order::load(p); }
+        iterator& operator++() { p += 4; return *this; }
+        bool operator==(const iterator& o) const { return p == o.p; }
+        // Ordered compare: the loop keeps the counted 'p < end' form that the
+        // vectorizer recognises (and can never step past the end)
+        bool operator!=(const iterator& o) const { return p < o.p; }
+    };
+
+    BasicWordRange() = default;
+    // Trailing bytes that do not make a full word are excluded
+    BasicWordRange(const uint8_t* data, size_t bytes) : first(data), last(data + (bytes & ~static_cast<size_t>(3))) {}
+
+    iterator begin() const { return iterator(first); }
+    iterator end() const { return iterator(last); }
+    size_t size() const { return static_cast<size_t>(last - first) / 4; }
+    bool empty() const { return first == last; }
+};
+
+// ============================================================================
+// File and Record Headers
+// ============================================================================
+
+template <typename Order>
+class BasicFileHeaderView : public BasicWordView<Order> {
+    using Base = BasicWordView<Order>;
+    using Base::avail;
+
+public:
+    using Base::word;
+
+    BasicFileHeaderView() = default;
+    BasicFileHeaderView(const uint8_t* data, size_t bytes) : Base(data, bytes) {}
+
+    bool valid() const { return avail >= HEADER_BYTES && headerLength() >= HEADER_WORDS; }
+    bool hasExpectedId() const { return fileId() == FILE_ID && magic() == MAGIC; }
+    bool isByteSwapped() const { return magic() == MAGIC_SWAPPED; }
+
+    uint32_t fileId() const { return word(FileWord::FILE_ID); }
+    uint32_t fileNumber() const { return word(FileWord::FILE_NUMBER); }
+    uint32_t headerLength() const { return word(FileWord::HEADER_LENGTH); }
+    uint32_t recordCount() const { return word(FileWord::RECORD_COUNT); }
+    uint32_t indexLength() const { return word(FileWord::INDEX_LENGTH); }
+    uint32_t bitInfoVersion() const { return word(FileWord::BIT_INFO); }
+    uint8_t  version() const { return bitInfoVersion() & BitInfo::VERSION_MASK; }
+    uint32_t bitInfo() const { return (bitInfoVersion() >> 8) & 0xFFFFFF; }
+    uint32_t userHeaderLength() const { return word(FileWord::USER_HEADER_LENGTH); }
+    uint32_t magic() const { return word(FileWord::MAGIC); }
+    uint64_t userRegister() const {
+        return (static_cast<uint64_t>(word(FileWord::USER_REGISTER_HI)) << 32) | word(FileWord::USER_REGISTER_LO);
+    }
+    uint64_t trailerPosition() const {
+        return (static_cast<uint64_t>(word(FileWord::TRAILER_POS_HI)) << 32) | word(FileWord::TRAILER_POS_LO);
+    }
+    uint32_t userInt1() const { return word(FileWord::USER_INT1); }
+    uint32_t userInt2() const { return word(FileWord::USER_INT2); }
+    bool hasTrailerIndex() const { return (bitInfoVersion() & BitInfo::TRAILER_WITH_INDEX) != 0; }
+
+    // Offset of the first record: header + index array + padded user header
+    size_t recordsOffset() const {
+        return static_cast<size_t>(headerLength()) * 4 + indexLength() + paddedBytes(userHeaderLength());
+    }
+};
+
+template <typename Order>
+class BasicRecordView : public BasicWordView<Order> {
+    using Base = BasicWordView<Order>;
+    using Base::ptr;
+    using Base::avail;
+
+public:
+    using Base::word;
+
+    BasicRecordView() = default;
+    BasicRecordView(const uint8_t* data, size_t bytes) : Base(data, bytes) {}
+
+    // Header fits, length covers at least the header, and the whole record fits
+    bool valid() const {
+        return avail >= HEADER_BYTES &&
+               lengthWords() >= headerLength() &&
+               headerLength() >= HEADER_WORDS &&
+               sizeBytes() <= avail &&
+               dataOffset() <= sizeBytes();
+    }
+    bool hasExpectedMagic() const { return magic() == MAGIC; }
+
+    uint32_t lengthWords() const { return word(RecordWord::RECORD_LENGTH); }
+    size_t   sizeBytes() const { return static_cast<size_t>(lengthWords()) * 4; }
+    uint32_t recordNumber() const { return word(RecordWord::RECORD_NUMBER); }
+    uint32_t headerLength() const { return word(RecordWord::HEADER_LENGTH); }
+    uint32_t eventCount() const { return word(RecordWord::EVENT_COUNT); }
+    uint32_t indexLength() const { return word(RecordWord::INDEX_LENGTH); }
+    uint32_t bitInfoVersion() const { return word(RecordWord::BIT_INFO); }
+    uint8_t  version() const { return bitInfoVersion() & BitInfo::VERSION_MASK; }
+    uint32_t bitInfo() const { return (bitInfoVersion() >> 8) & 0xFFFFFF; }
+    bool     isLastRecord() const { return (bitInfo() & BitInfo::LAST_RECORD) != 0; }
+    bool     isBigEndian() const { return (bitInfoVersion() & BitInfo::BIG_ENDIAN_FLAG) != 0; }
+    bool     isTrailer() const { return (bitInfoVersion() & BitInfo::HEADER_TYPE_MASK) == BitInfo::TRAILER; }
+    uint32_t userHeaderLength() const { return word(RecordWord::USER_HEADER_LENGTH); }
+    uint32_t magic() const { return word(RecordWord::MAGIC); }
+    uint32_t uncompressedLength() const { return word(RecordWord::UNCOMPRESSED_LENGTH); }
+    uint32_t compressionWord() const { return word(RecordWord::COMPRESSION); }
+    uint8_t  compressionType() const { return (compressionWord() >> 28) & 0xF; }
+    uint32_t compressedLength() const { return compressionWord() & 0x0FFFFFFF; }
+    uint64_t userRegister1() const {
+        return (static_cast<uint64_t>(word(RecordWord::USER_REGISTER1_HI)) << 32) | word(RecordWord::USER_REGISTER1_LO);
+    }
+    uint64_t userRegister2() const {
+        return (static_cast<uint64_t>(word(RecordWord::USER_REGISTER2_HI)) << 32) | word(RecordWord::USER_REGISTER2_LO);
+    }
+
+    // Offset of event data: header + index array + padded user header
+    size_t dataOffset() const {
+        return static_cast<size_t>(headerLength()) * 4 + indexLength() + paddedBytes(userHeaderLength());
+    }
+    const uint8_t* eventData() const { return ptr + dataOffset(); }
+    size_t eventBytes() const { return sizeBytes() - dataOffset(); }
+};
+
+/**
+ * Forward iteration over consecutive records by hopping the length chain
+ *
+ * Iteration ends at the end of the data or at the first record that does not
+ * fit (truncated or corrupt length); stopOffset() tells where it ended.
+ */
+template <typename Order>
+class BasicRecordRange {
+private:
+    using RecordView = BasicRecordView<Order>;
+
+    const uint8_t* base;
+    size_t size;
+    size_t first;
+
+public:
+    class iterator {
+    private:
+        const uint8_t* base = nullptr;
+        size_t size = 0;
+        size_t pos = 0;
+
+        void settle() {
+            if (pos >= size || !RecordView(base + pos, size - pos).valid()) {
+                pos = size;  // Becomes end()
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = RecordView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = RecordView;
+
+        iterator() = default;
+        iterator(const uint8_t* b, size_t s, size_t p) : base(b), size(s), pos(p) { settle(); }
+
+        RecordView operator*() const { return RecordView(base + pos, size - pos); }
+        size_t offset() const { return pos; }
+
+        iterator& operator++() {
+            pos += RecordView(base + pos, size - pos).sizeBytes();
+            settle();
+            return *this;
+        }
+        bool operator==(const iterator& o) const { return pos == o.pos; }
+        bool operator!=(const iterator& o) const { return pos != o.pos; }
+    };
+
+    BasicRecordRange(const uint8_t* data, size_t bytes, size_t firstOffset)
+        : base(data), size(bytes), first(firstOffset) {}
+
+    iterator begin() const { return iterator(base, size, first); }
+    iterator end() const { return iterator(base, size, size); }
+
+    // Offset just past the last valid record (== size if all records are complete)
+    size_t stopOffset() const {
+        size_t pos = first;
+        while (pos < size) {
+            RecordView rec(base + pos, size - pos);
+            if (!rec.valid()) break;
+            pos += rec.sizeBytes();
+        }
+        return pos;
+    }
+};
+
+/**
+ * A whole EVIO-6 file (or file image) in memory
+ */
+template <typename Order>
+class BasicFileView {
+private:
+    const uint8_t* base;
+    size_t size;
+
+public:
+    BasicFileView(const uint8_t* data, size_t bytes) : base(data), size(bytes) {}
+
+    BasicFileHeaderView<Order> header() const { return BasicFileHeaderView<Order>(base, size); }
+    bool valid() const {
+        BasicFileHeaderView<Order> h = header();
+        return h.valid() && h.recordsOffset() <= size;
+    }
+    BasicRecordRange<Order> records() const { return BasicRecordRange<Order>(base, size, header().recordsOffset()); }
+    const uint8_t* data() const { return base; }
+    size_t sizeBytes() const { return size; }
+};
+
+// ============================================================================
+// Banks and Segments
+// ============================================================================
+
+/**
+ * Generic bank: [length (exclusive)] [tag (16) | type (8) | num (8)] [data...]
+ */
+template <typename Order>
+class BasicBankView : public BasicWordView<Order> {
+    using Base = BasicWordView<Order>;
+    using Base::ptr;
+    using Base::avail;
+
+public:
+    using Base::word;
+
+    BasicBankView() = default;
+    BasicBankView(const uint8_t* data, size_t bytes) : Base(data, bytes) {}
+
+    bool valid() const { return avail >= 8 && lengthWords() >= 1 && sizeBytes() <= avail; }
+
+    uint32_t lengthWords() const { return word(0); }   // Exclusive of the length word
+    size_t   sizeBytes() const { return (static_cast<size_t>(lengthWords()) + 1) * 4; }
+    uint32_t header() const { return word(1); }
+    uint16_t tag() const { return header() >> 16; }
+    uint8_t  type() const { return (header() >> 8) & 0xFF; }
+    uint8_t  num() const { return header() & 0xFF; }
+
+    const uint8_t* payload() const { return ptr + 8; }
+    size_t payloadBytes() const { return sizeBytes() - 8; }
+    uint32_t payloadWord(size_t i) const { return word(2 + i); }
+    BasicWordRange<Order> payloadWords() const { return BasicWordRange<Order>(payload(), payloadBytes()); }
+};
+
+/**
+ * Generic segment: [tag (8) | type (8) | length (16)] [data...]
+ */
+template <typename Order>
+class BasicSegmentView : public BasicWordView<Order> {
+    using Base = BasicWordView<Order>;
+    using Base::avail;
+
+public:
+    using Base::word;
+
+    BasicSegmentView() = default;
+    BasicSegmentView(const uint8_t* data, size_t bytes) : Base(data, bytes) {}
+
+    bool valid() const { return avail >= 4 && sizeBytes() <= avail; }
+
+    uint32_t header() const { return word(0); }
+    uint8_t  tag() const { return header() >> 24; }
+    uint8_t  type() const { return (header() >> 16) & 0xFF; }
+    uint16_t lengthWords() const { return header() & 0xFFFF; }  // Exclusive of the header
+    size_t   sizeBytes() const { return (static_cast<size_t>(lengthWords()) + 1) * 4; }
+    uint32_t dataWord(size_t i) const { return word(1 + i); }
+};
+
+/**
+ * Forward iteration over consecutive banks (ROC banks of an aggregated frame)
+ *
+ * Iteration ends at the end of the range or at the first bank that does not fit.
+ */
+template <typename View>
+class BankRange {
+private:
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+
+public:
+    class iterator {
+    private:
+        const uint8_t* base = nullptr;
+        size_t size = 0;
+        size_t pos = 0;
+
+        void settle() {
+            if (pos >= size || !View(base + pos, size - pos).valid()) {
+                pos = size;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = View;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = View;
+
+        iterator() = default;
+        iterator(const uint8_t* b, size_t s, size_t p) : base(b), size(s), pos(p) { settle(); }
+
+        View operator*() const { return View(base + pos, size - pos); }
+        size_t offset() const { return pos; }
+
+        iterator& operator++() {
+            pos += View(base + pos, size - pos).sizeBytes();
+            settle();
+            return *this;
+        }
+        bool operator==(const iterator& o) const { return pos == o.pos; }
+        bool operator!=(const iterator& o) const { return pos != o.pos; }
+    };
+
+    BankRange() = default;
+    BankRange(const uint8_t* data, size_t bytes) : base(data), size(bytes) {}
+
+    iterator begin() const { return iterator(base, size, 0); }
+    iterator end() const { return iterator(base, size, size); }
+    const uint8_t* data() const { return base; }
+    size_t sizeBytes() const { return size; }
+};
+
+// ============================================================================
+// Aggregated Time Frame
+// ============================================================================
+
+template <typename Order>
+class BasicTimeSliceSegmentView : public BasicSegmentView<Order> {
+    using Base = BasicSegmentView<Order>;
+
+public:
+    using Base::tag;
+    using Base::type;
+    using Base::lengthWords;
+    using Base::dataWord;
+
+    BasicTimeSliceSegmentView() = default;
+    BasicTimeSliceSegmentView(const uint8_t* data, size_t bytes) : Base(data, bytes) {}
+
+    bool valid() const { return Base::valid() && lengthWords() >= TSS_DATA_WORDS; }
+    bool hasExpectedTag() const { return tag() == Tag::TIME_SLICE && type() == DataType::UINT32; }
+
+    uint32_t frameNumber() const { return dataWord(0); }
+    uint64_t timestamp() const {
+        return (static_cast<uint64_t>(dataWord(2)) << 32) | dataWord(1);
+    }
+};
+
+template <typename Order>
+class BasicAggregationInfoSegmentView : public BasicSegmentView<Order> {
+    using Base = BasicSegmentView<Order>;
+
+public:
+    using Base::tag;
+    using Base::type;
+    using Base::lengthWords;
+    using Base::dataWord;
+
+    BasicAggregationInfoSegmentView() = default;
+    BasicAggregationInfoSegmentView(const uint8_t* data, size_t bytes) : Base(data, bytes) {}
+
+    bool hasExpectedTag() const { return tag() == Tag::AGGREGATION_INFO && type() == DataType::UINT32; }
+
+    // One entry per aggregated ROC: ROC ID (16) | reserved (8) | status (8)
+    size_t   rocCount() const { return lengthWords(); }
+    uint32_t entry(size_t i) const { return dataWord(i); }
+    uint16_t rocId(size_t i) const { return entry(i) >> 16; }
+    uint8_t  rocStatus(size_t i) const { return entry(i) & 0xFF; }
+};
+
+template <typename Order>
+class BasicStreamInfoBankView : public BasicBankView<Order> {
+    using Base = BasicBankView<Order>;
+
+public:
+    using Base::tag;
+    using Base::type;
+    using Base::payload;
+    using Base::payloadBytes;
+
+    BasicStreamInfoBankView() = default;
+    BasicStreamInfoBankView(const uint8_t* data, size_t bytes) : Base(data, bytes) {}
+
+    bool hasExpectedTag() const { return tag() == Tag::STREAM_INFO && type() == DataType::SEGMENT; }
+
+    BasicTimeSliceSegmentView<Order> timeSlice() const {
+        return BasicTimeSliceSegmentView<Order>(payload(), payloadBytes());
+    }
+
+    // AIS follows the TSS (call only when timeSlice().valid())
+    BasicAggregationInfoSegmentView<Order> aggregationInfo() const {
+        size_t tssBytes = timeSlice().sizeBytes();
+        return BasicAggregationInfoSegmentView<Order>(payload() + tssBytes, payloadBytes() - tssBytes);
+    }
+};
+
+// Big-endian instantiations: the names used by the tools and the builder
+using WordView = BasicWordView<BigEndian>;
+using WordRange = BasicWordRange<BigEndian>;
+using FileHeaderView = BasicFileHeaderView<BigEndian>;
+using RecordView = BasicRecordView<BigEndian>;
+using RecordRange = BasicRecordRange<BigEndian>;
+using FileView = BasicFileView<BigEndian>;
+using BankView = BasicBankView<BigEndian>;
+using SegmentView = BasicSegmentView<BigEndian>;
+using TimeSliceSegmentView = BasicTimeSliceSegmentView<BigEndian>;
+using AggregationInfoSegmentView = BasicAggregationInfoSegmentView<BigEndian>;
+using StreamInfoBankView = BasicStreamInfoBankView<BigEndian>;
+
+/**
+ * ROC time slice bank inside an aggregated frame (copied verbatim from the
+ * ROC, so always read as big-endian, whatever the order of the frame headers)
+ */
+class RocBankView : public BankView {
+public:
+    RocBankView() = default;
+    RocBankView(const uint8_t* data, size_t bytes) : BankView(data, bytes) {}
+
+    uint16_t rocId() const { return tag(); }
+    bool hasSubBanks() const { return type() == DataType::BANK; }
+
+    // Stream Info Bank (0xFF30) at the start of the ROC bank, if present
+    bool hasStreamInfo() const {
+        return hasSubBanks() && payloadBytes() >= 8 && BankView(payload(), payloadBytes()).tag() == Tag::ROC_STREAM_INFO;
+    }
+    BankView streamInfo() const { return BankView(payload(), payloadBytes()); }
+
+    // Payload (slot) banks after the ROC Stream Info Bank
+    const uint8_t* slotData() const {
+        if (!hasStreamInfo()) return payload();
+        BankView sib = streamInfo();
+        return sib.valid() ? payload() + sib.sizeBytes() : payload() + payloadBytes();
+    }
+    size_t slotDataBytes() const { return static_cast<size_t>(payload() + payloadBytes() - slotData()); }
+};
+
+template <typename Order>
+class BasicAggregatedBankView : public BasicBankView<Order> {
+    using Base = BasicBankView<Order>;
+
+public:
+    using Base::tag;
+    using Base::type;
+    using Base::num;
+    using Base::payload;
+    using Base::payloadBytes;
+
+    BasicAggregatedBankView() = default;
+    BasicAggregatedBankView(const uint8_t* data, size_t bytes) : Base(data, bytes) {}
+
+    bool hasExpectedTag() const { return tag() == Tag::AGGREGATED_FRAME && type() == DataType::BANK; }
+    uint8_t streamStatus() const { return num(); }
+
+    BasicStreamInfoBankView<Order> streamInfo() const {
+        return BasicStreamInfoBankView<Order>(payload(), payloadBytes());
+    }
+
+    // ROC banks follow the stream info bank (call only when streamInfo().valid())
+    BankRange<RocBankView> rocBanks() const {
+        size_t sibBytes = streamInfo().sizeBytes();
+        return BankRange<RocBankView>(payload() + sibBytes, payloadBytes() - sibBytes);
+    }
+};
+
+using AggregatedBankView = BasicAggregatedBankView<BigEndian>;
+
+// Aggregated frame bank of a record (call only when record.valid())
+template <typename Order>
+inline BasicAggregatedBankView<Order> aggregatedBank(const BasicRecordView<Order>& record) {
+    return BasicAggregatedBankView<Order>(record.eventData(), record.eventBytes());
+}
+
+/**
+ * Byte order of an EVIO-6 file or record, from the magic number (word 7 of
+ * the file and record headers)
+ */
+enum class DataByteOrder { BIG, LITTLE, UNKNOWN };
+
+inline DataByteOrder detectByteOrder(const uint8_t* header, size_t bytes) {
+    if (bytes < HEADER_BYTES) return DataByteOrder::UNKNOWN;
+    uint32_t magic = loadBE32(header + FileWord::MAGIC * 4);
+    if (magic == MAGIC) return DataByteOrder::BIG;
+    if (magic == MAGIC_SWAPPED) return DataByteOrder::LITTLE;
+    return DataByteOrder::UNKNOWN;
+}
+
+// ============================================================================
+// Raw CODA ROC Frame
+// ============================================================================
+
+/**
+ * One reassembled ROC frame (block header + ROC bank)
+ *
+ * The byte order is detected from the magic number at word 8; word() returns
+ * values in host order either way.
+ */
+class RocFrameView {
+private:
+    const uint8_t* ptr = nullptr;
+    size_t avail = 0;
+    bool swapped = false;
+
+public:
+    RocFrameView() = default;
+    RocFrameView(const uint8_t* data, size_t bytes) : ptr(data), avail(bytes) {
+        if (avail >= RocFrame::BLOCK_HEADER_BYTES) {
+            swapped = loadNative32(ptr + RocFrame::MAGIC * 4) == MAGIC_SWAPPED;
+        }
+    }
+
+    bool hasHeader() const { return avail >= RocFrame::BLOCK_HEADER_BYTES; }
+    uint32_t rawMagic() const { return loadNative32(ptr + RocFrame::MAGIC * 4); }
+    bool hasValidMagic() const { return hasHeader() && (rawMagic() == MAGIC || rawMagic() == MAGIC_SWAPPED); }
+    bool isByteSwapped() const { return swapped; }
+    // Through the timestamp words
+    bool hasMetadata() const { return avail >= RocFrame::MIN_BYTES && hasValidMagic(); }
+
+    uint32_t word(size_t i) const {
+        uint32_t w = loadNative32(ptr + i * 4);
+        return swapped ? swap32(w) : w;
+    }
+
+    const uint8_t* data() const { return ptr; }
+    size_t available() const { return avail; }
+
+    // ROC bank (everything after the block header) - what the builder aggregates
+    const uint8_t* rocData() const { return ptr + RocFrame::BLOCK_HEADER_BYTES; }
+    size_t rocBytes() const { return avail - RocFrame::BLOCK_HEADER_BYTES; }
+
+    uint32_t rocBankHeader() const { return word(RocFrame::ROC_BANK_HEADER); }
+    uint16_t rocId() const { return rocBankHeader() >> 16; }
+    uint8_t  rocBankType() const { return (rocBankHeader() >> 8) & 0xFF; }
+    uint8_t  streamStatus() const { return rocBankHeader() & 0xFF; }
+    uint32_t frameNumber() const { return word(RocFrame::FRAME_NUMBER); }
+    uint64_t timestamp() const {
+        return (static_cast<uint64_t>(word(RocFrame::TIMESTAMP_HI)) << 32) | word(RocFrame::TIMESTAMP_LO);
+    }
+};
+
+} // namespace evio6
+
+#endif // CODA_FB_EVIO6_VIEW_HPP
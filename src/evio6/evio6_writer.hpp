@@ -0,0 +1,266 @@
+/**
+ * EVIO-6 Aggregated Frame Serializer
+ *
+ * Writes EVIO-6 file headers, aggregated time frame records (record header
+ * + 0xFF60 bank) and file trailers straight into an output buffer. The layout comes from
+ * evio6_layout.hpp, so anything written here reads back through the views in
+ * evio6_view.hpp.
+ *
+ * Record layout:
+ *   [14-word record header]   (user register 1 = 64-bit event number)
+ *   [0xFF60 bank length] [0xFF60 | 0x10 | stream status]
+ *     [0xFF31 bank length] [0xFF31 | 0x20 | stream status]
+ *       [0x32 | 0x01 | 3] [frame number] [timestamp low] [timestamp high]
+ *       [0x42 | 0x01 | N] [ROC ID | status] x N
+ *     [ROC bank] x N       (copied verbatim, padded to 4 bytes)
+ *
+ * Headers are stored big-endian by default. Each encoder takes a byte order
+ * policy as a template parameter (evio6_layout.hpp); with LittleEndian every
+ * header word is written in that order and record bit info bit 31 is cleared.
+ * ROC banks keep the byte order they arrived in either way.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#ifndef CODA_FB_EVIO6_WRITER_HPP
+#define CODA_FB_EVIO6_WRITER_HPP
+
+#include "evio6_layout.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace evio6 {
+
+/**
+ * One ROC bank to aggregate (not owned)
+ */
+struct SliceRef {
+    const uint8_t* data;   // ROC bank (raw frame minus the CODA block header)
+    size_t bytes;
+    uint16_t rocId;
+    uint8_t status;        // Stream status for the AIS entry
+};
+
+/**
+ * Per-frame values of the record header, SIB and TSS
+ */
+struct FrameInfo {
+    uint32_t recordNumber;
+    uint32_t frameNumber;       // TSS frame number (low 32 bits of the event number)
+    uint64_t timestamp;
+    uint8_t streamStatus;       // Bit 7 = error, bits 0-6 = slice count
+    uint64_t eventNumber = 0;   // 64-bit event number, in record user register 1
+};
+
+/**
+ * Write a 14-word EVIO-6 file header to out[0..HEADER_BYTES)
+ *
+ * @param fileNumber       Split file number (0 if unused)
+ * @param recordCount      Records in the file (0 if unknown)
+ * @param trailerPosition  Byte offset of the trailer (0 if none)
+ * @param bitInfo          Bit info flags (version is added here)
+ */
+template <typename Order = BigEndian>
+inline void encodeFileHeader(uint8_t* out, uint32_t fileNumber = 0, uint32_t recordCount = 0,
+                             uint64_t trailerPosition = 0, uint32_t bitInfo = 0) {
+    uint32_t words[HEADER_WORDS] = {};
+    words[FileWord::FILE_ID] = FILE_ID;
+    words[FileWord::FILE_NUMBER] = fileNumber;
+    words[FileWord::HEADER_LENGTH] = HEADER_WORDS;
+    words[FileWord::RECORD_COUNT] = recordCount;
+    words[FileWord::BIT_INFO] = bitInfo | VERSION;
+    words[FileWord::MAGIC] = MAGIC;
+    words[FileWord::TRAILER_POS_LO] = static_cast<uint32_t>(trailerPosition & 0xFFFFFFFF);
+    words[FileWord::TRAILER_POS_HI] = static_cast<uint32_t>(trailerPosition >> 32);
+
+    for (size_t i = 0; i < HEADER_WORDS; i++) {
+        Order::store(out + i * 4, words[i]);
+    }
+}
+
+// Words from the 0xFF60 bank header through the last AIS entry
+inline size_t aggregatedMetadataWords(size_t sliceCount) {
+    return AGG_BANK_HEADER_WORDS + SIB_HEADER_WORDS + TSS_WORDS + AIS_HEADER_WORDS + sliceCount;
+}
+
+// Total ROC bank bytes of a frame, each padded to 4 bytes
+inline size_t aggregatedPayloadBytes(const SliceRef* slices, size_t count) {
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        bytes += paddedBytes(slices[i].bytes);
+    }
+    return bytes;
+}
+
+// Size of the complete record (header + aggregated bank)
+inline size_t aggregatedRecordBytes(const SliceRef* slices, size_t count) {
+    return HEADER_BYTES + aggregatedMetadataWords(count) * 4 + aggregatedPayloadBytes(slices, count);
+}
+
+/**
+ * Write the record header and aggregated bank metadata (everything up to the
+ * first ROC bank) to out; returns the number of bytes written
+ *
+ * @param payloadBytes  Padded ROC bank bytes that will follow
+ */
+template <typename Order = BigEndian>
+inline size_t encodeAggregatedHeader(uint8_t* out, const FrameInfo& info, const SliceRef* slices,
+                                     size_t count, size_t payloadBytes) {
+    const size_t metadataWords = aggregatedMetadataWords(count);
+    const size_t aggBankLength = metadataWords - 1 + payloadBytes / 4;  // Exclusive of its length word
+    const size_t recordWords = HEADER_WORDS + aggBankLength + 1;
+
+    // Record header
+    uint32_t header[HEADER_WORDS] = {};
+    header[RecordWord::RECORD_LENGTH] = static_cast<uint32_t>(recordWords);
+    header[RecordWord::RECORD_NUMBER] = info.recordNumber;
+    header[RecordWord::HEADER_LENGTH] = HEADER_WORDS;
+    header[RecordWord::EVENT_COUNT] = 1;
+    header[RecordWord::BIT_INFO] = VERSION | BitInfo::LAST_RECORD | BitInfo::EVIO_RECORD |
+                                   (Order::IS_BIG ? BitInfo::BIG_ENDIAN_FLAG : 0);
+    header[RecordWord::MAGIC] = MAGIC;
+    header[RecordWord::UNCOMPRESSED_LENGTH] = static_cast<uint32_t>((recordWords - HEADER_WORDS) * 4);
+    header[RecordWord::USER_REGISTER1_LO] = static_cast<uint32_t>(info.eventNumber & 0xFFFFFFFF);
+    header[RecordWord::USER_REGISTER1_HI] = static_cast<uint32_t>(info.eventNumber >> 32);
+
+    uint8_t* p = out;
+    for (size_t i = 0; i < HEADER_WORDS; i++, p += 4) {
+        Order::store(p, header[i]);
+    }
+
+    // Aggregated frame bank
+    Order::store(p, static_cast<uint32_t>(aggBankLength)); p += 4;
+    Order::store(p, bankHeader(Tag::AGGREGATED_FRAME, DataType::BANK, info.streamStatus)); p += 4;
+
+    // Stream Info Bank: TSS + AIS
+    Order::store(p, static_cast<uint32_t>(1 + TSS_WORDS + AIS_HEADER_WORDS + count)); p += 4;
+    Order::store(p, bankHeader(Tag::STREAM_INFO, DataType::SEGMENT, info.streamStatus)); p += 4;
+
+    Order::store(p, segmentHeader(Tag::TIME_SLICE, DataType::UINT32, TSS_DATA_WORDS)); p += 4;
+    Order::store(p, info.frameNumber); p += 4;
+    Order::store(p, static_cast<uint32_t>(info.timestamp & 0xFFFFFFFF)); p += 4;
+    Order::store(p, static_cast<uint32_t>(info.timestamp >> 32)); p += 4;
+
+    Order::store(p, segmentHeader(Tag::AGGREGATION_INFO, DataType::UINT32, static_cast<uint16_t>(count))); p += 4;
+    for (size_t i = 0; i < count; i++, p += 4) {
+        Order::store(p, aisEntry(slices[i].rocId, slices[i].status));
+    }
+
+    return static_cast<size_t>(p - out);
+}
+
+/**
+ * Copy ROC banks back to back, each zero-padded to 4 bytes; returns bytes written
+ */
+inline size_t copyRocBanks(uint8_t* out, const SliceRef* slices, size_t count) {
+    uint8_t* p = out;
+    for (size_t i = 0; i < count; i++) {
+        std::memcpy(p, slices[i].data, slices[i].bytes);
+        p += slices[i].bytes;
+        size_t pad = paddedBytes(slices[i].bytes) - slices[i].bytes;
+        for (size_t j = 0; j < pad; j++) {
+            *p++ = 0;
+        }
+    }
+    return static_cast<size_t>(p - out);
+}
+
+/**
+ * Serialize one aggregated frame record into output (resized to fit)
+ *
+ * @return Record size in bytes
+ */
+template <typename Order = BigEndian>
+inline size_t writeAggregatedRecord(const FrameInfo& info, const SliceRef* slices, size_t count,
+                                    std::vector<uint8_t>& output) {
+    const size_t payloadBytes = aggregatedPayloadBytes(slices, count);
+    const size_t total = HEADER_BYTES + aggregatedMetadataWords(count) * 4 + payloadBytes;
+    output.resize(total);
+
+    size_t offset = encodeAggregatedHeader<Order>(output.data(), info, slices, count, payloadBytes);
+    offset += copyRocBanks(output.data() + offset, slices, count);
+    return offset;
+}
+
+/**
+ * A run of ROC banks taken over unchanged from another aggregated frame
+ * (banks already padded), so frames can be merged without walking the banks
+ */
+struct RocBlock {
+    const uint8_t* data;
+    size_t bytes;
+};
+
+// Size of a merged record: entryCount AIS entries, ROC bank runs back to back
+inline size_t mergedRecordBytes(size_t entryCount, const RocBlock* blocks, size_t blockCount) {
+    size_t payloadBytes = 0;
+    for (size_t i = 0; i < blockCount; i++) {
+        payloadBytes += blocks[i].bytes;
+    }
+    return HEADER_BYTES + aggregatedMetadataWords(entryCount) * 4 + payloadBytes;
+}
+
+/**
+ * Write a merged frame record to out (mergedRecordBytes() bytes): record
+ * header and aggregated bank metadata with one AIS entry per element of
+ * entries (only rocId and status are used), then the ROC bank runs
+ *
+ * @return Record size in bytes
+ */
+template <typename Order = BigEndian>
+inline size_t encodeMergedRecord(uint8_t* out, const FrameInfo& info, const SliceRef* entries, size_t entryCount,
+                                 const RocBlock* blocks, size_t blockCount) {
+    size_t payloadBytes = 0;
+    for (size_t i = 0; i < blockCount; i++) {
+        payloadBytes += blocks[i].bytes;
+    }
+    uint8_t* p = out + encodeAggregatedHeader<Order>(out, info, entries, entryCount, payloadBytes);
+    for (size_t i = 0; i < blockCount; i++) {
+        std::memcpy(p, blocks[i].data, blocks[i].bytes);
+        p += blocks[i].bytes;
+    }
+    return static_cast<size_t>(p - out);
+}
+
+// Size of a file trailer indexing recordCount records
+inline size_t trailerBytes(size_t recordCount) {
+    return HEADER_BYTES + recordCount * TRAILER_INDEX_WORDS_PER_RECORD * 4;
+}
+
+/**
+ * Write a file trailer: record header + (length bytes, event count) index
+ *
+ * @param out           Destination, trailerBytes(recordCount) bytes
+ * @param recordNumber  Record number of the trailer (one past the last record)
+ * @param index         TRAILER_INDEX_WORDS_PER_RECORD words per record
+ * @param recordCount   Records in the index
+ * @return              Bytes written
+ */
+template <typename Order = BigEndian>
+inline size_t encodeTrailer(uint8_t* out, uint32_t recordNumber, const uint32_t* index, size_t recordCount) {
+    const size_t indexWords = recordCount * TRAILER_INDEX_WORDS_PER_RECORD;
+
+    uint32_t header[HEADER_WORDS] = {};
+    header[RecordWord::RECORD_LENGTH] = static_cast<uint32_t>(HEADER_WORDS + indexWords);
+    header[RecordWord::RECORD_NUMBER] = recordNumber;
+    header[RecordWord::HEADER_LENGTH] = HEADER_WORDS;
+    header[RecordWord::INDEX_LENGTH] = static_cast<uint32_t>(indexWords * 4);
+    header[RecordWord::BIT_INFO] = VERSION | BitInfo::LAST_RECORD | BitInfo::TRAILER;
+    header[RecordWord::MAGIC] = MAGIC;
+
+    uint8_t* p = out;
+    for (size_t i = 0; i < HEADER_WORDS; i++, p += 4) {
+        Order::store(p, header[i]);
+    }
+    for (size_t i = 0; i < indexWords; i++, p += 4) {
+        Order::store(p, index[i]);
+    }
+    return static_cast<size_t>(p - out);
+}
+
+} // namespace evio6
+
+#endif // CODA_FB_EVIO6_WRITER_HPP
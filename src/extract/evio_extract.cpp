@@ -0,0 +1,409 @@
+/**
+ * EVIO6 Per-ROC Extractor
+ *
+ * Detector groups usually need only their own crates, but an aggregated
+ * frame carries every ROC. This tool reads built files once and writes one
+ * EVIO6 file set per ROC (or per named ROC set), each holding the same
+ * frames reduced to the selected ROC banks.
+ *
+ * Each aggregated frame is walked through the shared EVIO-6 views: the AIS
+ * lists the ROC IDs in ROC bank order and the ROC banks are found by hopping
+ * their length chain, so the payload of unselected ROCs is never touched.
+ * Selected ROC banks are copied once, straight into the output buffer, under
+ * a new SIB/TSS/AIS (same frame number and timestamp, AIS reduced to the
+ * selected ROCs).
+ *
+ * PARALLELISM:
+ * The input files are memory-mapped once and shared by all workers. Output
+ * sets are distributed over the workers (set i -> worker i % N; with
+ * --per-roc, ROC r -> worker r % N), and every worker walks all frames but
+ * writes only its own sets, so no output set is shared between threads and
+ * nothing is locked. The input is read from disk once; the workers read it
+ * from the page cache.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <unordered_map>
+
+#include "evio6/evio6_view.hpp"
+#include "evio6/evio6_file.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * One output file set and the ROC banks it collects for the current frame
+ */
+struct OutputSet {
+    std::string name;
+    std::unique_ptr<evio6::FileWriter> writer;
+    std::vector<evio6::SliceRef> pending;
+    uint64_t frames = 0;
+    uint64_t rocBanks = 0;
+    bool failed = false;
+};
+
+struct ExtractConfig {
+    std::string outDir = ".";
+    std::string outPrefix = "extract";
+    uint64_t maxFileBytes = evio6::FileWriter::DEFAULT_MAX_FILE_BYTES;
+    bool trailer = true;
+    bool perRoc = false;
+};
+
+/**
+ * Worker: owns a subset of the output sets and writes them from all frames
+ */
+class ExtractWorker {
+private:
+    const ExtractConfig& config;
+    size_t workerIndex;
+    size_t workerCount;
+
+    std::vector<std::unique_ptr<OutputSet>> sets;
+    std::unordered_map<uint16_t, std::vector<OutputSet*>> routes;  // ROC ID -> sets owned here
+    std::vector<OutputSet*> touched;
+
+    OutputSet* addSet(const std::string& name) {
+        auto set = std::make_unique<OutputSet>();
+        set->name = name;
+        set->writer = std::make_unique<evio6::FileWriter>(
+            config.outDir, config.outPrefix + "_" + name, config.maxFileBytes,
+            evio6::FileWriter::DEFAULT_BUFFER_BYTES, config.trailer);
+        sets.push_back(std::move(set));
+        return sets.back().get();
+    }
+
+    // Sets a ROC goes to (per-ROC sets are created on first sight)
+    const std::vector<OutputSet*>* route(uint16_t rocId) {
+        auto it = routes.find(rocId);
+        if (it != routes.end()) {
+            return &it->second;
+        }
+        if (config.perRoc && rocId % workerCount == workerIndex) {
+            auto& r = routes[rocId];
+            r.push_back(addSet("roc" + std::to_string(rocId)));
+            return &r;
+        }
+        return nullptr;
+    }
+
+    void extractFrame(const evio6::RecordView& record) {
+        evio6::AggregatedBankView agg = evio6::aggregatedBank(record);
+        if (!agg.valid() || !agg.hasExpectedTag()) {
+            malformed++;
+            return;
+        }
+        evio6::StreamInfoBankView sib = agg.streamInfo();
+        if (!sib.valid()) {
+            malformed++;
+            return;
+        }
+        evio6::TimeSliceSegmentView tss = sib.timeSlice();
+        if (!tss.valid()) {
+            malformed++;
+            return;
+        }
+        evio6::AggregationInfoSegmentView ais = sib.aggregationInfo();
+        if (!ais.valid()) {
+            malformed++;
+            return;
+        }
+
+        // Pair AIS entries with ROC banks, collecting the selected ones
+        size_t rocIndex = 0;
+        for (evio6::RocBankView roc : agg.rocBanks()) {
+            if (rocIndex >= ais.rocCount()) break;
+            uint16_t rocId = ais.rocId(rocIndex);
+            uint8_t status = ais.rocStatus(rocIndex);
+            rocIndex++;
+
+            const std::vector<OutputSet*>* targets = route(rocId);
+            if (targets == nullptr) continue;
+
+            for (OutputSet* set : *targets) {
+                if (set->pending.empty()) {
+                    touched.push_back(set);
+                }
+                set->pending.push_back({roc.data(), roc.sizeBytes(), rocId, status});
+            }
+        }
+        if (rocIndex != ais.rocCount()) {
+            rocCountMismatches++;
+        }
+
+        // One reduced frame per set that has any of its ROCs in this frame
+        for (OutputSet* set : touched) {
+            if (!set->failed) {
+                evio6::FrameInfo info;
+                info.recordNumber = 0;  // Assigned by the writer
+                info.frameNumber = tss.frameNumber();
+                info.timestamp = tss.timestamp();
+                info.streamStatus = (agg.streamStatus() & 0x80) | (set->pending.size() & 0x7F);
+                info.eventNumber = record.userRegister1();
+
+                if (set->writer->writeAggregatedRecord(info, set->pending.data(), set->pending.size())) {
+                    set->frames++;
+                    set->rocBanks += set->pending.size();
+                } else {
+                    set->failed = true;
+                }
+            }
+            set->pending.clear();
+        }
+        touched.clear();
+    }
+
+public:
+    uint64_t malformed = 0;
+    uint64_t rocCountMismatches = 0;
+
+    ExtractWorker(const ExtractConfig& cfg, size_t index, size_t count)
+        : config(cfg), workerIndex(index), workerCount(count) {}
+
+    // Explicit ROC set owned by this worker
+    void addRocSet(const std::string& name, const std::vector<uint16_t>& rocIds) {
+        OutputSet* set = addSet(name);
+        for (uint16_t id : rocIds) {
+            routes[id].push_back(set);
+        }
+    }
+
+    void run(const std::vector<evio6::MappedFile>& inputs) {
+        for (const auto& input : inputs) {
+            evio6::FileView file(input.data(), input.size());
+            for (evio6::RecordView record : file.records()) {
+                if (record.isTrailer()) break;
+                extractFrame(record);
+            }
+        }
+        for (auto& set : sets) {
+            if (!set->writer->close()) {
+                set->failed = true;
+            }
+        }
+    }
+
+    const std::vector<std::unique_ptr<OutputSet>>& outputSets() const { return sets; }
+};
+
+/**
+ * Parse NAME=ID[,ID...] into a named ROC set
+ */
+bool parseRocSet(const std::string& spec, std::string& name, std::vector<uint16_t>& rocIds) {
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos || eq == 0 || eq + 1 >= spec.size()) {
+        return false;
+    }
+    name = spec.substr(0, eq);
+
+    std::string list = spec.substr(eq + 1);
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t comma = list.find(',', pos);
+        std::string item = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        if (item.empty() || item.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        unsigned long id = std::stoul(item);
+        if (id > 0xFFFF) return false;
+        rocIds.push_back(static_cast<uint16_t>(id));
+        if (comma == std::string::npos) break;
+        pos = comma + 1;
+    }
+    return true;
+}
+
+void printHelp(const char* progName) {
+    std::cout << "EVIO6 Per-ROC Extractor\n\n";
+    std::cout << "Writes one EVIO6 file set per ROC (or per named ROC set) from built\n";
+    std::cout << "aggregated frame files, copying only the selected ROC banks.\n\n";
+    std::cout << "Usage: " << progName << " <file.evio>... [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help              Show this help message\n";
+    std::cout << "  --roc-set NAME=ID,...   Output set NAME with the given ROC IDs (repeatable)\n";
+    std::cout << "  --per-roc               One output set per ROC ID found (default without --roc-set)\n";
+    std::cout << "  --out-dir D             Output directory (default: .)\n";
+    std::cout << "  --out-prefix P          Output prefix (default: extract)\n";
+    std::cout << "                          Files: D/P_NAME_file*.evio (NAME = set name or roc<ID>)\n";
+    std::cout << "  --threads N             Worker threads (default: hardware concurrency)\n";
+    std::cout << "  --max-file-size GB      Output file rollover size (default: 2)\n";
+    std::cout << "  --no-trailer            Do not write trailer indexes\n\n";
+    std::cout << "Input files are processed in the order given (e.g. evio_merge output).\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " run42/frames_merged_file*.evio --roc-set fcal=1,2 --roc-set bcal=3\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    ExtractConfig config;
+    std::vector<std::string> inputPaths;
+    std::vector<std::pair<std::string, std::vector<uint16_t>>> rocSets;
+    int numThreads = std::thread::hardware_concurrency();
+    double maxFileSizeGB = 2.0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            printHelp(argv[0]);
+            return 0;
+        } else if (arg == "--roc-set" && i + 1 < argc) {
+            std::string name;
+            std::vector<uint16_t> ids;
+            if (!parseRocSet(argv[++i], name, ids)) {
+                std::cerr << "ERROR: Invalid --roc-set '" << argv[i] << "' (expected NAME=ID[,ID...])\n";
+                return 1;
+            }
+            rocSets.emplace_back(name, ids);
+        } else if (arg == "--per-roc") {
+            config.perRoc = true;
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            config.outDir = argv[++i];
+        } else if (arg == "--out-prefix" && i + 1 < argc) {
+            config.outPrefix = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            numThreads = std::atoi(argv[++i]);
+        } else if (arg == "--max-file-size" && i + 1 < argc) {
+            maxFileSizeGB = std::atof(argv[++i]);
+        } else if (arg == "--no-trailer") {
+            config.trailer = false;
+        } else if (arg[0] != '-') {
+            inputPaths.push_back(arg);
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    if (inputPaths.empty()) {
+        std::cerr << "ERROR: No input files specified\n";
+        printHelp(argv[0]);
+        return 1;
+    }
+    if (config.perRoc && !rocSets.empty()) {
+        std::cerr << "ERROR: --per-roc and --roc-set are mutually exclusive\n";
+        return 1;
+    }
+    if (rocSets.empty()) {
+        config.perRoc = true;
+    }
+    if (maxFileSizeGB <= 0) {
+        std::cerr << "ERROR: --max-file-size must be positive\n";
+        return 1;
+    }
+    config.maxFileBytes = static_cast<uint64_t>(maxFileSizeGB * 1024 * 1024 * 1024);
+
+    numThreads = std::max(1, numThreads);
+    if (!config.perRoc) {
+        numThreads = std::min<int>(numThreads, rocSets.size());
+    }
+
+    std::error_code ec;
+    fs::create_directories(config.outDir, ec);
+    if (ec) {
+        std::cerr << "ERROR: Cannot create output directory: " << config.outDir << " (" << ec.message() << ")\n";
+        return 1;
+    }
+
+    // ========================================================================
+    // Map all inputs once (shared read-only by every worker)
+    // ========================================================================
+    std::vector<evio6::MappedFile> inputs;
+    uint64_t inputBytes = 0;
+    for (const auto& path : inputPaths) {
+        evio6::MappedFile mapped;
+        if (!mapped.open(path)) {
+            return 1;
+        }
+        evio6::FileView file(mapped.data(), mapped.size());
+        if (!file.valid() || !file.header().hasExpectedId()) {
+            std::cerr << "ERROR: Not an EVIO6 file (bad file ID or magic): " << path << "\n";
+            return 1;
+        }
+        inputBytes += mapped.size();
+        inputs.push_back(std::move(mapped));
+    }
+
+    std::cout << "EVIO6 Per-ROC Extractor\n";
+    std::cout << "=======================\n";
+    std::cout << "Input: " << inputs.size() << " files (" << inputBytes << " bytes)\n";
+    std::cout << "Mode: " << (config.perRoc ? "per ROC" : std::to_string(rocSets.size()) + " ROC sets")
+              << ", " << numThreads << " threads\n";
+    std::cout << "Output: " << config.outDir << "/" << config.outPrefix << "_<set>_file*.evio\n\n";
+
+    // ========================================================================
+    // Distribute output sets and run the workers
+    // ========================================================================
+    std::vector<std::unique_ptr<ExtractWorker>> workers;
+    for (int t = 0; t < numThreads; t++) {
+        workers.push_back(std::make_unique<ExtractWorker>(config, t, numThreads));
+    }
+    for (size_t i = 0; i < rocSets.size(); i++) {
+        workers[i % numThreads]->addRocSet(rocSets[i].first, rocSets[i].second);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (auto& w : workers) {
+        threads.emplace_back([&w, &inputs]() { w->run(inputs); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // ========================================================================
+    // Summary
+    // ========================================================================
+    std::map<std::string, const OutputSet*> summary;
+    bool ok = true;
+    uint64_t bytesWritten = 0;
+    for (const auto& w : workers) {
+        for (const auto& set : w->outputSets()) {
+            summary[set->name] = set.get();
+            bytesWritten += set->writer->bytesWritten();
+            ok = ok && !set->failed;
+        }
+    }
+
+    // Every worker walks every frame, so structural problems are counted once (worker 0)
+    std::cout << "=== Extraction Summary ===\n";
+    for (const auto& [name, set] : summary) {
+        std::cout << "  " << std::left << std::setw(16) << name << std::right
+                  << " frames=" << set->frames
+                  << " roc_banks=" << set->rocBanks
+                  << " files=" << set->writer->filesWritten()
+                  << " bytes=" << set->writer->bytesWritten()
+                  << (set->failed ? " [WRITE FAILED]" : "") << "\n";
+    }
+    std::cout << "Output Sets: " << summary.size() << "\n";
+    std::cout << "Malformed Frames Skipped: " << workers[0]->malformed << "\n";
+    std::cout << "AIS/ROC Bank Count Mismatches: " << workers[0]->rocCountMismatches << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Elapsed: " << elapsed << " sec ("
+              << std::setprecision(1) << (elapsed > 0 ? inputBytes / elapsed / 1e6 : 0.0)
+              << " MB/sec input, " << (elapsed > 0 ? bytesWritten / elapsed / 1e6 : 0.0)
+              << " MB/sec output)\n";
+    std::cout << "==========================\n";
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,356 @@
+/**
+ * EVIO6 Frame Merger
+ *
+ * coda-fb splits its output across builder threads: thread t writes the
+ * frames hashed to it into {prefix}_thread{t}_file{NNNN}.evio, so the frames
+ * of any time range are scattered over N file sets. This tool restores one
+ * ordered stream:
+ *
+ *  - Each builder thread's file set is one input stream (files in file number
+ *    order). Every file is memory-mapped and its records are walked in place.
+ *  - The N streams are k-way merged by the 64-bit event number in each
+ *    record's user register 1; ties keep thread order. For files without it
+ *    (register low word differs from the Time Slice Segment frame number),
+ *    the 32-bit TSS frame number is unwrapped per stream instead.
+ *  - Records are copied unchanged (record numbers are renumbered per output
+ *    file) into rolled-over {out-prefix}_file{NNNN}.evio files, written with
+ *    large sequential writes. Each output file ends with a trailer holding a
+ *    record index, and its file header carries the record count and trailer
+ *    position.
+ *
+ * Within one builder thread frames are written in increasing frame number
+ * order; records that break this (e.g. a partial frame built late after a
+ * timeout) are still merged, but counted and reported as out of order.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <map>
+#include <queue>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+
+#include "evio6/evio6_view.hpp"
+#include "evio6/evio6_file.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * One builder thread's output: its files in order, walked record by record
+ */
+class InputStream {
+private:
+    std::vector<std::string> files;
+    size_t nextFile = 0;
+    evio6::MappedFile mapped;
+    evio6::RecordRange::iterator it;
+    evio6::RecordRange::iterator end;
+    evio6::RecordView current;
+    evio6::FrameNumberUnwrapper unwrap;
+
+    bool openNextFile() {
+        while (nextFile < files.size()) {
+            const std::string& path = files[nextFile++];
+            if (!mapped.open(path)) {
+                errors++;
+                continue;
+            }
+
+            evio6::FileView file(mapped.data(), mapped.size());
+            if (!file.valid() || !file.header().hasExpectedId()) {
+                std::cerr << "WARNING: Not an EVIO6 file (bad file ID or magic), skipped: " << path << std::endl;
+                errors++;
+                continue;
+            }
+
+            evio6::RecordRange records = file.records();
+            it = records.begin();
+            end = records.end();
+            if (records.stopOffset() < mapped.size()) {
+                std::cerr << "WARNING: Truncated or bad record at offset " << records.stopOffset()
+                          << " in " << path << ", remainder skipped" << std::endl;
+                errors++;
+            }
+            return true;
+        }
+        return false;
+    }
+
+public:
+    int threadIndex;
+    uint64_t eventNumber = 0;   // Merge key of the current record
+    uint64_t outOfOrder = 0;    // Records with a smaller frame number than their predecessor
+    uint64_t malformed = 0;     // Records without a readable aggregated frame (skipped)
+    uint64_t errors = 0;        // Unreadable files and truncated tails
+
+    InputStream(int thread, std::vector<std::string> paths)
+        : files(std::move(paths)), threadIndex(thread) {}
+
+    InputStream(InputStream&&) = default;
+
+    const evio6::RecordView& record() const { return current; }
+    size_t fileCount() const { return files.size(); }
+
+    /**
+     * Move to the next aggregated frame record, crossing file boundaries;
+     * trailers and malformed records are skipped
+     *
+     * @return false when the stream is exhausted
+     */
+    bool advance() {
+        bool first = (current.data() == nullptr);
+        uint64_t previous = eventNumber;
+
+        while (true) {
+            if (it == end && !openNextFile()) {
+                return false;
+            }
+            if (it == end) continue;
+
+            evio6::RecordView rec = *it;
+            ++it;
+            if (rec.isTrailer()) continue;
+
+            evio6::AggregatedBankView agg = evio6::aggregatedBank(rec);
+            evio6::TimeSliceSegmentView tss;
+            if (agg.valid() && agg.hasExpectedTag() && agg.streamInfo().valid()) {
+                tss = agg.streamInfo().timeSlice();
+            }
+            if (!rec.hasExpectedMagic() || !tss.valid()) {
+                malformed++;
+                continue;
+            }
+
+            current = rec;
+            uint32_t frameNumber = tss.frameNumber();
+            uint64_t registered = rec.userRegister1();
+            int64_t unwrapped = unwrap(frameNumber);
+            eventNumber = (static_cast<uint32_t>(registered) == frameNumber)
+                              ? registered : static_cast<uint64_t>(unwrapped);
+            if (!first && eventNumber < previous) {
+                outOfOrder++;
+            }
+            return true;
+        }
+    }
+};
+
+/**
+ * Find {prefix}_thread{T}_file{N}.evio in dir, grouped by T and ordered by N
+ */
+std::map<int, std::vector<std::string>> findInputFiles(const std::string& dir, const std::string& prefix) {
+    std::map<int, std::map<int, std::string>> found;
+    const std::string head = prefix + "_thread";
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file()) continue;
+        std::string name = entry.path().filename().string();
+
+        if (name.compare(0, head.size(), head) != 0) continue;
+        size_t filePos = name.find("_file", head.size());
+        if (filePos == std::string::npos || name.size() < 5 ||
+            name.compare(name.size() - 5, 5, ".evio") != 0) continue;
+
+        std::string threadStr = name.substr(head.size(), filePos - head.size());
+        std::string fileStr = name.substr(filePos + 5, name.size() - 5 - (filePos + 5));
+        if (threadStr.empty() || fileStr.empty() ||
+            threadStr.find_first_not_of("0123456789") != std::string::npos ||
+            fileStr.find_first_not_of("0123456789") != std::string::npos) continue;
+
+        found[std::stoi(threadStr)][std::stoi(fileStr)] = entry.path().string();
+    }
+    if (ec) {
+        std::cerr << "ERROR: Cannot read directory: " << dir << " (" << ec.message() << ")" << std::endl;
+    }
+
+    std::map<int, std::vector<std::string>> streams;
+    for (const auto& [thread, files] : found) {
+        for (const auto& [fileNum, path] : files) {
+            streams[thread].push_back(path);
+        }
+    }
+    return streams;
+}
+
+void printHelp(const char* progName) {
+    std::cout << "EVIO6 Frame Merger\n\n";
+    std::cout << "Merges the per-builder-thread output files of a coda-fb run into\n";
+    std::cout << "one frame-number-ordered set of EVIO6 files with trailer indexes.\n\n";
+    std::cout << "Usage: " << progName << " <input_dir> [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help              Show this help message\n";
+    std::cout << "  --prefix P              Input file prefix (default: frames)\n";
+    std::cout << "                          Reads <input_dir>/P_thread*_file*.evio\n";
+    std::cout << "  --out-dir D             Output directory (default: <input_dir>)\n";
+    std::cout << "  --out-prefix P          Output file prefix (default: <prefix>_merged)\n";
+    std::cout << "  --max-file-size GB      Output file rollover size (default: 2)\n";
+    std::cout << "  --buffer-size MB        Sequential write size (default: 16)\n";
+    std::cout << "  --no-trailer            Do not write trailer indexes\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " /data/run42 --prefix frames --out-dir /data/run42/merged\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    std::string inputDir;
+    std::string prefix = "frames";
+    std::string outDir;
+    std::string outPrefix;
+    double maxFileSizeGB = 2.0;
+    size_t bufferMB = 16;
+    bool trailer = true;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            printHelp(argv[0]);
+            return 0;
+        } else if (arg == "--prefix" && i + 1 < argc) {
+            prefix = argv[++i];
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (arg == "--out-prefix" && i + 1 < argc) {
+            outPrefix = argv[++i];
+        } else if (arg == "--max-file-size" && i + 1 < argc) {
+            maxFileSizeGB = std::atof(argv[++i]);
+        } else if (arg == "--buffer-size" && i + 1 < argc) {
+            bufferMB = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--no-trailer") {
+            trailer = false;
+        } else if (arg[0] != '-') {
+            inputDir = arg;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    if (inputDir.empty()) {
+        std::cerr << "ERROR: No input directory specified\n";
+        printHelp(argv[0]);
+        return 1;
+    }
+    if (maxFileSizeGB <= 0 || bufferMB == 0) {
+        std::cerr << "ERROR: --max-file-size and --buffer-size must be positive\n";
+        return 1;
+    }
+    if (outDir.empty()) outDir = inputDir;
+    if (outPrefix.empty()) outPrefix = prefix + "_merged";
+
+    std::error_code ec;
+    fs::create_directories(outDir, ec);
+    if (ec) {
+        std::cerr << "ERROR: Cannot create output directory: " << outDir << " (" << ec.message() << ")\n";
+        return 1;
+    }
+
+    // ========================================================================
+    // Discover the per-thread file sets
+    // ========================================================================
+    auto fileSets = findInputFiles(inputDir, prefix);
+    if (fileSets.empty()) {
+        std::cerr << "ERROR: No " << prefix << "_thread*_file*.evio files in " << inputDir << "\n";
+        return 1;
+    }
+
+    std::vector<InputStream> streams;
+    size_t inputFiles = 0;
+    for (auto& [thread, files] : fileSets) {
+        inputFiles += files.size();
+        streams.emplace_back(thread, std::move(files));
+    }
+
+    std::cout << "EVIO6 Frame Merger\n";
+    std::cout << "==================\n";
+    std::cout << "Input: " << inputDir << "/" << prefix << "_thread*_file*.evio ("
+              << streams.size() << " threads, " << inputFiles << " files)\n";
+    std::cout << "Output: " << outDir << "/" << outPrefix << "_file*.evio\n\n";
+
+    // ========================================================================
+    // K-way merge by frame number (ties: lower thread index first)
+    // ========================================================================
+    auto start = std::chrono::steady_clock::now();
+
+    using HeapEntry = std::pair<uint64_t, size_t>;  // {event number, stream index}
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+    for (size_t s = 0; s < streams.size(); s++) {
+        if (streams[s].advance()) {
+            heap.push({streams[s].eventNumber, s});
+        }
+    }
+
+    uint64_t maxFileBytes = static_cast<uint64_t>(maxFileSizeGB * 1024 * 1024 * 1024);
+    evio6::FileWriter writer(outDir, outPrefix, maxFileBytes, bufferMB * 1024 * 1024, trailer);
+
+    bool ok = true;
+    uint64_t duplicates = 0;
+    bool haveLast = false;
+    uint64_t lastFrame = 0;
+
+    while (!heap.empty()) {
+        size_t s = heap.top().second;
+        heap.pop();
+        InputStream& in = streams[s];
+
+        const evio6::RecordView& rec = in.record();
+        if (haveLast && in.eventNumber == lastFrame) {
+            duplicates++;
+        }
+        lastFrame = in.eventNumber;
+        haveLast = true;
+
+        if (!writer.writeRecord(rec.data(), rec.sizeBytes(), rec.eventCount())) {
+            ok = false;
+            break;
+        }
+
+        if (in.advance()) {
+            heap.push({in.eventNumber, s});
+        }
+    }
+
+    ok = writer.close() && ok;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // ========================================================================
+    // Summary
+    // ========================================================================
+    uint64_t outOfOrder = 0;
+    uint64_t malformed = 0;
+    uint64_t errors = 0;
+    for (const auto& in : streams) {
+        outOfOrder += in.outOfOrder;
+        malformed += in.malformed;
+        errors += in.errors;
+    }
+
+    std::cout << "=== Merge Summary ===\n";
+    std::cout << "Records Merged: " << writer.recordsWritten() << "\n";
+    std::cout << "Files Written: " << writer.filesWritten() << "\n";
+    std::cout << "Bytes Written: " << writer.bytesWritten() << "\n";
+    std::cout << "Out-of-Order Records (within a thread): " << outOfOrder << "\n";
+    std::cout << "Duplicate Frame Numbers: " << duplicates << "\n";
+    std::cout << "Malformed Records Skipped: " << malformed << "\n";
+    std::cout << "Input Errors: " << errors << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Elapsed: " << elapsed << " sec ("
+              << std::setprecision(1) << (elapsed > 0 ? writer.bytesWritten() / elapsed / 1e6 : 0.0)
+              << " MB/sec)\n";
+    std::cout << "=====================\n";
+
+    return (ok && errors == 0) ? 0 : 1;
+}
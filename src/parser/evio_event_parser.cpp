@@ -15,6 +15,9 @@
  *        - Aggregation Info Segment (tag 0x42, type 0x01)
  *      - ROC Payload Banks (one per source)
  *
+ * The layout definitions and header views are shared with the writer
+ * (src/evio6/), so both sides agree on every word by construction.
+ *
  * Copyright (c) 2024, Jefferson Science Associates
  */
 
@@ -27,55 +30,52 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <unordered_map>
+#include <thread>
+#include <chrono>
 
-// EVIO6 Constants
-namespace EVIO6 {
-    constexpr uint32_t FILE_ID_EVIO = 0x4556494F;  // "EVIO" in ASCII
-    constexpr uint32_t MAGIC_NUMBER = 0xC0DA0100;  // Big-endian magic
-    constexpr uint32_t MAGIC_NUMBER_LE = 0x0001DAC0;  // Little-endian magic
-    constexpr uint32_t HEADER_LENGTH = 14;  // words
-    constexpr uint8_t  VERSION = 6;
-
-    // CODA Tags (from coda-fb implementation)
-    constexpr uint16_t TAG_AGG_FRAME = 0xFF60;   // Aggregated frame bank
-    constexpr uint16_t TAG_STREAM_INFO = 0xFF31; // Stream Info Bank
-    constexpr uint8_t  TAG_TIME_SLICE = 0x32;    // Time Slice Segment
-    constexpr uint8_t  TAG_AGG_INFO = 0x42;      // Aggregation Info Segment
-    constexpr uint16_t TAG_ROC_BANK = 0xFF30;    // ROC Time Slice Bank
-
-    // EVIO Data Types
-    constexpr uint8_t TYPE_BANK = 0x10;
-    constexpr uint8_t TYPE_SEGMENT = 0x20;
-    constexpr uint8_t TYPE_INT = 0x01;
-}
+#include "fadc250.hpp"
+#include "evio6/evio6_view.hpp"
+#include "evio6/evio6_file.hpp"
 
-// Utility functions for byte swapping (big-endian <-> host)
-uint32_t ntoh32(uint32_t net) {
-    return ((net & 0x000000FF) << 24) |
-           ((net & 0x0000FF00) << 8) |
-           ((net & 0x00FF0000) >> 8) |
-           ((net & 0xFF000000) >> 24);
-}
+using evio6::loadBE32;
 
-uint64_t ntoh64(uint64_t net) {
-    uint32_t high = ntoh32(static_cast<uint32_t>(net & 0xFFFFFFFF));
-    uint32_t low = ntoh32(static_cast<uint32_t>((net >> 32) & 0xFFFFFFFF));
-    return (static_cast<uint64_t>(high) << 32) | low;
-}
+/**
+ * Find the data size of a payload (slot) bank inside a ROC bank
+ *
+ * CRITICAL: Like Java's getRawBytes(), don't trust the payload bank length
+ * (Java TODO: "check to see why payloadLength always returns 1").
+ * Instead, calculate payload size by looking ahead for the next payload bank
+ * header or the end of the ROC bank.
+ *
+ * @param base        Start of the file data
+ * @param dataStart   Offset of the first data word (after the bank header)
+ * @param rocDataEnd  Offset of the end of the enclosing ROC bank
+ * @return            Payload data size in bytes
+ */
+size_t findPayloadBytes(const uint8_t* base, size_t dataStart, size_t rocDataEnd) {
+    size_t scanPos = dataStart;
 
-// FADC250 Hit data structure
-struct FADCHit {
-    int crate;        // ROC ID
-    int slot;         // Payload ID (slot number)
-    int channel;      // Channel number (0-15)
-    int charge;       // Integrated charge (13 bits)
-    uint64_t time;    // Absolute hit time in nanoseconds
+    while (scanPos + 8 <= rocDataEnd) {
+        // Peek at potential next bank header
+        uint32_t peekHeader = loadBE32(base + scanPos + 4);
 
-    FADCHit(int c, int s, int ch, int q, uint64_t t)
-        : crate(c), slot(s), channel(ch), charge(q), time(t) {}
+        uint16_t peekTag = (peekHeader >> 16) & 0xFFFF;
+        uint8_t peekType = (peekHeader >> 8) & 0xFF;
 
-    FADCHit() : crate(0), slot(0), channel(0), charge(0), time(0) {}
-};
+        // Check if this looks like a valid payload bank header
+        // (tag = slot number, typically 1-20; type = 0x0)
+        if (peekType == 0x0 && peekTag > 0 && peekTag <= 0x14) {
+            // Found next payload bank
+            return scanPos - dataStart;
+        }
+
+        scanPos += 4;  // Advance by one word
+    }
+
+    // No next bank found, data extends to end of ROC
+    return rocDataEnd - dataStart;
+}
 
 // Validation result tracking
 struct ValidationResult {
@@ -115,19 +115,36 @@ struct ValidationResult {
     }
 };
 
+/**
+ * Structure walk and validation of one file, for headers written in byte
+ * order Order (evio6::BigEndian or evio6::LittleEndian, chosen per file in
+ * main); header words are decoded without any per-word byte order test
+ */
+template <typename Order>
 class EVIO6Parser {
 private:
+    // Container views in the file's byte order (ROC banks are always big-endian)
+    using FileHeaderView = evio6::BasicFileHeaderView<Order>;
+    using RecordView = evio6::BasicRecordView<Order>;
+    using AggregatedBankView = evio6::BasicAggregatedBankView<Order>;
+    using StreamInfoBankView = evio6::BasicStreamInfoBankView<Order>;
+    using TimeSliceSegmentView = evio6::BasicTimeSliceSegmentView<Order>;
+    using AggregationInfoSegmentView = evio6::BasicAggregationInfoSegmentView<Order>;
+
     std::vector<uint8_t> fileData;
     size_t currentPos = 0;
     ValidationResult result;
     bool verbose = false;
     bool fadcVerbose = false;
+    bool timeOrdered = false;
     int recordCount = 0;
+    uint32_t currentFrameNumber = 0;
     uint64_t currentFrameTimestamp = 0;
-    std::vector<FADCHit> currentEventHits;
+    std::vector<FADCHitRun> currentEventRuns;   // One time-sorted run per payload bank
+    std::vector<FADCHit> currentEventHits;      // Frame-level time-ordered merge of the runs
     std::vector<int> currentEventROCIds;
 
-    // Read 32-bit word at current position (big-endian)
+    // Read 32-bit word at current position (file byte order)
     uint32_t read32() {
         if (currentPos + 4 > fileData.size()) {
             result.addError("Unexpected end of file at offset " +
@@ -135,10 +152,9 @@ private:
             return 0;
         }
 
-        uint32_t val = 0;
-        std::memcpy(&val, &fileData[currentPos], 4);
+        uint32_t val = Order::load(&fileData[currentPos]);
         currentPos += 4;
-        return ntoh32(val);  // Convert from big-endian
+        return val;
     }
 
     // Peek at 32-bit word without advancing position
@@ -146,17 +162,22 @@ private:
         if (currentPos + offset + 4 > fileData.size()) {
             return 0;
         }
-
-        uint32_t val = 0;
-        std::memcpy(&val, &fileData[currentPos + offset], 4);
-        return ntoh32(val);
+        return Order::load(&fileData[currentPos + offset]);
     }
 
-    // Read 64-bit word (big-endian)
-    uint64_t read64() {
-        uint32_t low = read32();
-        uint32_t high = read32();
-        return (static_cast<uint64_t>(high) << 32) | low;
+    // Bytes from the current position to the end of the file
+    const uint8_t* cursor() const { return fileData.data() + currentPos; }
+    size_t remaining() const { return fileData.size() - currentPos; }
+
+    // Check that a structure of 'bytes' fits before viewing it
+    bool require(size_t bytes) {
+        if (currentPos > fileData.size() || remaining() < bytes) {
+            result.addError("Unexpected end of file at offset " +
+                          std::to_string(currentPos));
+            currentPos = fileData.size();
+            return false;
+        }
+        return true;
     }
 
     void printIndent(int level) const {
@@ -228,13 +249,11 @@ private:
         // Decode all words as hit data (no block header)
         for (size_t i = 0; i < numWords; i++) {
             // Read 32-bit word in BIG_ENDIAN
-            uint32_t word = 0;
-            std::memcpy(&word, payloadData + (i * 4), 4);
-            word = ntoh32(word);
+            uint32_t word = loadBE32(payloadData + (i * 4));
 
             // Skip words that look like headers (bit 31 = 1)
             // Though there shouldn't be any in this format
-            if (word & 0x80000000) {
+            if (FADC250::isHeader(word)) {
                 if (verbose) {
                     printIndent(5);
                     std::cout << "[FADC250] Skipping header word: 0x" << std::hex << word << std::dec << "\n";
@@ -243,9 +262,9 @@ private:
             }
 
             // Extract hit data fields (bit field extraction verified correct)
-            int charge = word & 0x1FFF;                        // Bits 0-12 (13 bits: 0-8191)
-            int channel = (word >> 13) & 0x000F;               // Bits 13-16 (4 bits: 0-15)
-            uint64_t timeOffset = ((word >> 17) & 0x3FFF) * 4; // Bits 17-30 (14 bits: 0-16383), * 4ns
+            int charge = FADC250::charge(word);                // Bits 0-12 (13 bits: 0-8191)
+            int channel = FADC250::channel(word);              // Bits 13-16 (4 bits: 0-15)
+            uint64_t timeOffset = FADC250::timeBin(word) * FADC250::TIME_BIN_NS;  // Bits 17-30, * 4ns
 
             uint64_t hitTime = frameTimestampNs + timeOffset;
 
@@ -275,8 +294,9 @@ private:
     }
 
 public:
-    EVIO6Parser(bool verbose_mode = false, bool fadc_verbose_mode = false)
-        : verbose(verbose_mode), fadcVerbose(fadc_verbose_mode) {}
+    EVIO6Parser(bool verbose_mode = false, bool fadc_verbose_mode = false,
+                bool time_ordered_mode = false)
+        : verbose(verbose_mode), fadcVerbose(fadc_verbose_mode), timeOrdered(time_ordered_mode) {}
 
     bool loadFile(const std::string& filename) {
         std::ifstream file(filename, std::ios::binary);
@@ -304,199 +324,175 @@ public:
     void parseFileHeader() {
         printHeader("EVIO6 File Header", 0);
 
-        size_t startPos = currentPos;
+        if (!require(evio6::HEADER_BYTES)) {
+            return;
+        }
+        FileHeaderView header(cursor(), remaining());
 
         // Word 1: File ID
-        uint32_t fileId = read32();
+        uint32_t fileId = header.fileId();
         printHex("File ID", fileId, 1);
 
-        if (fileId != EVIO6::FILE_ID_EVIO) {
+        if (fileId != evio6::FILE_ID) {
             result.addError("Invalid file ID: expected 0x4556494F (EVIO), got 0x" +
                           std::to_string(fileId));
             return;
         }
 
         // Word 2: File Number
-        uint32_t fileNumber = read32();
-        printField("File Number", fileNumber, "", 1);
+        printField("File Number", header.fileNumber(), "", 1);
 
         // Word 3: Header Length
-        uint32_t headerLength = read32();
+        uint32_t headerLength = header.headerLength();
         printField("Header Length", headerLength, "words", 1);
 
-        if (headerLength != EVIO6::HEADER_LENGTH) {
+        if (headerLength != evio6::HEADER_WORDS) {
             result.addError("Invalid header length: expected 14, got " +
                           std::to_string(headerLength));
         }
 
         // Word 4: Record Count
-        uint32_t recordCount = read32();
-        printField("Record Count", recordCount, "", 1);
+        printField("Record Count", header.recordCount(), "", 1);
 
         // Word 5: Index Array Length
-        uint32_t indexArrayLength = read32();
-        printField("Index Array Length", indexArrayLength, "bytes", 1);
+        printField("Index Array Length", header.indexLength(), "bytes", 1);
 
         // Word 6: Bit Info + Version
-        uint32_t bitInfoVersion = read32();
-        uint8_t version = bitInfoVersion & 0xFF;
-        uint32_t bitInfo = (bitInfoVersion >> 8) & 0xFFFFFF;
-
+        uint8_t version = header.version();
         printField("Version", version, "", 1);
-        printHex("Bit Info", bitInfo, 1);
+        printHex("Bit Info", header.bitInfo(), 1);
 
-        if (version != EVIO6::VERSION) {
+        if (version != evio6::VERSION) {
             result.addError("Invalid EVIO version: expected 6, got " +
                           std::to_string(version));
         }
 
         // Word 7: User Header Length
-        uint32_t userHeaderLength = read32();
-        printField("User Header Length", userHeaderLength, "bytes", 1);
+        printField("User Header Length", header.userHeaderLength(), "bytes", 1);
 
         // Word 8: Magic Number
-        uint32_t magic = read32();
+        uint32_t magic = header.magic();
         printHex("Magic Number", magic, 1);
 
-        if (magic != EVIO6::MAGIC_NUMBER) {
+        if (magic != evio6::MAGIC) {
             result.addError("Invalid magic number: expected 0xC0DA0100, got 0x" +
                           std::to_string(magic));
         }
 
         // Words 9-10: User Register
-        uint64_t userReg = read64();
-        printHex("User Register", static_cast<uint32_t>(userReg), 1);
+        printHex("User Register", static_cast<uint32_t>(header.userRegister()), 1);
 
         // Words 11-12: Trailer Position
-        uint64_t trailerPos = read64();
-        printField("Trailer Position", trailerPos, "bytes", 1);
+        printField("Trailer Position", header.trailerPosition(), "bytes", 1);
 
         // Words 13-14: User Integers
-        uint32_t userInt1 = read32();
-        uint32_t userInt2 = read32();
-        printField("User Integer 1", userInt1, "", 1);
-        printField("User Integer 2", userInt2, "", 1);
+        printField("User Integer 1", header.userInt1(), "", 1);
+        printField("User Integer 2", header.userInt2(), "", 1);
 
-        size_t bytesRead = currentPos - startPos;
-        if (bytesRead != 56) {
-            result.addError("File header size mismatch: read " +
-                          std::to_string(bytesRead) + " bytes, expected 56");
-        }
+        currentPos += evio6::HEADER_BYTES;
     }
 
     void parseRecordHeader() {
         printHeader("EVIO6 Record Header #" + std::to_string(recordCount), 0);
         recordCount++;
 
-        size_t startPos = currentPos;
+        if (!require(evio6::HEADER_BYTES)) {
+            return;
+        }
+        RecordView record(cursor(), remaining());
 
         // Word 1: Record Length
-        uint32_t recordLength = read32();
+        uint32_t recordLength = record.lengthWords();
         printField("Record Length", recordLength, "words (inclusive)", 1);
 
         if (recordLength == 0) {
             result.addError("Invalid record length: 0");
+            currentPos += 4;
             return;
         }
 
         // Word 2: Record Number
-        uint32_t recordNumber = read32();
-        printField("Record Number", recordNumber, "", 1);
+        printField("Record Number", record.recordNumber(), "", 1);
 
         // Word 3: Header Length
-        uint32_t headerLength = read32();
+        uint32_t headerLength = record.headerLength();
         printField("Header Length", headerLength, "words", 1);
 
-        if (headerLength != EVIO6::HEADER_LENGTH) {
+        if (headerLength != evio6::HEADER_WORDS) {
             result.addError("Invalid record header length: expected 14, got " +
                           std::to_string(headerLength));
         }
 
         // Word 4: Event Index Count
-        uint32_t eventCount = read32();
-        printField("Event Index Count", eventCount, "", 1);
+        printField("Event Index Count", record.eventCount(), "", 1);
 
         // Word 5: Index Array Length
-        uint32_t indexArrayLength = read32();
-        printField("Index Array Length", indexArrayLength, "bytes", 1);
+        printField("Index Array Length", record.indexLength(), "bytes", 1);
 
         // Word 6: Bit Info + Version
-        uint32_t bitInfoVersion = read32();
-        uint8_t version = bitInfoVersion & 0xFF;
-        uint32_t bitInfo = (bitInfoVersion >> 8) & 0xFFFFFF;
-        bool isLastRecord = (bitInfo & (1 << 9)) != 0;
-        bool hasBigEndian = (bitInfoVersion & 0x80000000) != 0;
-
+        uint8_t version = record.version();
         printField("Version", version, "", 1);
-        printHex("Bit Info", bitInfo, 1);
-        printField("Is Last Record", isLastRecord, "", 1);
-        printField("Big Endian", hasBigEndian, "", 1);
+        printHex("Bit Info", record.bitInfo(), 1);
+        printField("Is Last Record", record.isLastRecord(), "", 1);
+        printField("Big Endian", record.isBigEndian(), "", 1);
 
-        if (version != EVIO6::VERSION) {
+        if (version != evio6::VERSION) {
             result.addError("Invalid record EVIO version: expected 6, got " +
                           std::to_string(version));
         }
 
         // Word 7: User Header Length
-        uint32_t userHeaderLength = read32();
-        printField("User Header Length", userHeaderLength, "bytes", 1);
+        printField("User Header Length", record.userHeaderLength(), "bytes", 1);
 
         // Word 8: Magic Number
-        uint32_t magic = read32();
+        uint32_t magic = record.magic();
         printHex("Magic Number", magic, 1);
 
-        if (magic != EVIO6::MAGIC_NUMBER) {
+        if (!record.hasExpectedMagic()) {
             result.addError("Invalid magic number in record: expected 0xC0DA0100, got 0x" +
                           std::to_string(magic));
         }
 
         // Word 9: Uncompressed Data Length
-        uint32_t uncompressedLen = read32();
-        printField("Uncompressed Data Length", uncompressedLen, "bytes", 1);
+        printField("Uncompressed Data Length", record.uncompressedLength(), "bytes", 1);
 
         // Word 10: Compression Type + Compressed Length
-        uint32_t compressInfo = read32();
-        uint8_t compressType = (compressInfo >> 28) & 0xF;
-        uint32_t compressedLen = compressInfo & 0x0FFFFFFF;
-        printField("Compression Type", compressType, "", 1);
-        printField("Compressed Length", compressedLen, "words", 1);
+        printField("Compression Type", record.compressionType(), "", 1);
+        printField("Compressed Length", record.compressedLength(), "words", 1);
 
         // Words 11-14: User Registers (2 x 64-bit)
-        uint64_t userReg1 = read64();
-        uint64_t userReg2 = read64();
-        printHex("User Register 1", static_cast<uint32_t>(userReg1), 1);
-        printHex("User Register 2", static_cast<uint32_t>(userReg2), 1);
+        printField("User Register 1", record.userRegister1(), "64-bit event number", 1);
+        printHex("User Register 2", static_cast<uint32_t>(record.userRegister2()), 1);
 
-        size_t bytesRead = currentPos - startPos;
-        if (bytesRead != 56) {
-            result.addError("Record header size mismatch: read " +
-                          std::to_string(bytesRead) + " bytes, expected 56");
-        }
+        currentPos += evio6::HEADER_BYTES;
     }
 
     void parseAggregatedFrameBank() {
         printHeader("Aggregated Frame Bank", 1);
 
+        if (!require(8)) {
+            return;
+        }
+        AggregatedBankView bank(cursor(), remaining());
+        currentPos += 8;
+
         // Bank Length (exclusive)
-        uint32_t bankLength = read32();
-        printField("Bank Length", bankLength, "words (exclusive)", 2);
+        printField("Bank Length", bank.lengthWords(), "words (exclusive)", 2);
 
         // Bank Header: tag (16) | type (8) | streamStatus (8)
-        uint32_t bankHeader = read32();
-        uint16_t tag = (bankHeader >> 16) & 0xFFFF;
-        uint8_t type = (bankHeader >> 8) & 0xFF;
-        uint8_t streamStatus = bankHeader & 0xFF;
+        uint16_t tag = bank.tag();
+        uint8_t type = bank.type();
 
         printHex("Tag", tag, 2);
         printField("Type", type, "0x10 = BANK", 2);
-        printField("Stream Status", streamStatus, "", 2);
+        printField("Stream Status", bank.streamStatus(), "", 2);
 
-        if (tag != EVIO6::TAG_AGG_FRAME) {
+        if (tag != evio6::Tag::AGGREGATED_FRAME) {
             result.addError("Invalid aggregated frame tag: expected 0xFF60, got 0x" +
                           std::to_string(tag));
         }
 
-        if (type != EVIO6::TYPE_BANK) {
+        if (type != evio6::DataType::BANK) {
             result.addError("Invalid aggregated frame type: expected 0x10 (BANK), got 0x" +
                           std::to_string(type));
         }
@@ -505,26 +501,29 @@ public:
     void parseStreamInfoBank() {
         printHeader("Stream Info Bank", 2);
 
+        if (!require(8)) {
+            return;
+        }
+        StreamInfoBankView bank(cursor(), remaining());
+        currentPos += 8;
+
         // Bank Length
-        uint32_t bankLength = read32();
-        printField("Bank Length", bankLength, "words (exclusive)", 3);
+        printField("Bank Length", bank.lengthWords(), "words (exclusive)", 3);
 
         // Bank Header: tag (16) | type (8) | streamStatus (8)
-        uint32_t bankHeader = read32();
-        uint16_t tag = (bankHeader >> 16) & 0xFFFF;
-        uint8_t type = (bankHeader >> 8) & 0xFF;
-        uint8_t streamStatus = bankHeader & 0xFF;
+        uint16_t tag = bank.tag();
+        uint8_t type = bank.type();
 
         printHex("Tag", tag, 3);
         printField("Type", type, "0x20 = SEGMENT", 3);
-        printField("Stream Status", streamStatus, "", 3);
+        printField("Stream Status", bank.num(), "", 3);
 
-        if (tag != EVIO6::TAG_STREAM_INFO) {
+        if (tag != evio6::Tag::STREAM_INFO) {
             result.addError("Invalid stream info tag: expected 0xFF31, got 0x" +
                           std::to_string(tag));
         }
 
-        if (type != EVIO6::TYPE_SEGMENT) {
+        if (type != evio6::DataType::SEGMENT) {
             result.addError("Invalid stream info type: expected 0x20 (SEGMENT), got 0x" +
                           std::to_string(type));
         }
@@ -533,97 +532,113 @@ public:
     void parseTimeSliceSegment() {
         printHeader("Time Slice Segment (TSS)", 3);
 
+        if (!require(evio6::TSS_WORDS * 4)) {
+            return;
+        }
+        TimeSliceSegmentView tss(cursor(), remaining());
+
         // Segment Header: tag (8) | type (8) | length (16)
-        uint32_t segHeader = read32();
-        uint8_t tag = (segHeader >> 24) & 0xFF;
-        uint8_t type = (segHeader >> 16) & 0xFF;
-        uint16_t length = segHeader & 0xFFFF;
+        uint8_t tag = tss.tag();
+        uint8_t type = tss.type();
+        uint16_t length = tss.lengthWords();
 
         printHex("Tag", tag, 4);
         printField("Type", type, "0x01 = INT", 4);
         printField("Length", length, "words", 4);
 
-        if (tag != EVIO6::TAG_TIME_SLICE) {
+        if (tag != evio6::Tag::TIME_SLICE) {
             result.addError("Invalid time slice segment tag: expected 0x32, got 0x" +
                           std::to_string((int)tag));
         }
 
-        if (type != EVIO6::TYPE_INT) {
+        if (type != evio6::DataType::UINT32) {
             result.addError("Invalid time slice segment type: expected 0x01 (INT), got 0x" +
                           std::to_string((int)type));
         }
 
-        if (length != 3) {
+        if (length != evio6::TSS_DATA_WORDS) {
             result.addWarning("Time slice segment length is " + std::to_string(length) +
                             " words, expected 3");
         }
 
         // TSS Data: frameNumber, timestamp_low, timestamp_high
-        uint32_t frameNumber = read32();
-        uint32_t tsLow = read32();
-        uint32_t tsHigh = read32();
-        uint64_t timestamp = (static_cast<uint64_t>(tsHigh) << 32) | tsLow;
+        uint32_t frameNumber = tss.frameNumber();
+        uint64_t timestamp = tss.timestamp();
+        currentPos += evio6::TSS_WORDS * 4;
 
         printField("Frame Number", frameNumber, "", 4);
         printField("Timestamp", timestamp, "", 4);
 
+        currentFrameNumber = frameNumber;
         currentFrameTimestamp = timestamp;  // Store for FADC decoding
     }
 
     void parseAggregationInfoSegment() {
         printHeader("Aggregation Info Segment (AIS)", 3);
 
+        if (!require(4)) {
+            return;
+        }
+        AggregationInfoSegmentView ais(cursor(), remaining());
+
         // Segment Header: tag (8) | type (8) | length (16)
-        uint32_t segHeader = read32();
-        uint8_t tag = (segHeader >> 24) & 0xFF;
-        uint8_t type = (segHeader >> 16) & 0xFF;
-        uint16_t length = segHeader & 0xFFFF;
+        uint8_t tag = ais.tag();
+        uint8_t type = ais.type();
+        uint16_t length = ais.lengthWords();
 
         printHex("Tag", tag, 4);
         printField("Type", type, "0x01 = INT", 4);
         printField("Length", length, "ROC count", 4);
 
-        if (tag != EVIO6::TAG_AGG_INFO) {
+        if (tag != evio6::Tag::AGGREGATION_INFO) {
             result.addError("Invalid aggregation info segment tag: expected 0x42, got 0x" +
                           std::to_string((int)tag));
         }
 
-        if (type != EVIO6::TYPE_INT) {
+        if (type != evio6::DataType::UINT32) {
             result.addError("Invalid aggregation info segment type: expected 0x01 (INT), got 0x" +
                           std::to_string((int)type));
         }
 
-        // AIS Data: ROC IDs
-        for (int i = 0; i < length; i++) {
-            uint32_t rocEntry = read32();
-            uint16_t rocId = (rocEntry >> 16) & 0xFFFF;
-            uint8_t reserved = (rocEntry >> 8) & 0xFF;
-            uint8_t status = rocEntry & 0xFF;
+        if (!ais.valid()) {
+            result.addError("Aggregation info segment extends beyond file boundary");
+            currentPos = fileData.size();
+            return;
+        }
+
+        // AIS Data: ROC IDs (recorded for the ROC payload banks that follow)
+        for (size_t i = 0; i < ais.rocCount(); i++) {
+            currentEventROCIds.push_back(ais.rocId(i));
 
             if (verbose) {
                 printIndent(4);
-                std::cout << "ROC " << i << ": ID=0x" << std::hex << rocId
-                         << ", Status=0x" << (int)status << std::dec << "\n";
+                std::cout << "ROC " << i << ": ID=0x" << std::hex << ais.rocId(i)
+                         << ", Status=0x" << (int)ais.rocStatus(i) << std::dec << "\n";
             }
         }
+        currentPos += ais.sizeBytes();
     }
 
     void parseROCPayloadBank(int rocIndex) {
         printHeader("ROC Payload Bank #" + std::to_string(rocIndex), 2);
 
+        if (!require(8)) {
+            return;
+        }
+        evio6::RocBankView roc(cursor(), remaining());
+        currentPos += 8;
+
         // ROC Bank Length
-        uint32_t bankLength = read32();
+        uint32_t bankLength = roc.lengthWords();
         printField("ROC Bank Length", bankLength, "words (exclusive)", 3);
 
         // ROC Bank Header
-        uint32_t bankHeader = read32();
-        uint16_t tag = (bankHeader >> 16) & 0xFFFF;
-        uint8_t type = (bankHeader >> 8) & 0xFF;
-        uint8_t streamStatus = bankHeader & 0xFF;
+        uint16_t tag = roc.tag();
+        uint8_t type = roc.type();
 
         printHex("Tag", tag, 3);
         printField("Type", type, "", 3);
-        printField("Stream Status", streamStatus, "", 3);
+        printField("Stream Status", roc.num(), "", 3);
 
         // Debug: Show ROC bank type when verbose enabled
         if (verbose) {
@@ -644,7 +659,7 @@ public:
         int rocId = (rocIndex < currentEventROCIds.size()) ? currentEventROCIds[rocIndex] : rocIndex;
 
         // Check if this is a BANK (0x10) containing sub-banks, or direct data
-        if (type == 0x10) {
+        if (roc.hasSubBanks()) {
             // ROC bank contains sub-banks (one per FADC slot)
             // bankLength is exclusive, so actual data is (bankLength - 1) words
             size_t rocDataWords = bankLength - 1;
@@ -657,20 +672,9 @@ public:
 
             // First, skip the Stream Info Bank (SIB) with tag 0xFF30
             // Per page 21 of spec: ROC Time Slice Bank contains SIB followed by payload banks
-            if (currentPos < rocDataEndPos) {
-                uint32_t sibLength = read32();
-                uint32_t sibHeader = read32();
-                uint16_t sibTag = (sibHeader >> 16) & 0xFFFF;
-
-                if (sibTag == 0xFF30) {
-                    // Skip the Stream Info Bank data
-                    size_t sibDataWords = (sibLength > 1) ? (sibLength - 1) : 0;
-                    size_t sibBytes = sibDataWords * 4;
-                    currentPos += sibBytes;
-                } else {
-                    // Not a SIB, rewind and treat as payload bank
-                    currentPos -= 8;
-                }
+            // (otherwise the first sub-bank is already a payload bank)
+            if (currentPos < rocDataEndPos && roc.hasStreamInfo()) {
+                currentPos += roc.streamInfo().sizeBytes();
             }
 
             // Now parse payload port banks
@@ -685,46 +689,9 @@ public:
                 uint8_t payloadType = (payloadBankHeader >> 8) & 0xFF;
                 uint8_t payloadNum = payloadBankHeader & 0xFF;  // Bits 7-0
 
-                // CRITICAL: Like Java's getRawBytes(), don't trust payloadBankLength
-                // (Java TODO: "check to see why payloadLength always returns 1")
-                // Instead, calculate payload size by looking ahead for next bank or ROC end
-
-                size_t dataStartPos = currentPos;
-                size_t payloadBytes = 0;
-
-                // Look ahead to find next payload bank header or end of ROC
-                size_t scanPos = currentPos;
-                bool foundNextBank = false;
-
-                while (scanPos + 8 <= rocDataEndPos) {
-                    // Peek at potential next bank header
-                    uint32_t peekLength = *reinterpret_cast<const uint32_t*>(&fileData[scanPos]);
-                    peekLength = __builtin_bswap32(peekLength);  // Convert from big-endian
-
-                    uint32_t peekHeader = *reinterpret_cast<const uint32_t*>(&fileData[scanPos + 4]);
-                    peekHeader = __builtin_bswap32(peekHeader);
-
-                    uint16_t peekTag = (peekHeader >> 16) & 0xFFFF;
-                    uint8_t peekType = (peekHeader >> 8) & 0xFF;
-
-                    // Check if this looks like a valid payload bank header
-                    // (tag = slot number, typically 1-20; type = 0x0)
-                    if (peekType == 0x0 && peekTag > 0 && peekTag <= 0x14) {
-                        // Found next payload bank
-                        payloadBytes = scanPos - dataStartPos;
-                        foundNextBank = true;
-                        break;
-                    }
-
-                    scanPos += 4;  // Advance by one word
-                }
-
-                if (!foundNextBank) {
-                    // No next bank found, data extends to end of ROC
-                    payloadBytes = rocDataEndPos - dataStartPos;
-                }
-
-                size_t payloadDataWords = payloadBytes / 4;
+                // Payload bank lengths are not trusted - find the data size by lookahead
+                size_t payloadBytes = findPayloadBytes(fileData.data(), currentPos,
+                                                       std::min(rocDataEndPos, fileData.size()));
 
                 // Slot number is the TAG of the payload bank (per page 21 of spec)
                 int slotId = payloadTag;
@@ -761,8 +728,8 @@ public:
                         }
                     }
 
-                    // Accumulate for event summary
-                    currentEventHits.insert(currentEventHits.end(), hits.begin(), hits.end());
+                    // Keep the sorted run for the frame-level merge
+                    currentEventRuns.push_back(std::move(hits));
 
                     currentPos += payloadBytes;
                 }
@@ -800,8 +767,8 @@ public:
                 }
             }
 
-            // Accumulate for event summary
-            currentEventHits.insert(currentEventHits.end(), hits.begin(), hits.end());
+            // Keep the sorted run for the frame-level merge
+            currentEventRuns.push_back(std::move(hits));
 
             currentPos += payloadBytes;
         }
@@ -809,6 +776,7 @@ public:
 
     void parseEvent() {
         // Clear state from previous event
+        currentEventRuns.clear();
         currentEventHits.clear();
         currentEventROCIds.clear();
 
@@ -817,28 +785,30 @@ public:
         parseStreamInfoBank();
         parseTimeSliceSegment();  // Now stores currentFrameTimestamp
 
-        // Extract ROC IDs from aggregation info segment before parsing it
-        size_t savedPos = currentPos;
-        uint32_t aisHeader = read32();
-        uint16_t rocCount = aisHeader & 0xFFFF;
-
-        // Read and store ROC IDs
-        for (int i = 0; i < rocCount; i++) {
-            uint32_t rocEntry = read32();
-            uint16_t rocId = (rocEntry >> 16) & 0xFFFF;
-            currentEventROCIds.push_back(rocId);
-        }
-
-        // Restore position and parse segment normally
-        currentPos = savedPos;
+        // Records the ROC IDs (in ROC bank order) for the payload banks
         parseAggregationInfoSegment();
+        size_t rocCount = currentEventROCIds.size();
 
         // Parse ROC payload banks
-        for (int i = 0; i < rocCount && currentPos < fileData.size(); i++) {
-            parseROCPayloadBank(i);
+        for (size_t i = 0; i < rocCount && currentPos < fileData.size(); i++) {
+            parseROCPayloadBank(static_cast<int>(i));
         }
 
-        // Event hits already printed during parsing (one line per hit)
+        // Merge the per-slot runs into one time-ordered hit stream for this frame
+        mergeTimeOrdered(currentEventRuns, currentEventHits);
+
+        // Per-slot hits were already printed during parsing (--fadc-verbose);
+        // the time-ordered mode prints the merged frame instead
+        if (timeOrdered) {
+            for (const auto& hit : currentEventHits) {
+                std::cout << "frame=" << currentFrameNumber
+                         << ", crate=" << hit.crate
+                         << ", slot=" << hit.slot
+                         << ", channel=" << hit.channel
+                         << ", charge=" << hit.charge
+                         << ", time=" << hit.time << "\n";
+            }
+        }
     }
 
     void parse() {
@@ -860,6 +830,16 @@ public:
         while (currentPos < fileData.size() && recordCount < maxRecords) {
             size_t recordStart = currentPos;
 
+            // A file trailer (record index, no events) ends the records
+            if (remaining() >= evio6::HEADER_BYTES && RecordView(cursor(), remaining()).isTrailer()) {
+                RecordView trailer(cursor(), remaining());
+                if (verbose) {
+                    std::cout << "\nFile trailer: " << trailer.indexLength() / (evio6::TRAILER_INDEX_WORDS_PER_RECORD * 4) << " records indexed\n";
+                }
+                currentPos += std::min(trailer.sizeBytes(), remaining());
+                break;
+            }
+
             // Parse record header
             parseRecordHeader();
 
@@ -896,6 +876,331 @@ public:
     }
 };
 
+/**
+ * ============================================================================
+ * Parallel FADC250 Histogramming (--histograms)
+ * ============================================================================
+ *
+ * Quick data-quality summary of a whole file without per-hit text output.
+ * The file is memory-mapped, records are indexed by hopping the record length
+ * chain, and contiguous record ranges are decoded in parallel. Each thread
+ * fills its own histograms (no sharing, no locks); they are merged at the end
+ * and written as three CSV files:
+ *   <prefix>_channels.csv  crate,slot,channel,hits,mean_charge
+ *   <prefix>_charge.csv    charge,count        (13-bit charge spectrum)
+ *   <prefix>_time.csv      time_ns,count       (hit time within frame, 4 ns bins)
+ */
+struct FADCHistograms {
+    struct ChannelStats {
+        uint64_t hits = 0;
+        uint64_t chargeSum = 0;
+    };
+
+    // Key: crate (16 bits) | slot (16 bits) | channel (8 bits)
+    std::unordered_map<uint64_t, ChannelStats> channels;
+    std::vector<uint64_t> charge = std::vector<uint64_t>(FADC250::CHARGE_BINS, 0);
+    std::vector<uint64_t> timeInFrame = std::vector<uint64_t>(FADC250::TIME_BINS, 0);
+    uint64_t records = 0;
+    uint64_t hits = 0;
+    uint64_t malformedRecords = 0;
+
+    static uint64_t channelKey(int crate, int slot, int channel) {
+        return (static_cast<uint64_t>(crate & 0xFFFF) << 24) |
+               (static_cast<uint64_t>(slot & 0xFFFF) << 8) |
+               static_cast<uint64_t>(channel & 0xFF);
+    }
+
+    void fill(int crate, int slot, uint32_t word) {
+        int q = FADC250::charge(word);
+        auto& ch = channels[channelKey(crate, slot, FADC250::channel(word))];
+        ch.hits++;
+        ch.chargeSum += q;
+        charge[q]++;
+        timeInFrame[FADC250::timeBin(word)]++;
+        hits++;
+    }
+
+    void merge(const FADCHistograms& other) {
+        for (const auto& [key, stats] : other.channels) {
+            auto& ch = channels[key];
+            ch.hits += stats.hits;
+            ch.chargeSum += stats.chargeSum;
+        }
+        for (size_t i = 0; i < charge.size(); i++) charge[i] += other.charge[i];
+        for (size_t i = 0; i < timeInFrame.size(); i++) timeInFrame[i] += other.timeInFrame[i];
+        records += other.records;
+        hits += other.hits;
+        malformedRecords += other.malformedRecords;
+    }
+};
+
+template <typename Order>
+class FADCHistogrammer {
+private:
+    // Container views in the file's byte order (ROC banks are always big-endian)
+    using FileHeaderView = evio6::BasicFileHeaderView<Order>;
+    using RecordView = evio6::BasicRecordView<Order>;
+    using AggregatedBankView = evio6::BasicAggregatedBankView<Order>;
+    using StreamInfoBankView = evio6::BasicStreamInfoBankView<Order>;
+    using TimeSliceSegmentView = evio6::BasicTimeSliceSegmentView<Order>;
+    using AggregationInfoSegmentView = evio6::BasicAggregationInfoSegmentView<Order>;
+    using FileView = evio6::BasicFileView<Order>;
+    using RecordRange = evio6::BasicRecordRange<Order>;
+
+    evio6::MappedFile mapped;
+    const uint8_t* base = nullptr;
+    size_t fileSize = 0;
+    std::vector<std::pair<size_t, size_t>> recordIndex;  // {start, end} byte offsets
+
+    // Decode all hit words of one payload into the histograms
+    static void fillPayload(FADCHistograms& h, int crate, int slot,
+                            const uint8_t* data, size_t bytes) {
+        for (size_t off = 0; off + 4 <= bytes; off += 4) {
+            uint32_t word = loadBE32(data + off);
+            if (!FADC250::isHeader(word)) {
+                h.fill(crate, slot, word);
+            }
+        }
+    }
+
+    /**
+     * Decode one record (same structure walk as EVIO6Parser<Order>::parseEvent,
+     * without text output or per-field validation messages)
+     *
+     * @return false if the record structure is malformed
+     */
+    bool histogramRecord(const RecordView& record, FADCHistograms& h) const {
+        // Aggregated Frame Bank (0xFF60) > Stream Info Bank (0xFF31) > TSS + AIS
+        AggregatedBankView agg = evio6::aggregatedBank(record);
+        if (!agg.valid() || agg.tag() != evio6::Tag::AGGREGATED_FRAME) return false;
+
+        StreamInfoBankView sib = agg.streamInfo();
+        if (!sib.valid() || sib.tag() != evio6::Tag::STREAM_INFO) return false;
+
+        // Time Slice Segment (0x32) - skipped, hit times are histogrammed as in-frame offsets
+        TimeSliceSegmentView tss = sib.timeSlice();
+        if (!tss.valid() || tss.tag() != evio6::Tag::TIME_SLICE) return false;
+
+        // Aggregation Info Segment (0x42): ROC IDs in ROC bank order
+        AggregationInfoSegmentView ais = sib.aggregationInfo();
+        if (!ais.valid() || ais.tag() != evio6::Tag::AGGREGATION_INFO) return false;
+
+        // ROC payload banks follow the stream info bank
+        size_t rocIndex = 0;
+        for (evio6::RocBankView roc : agg.rocBanks()) {
+            if (rocIndex >= ais.rocCount()) break;
+            int rocId = ais.rocId(rocIndex++);
+
+            if (roc.hasSubBanks()) {
+                // Payload (slot) banks after the ROC Stream Info Bank (0xFF30)
+                const uint8_t* data = roc.slotData();
+                size_t bytes = roc.slotDataBytes();
+                size_t pos = 0;
+                while (pos + 8 <= bytes) {
+                    int slotId = loadBE32(data + pos + 4) >> 16;
+                    pos += 8;
+                    size_t payloadBytes = findPayloadBytes(data, pos, bytes);
+                    fillPayload(h, rocId, slotId, data + pos, payloadBytes);
+                    pos += payloadBytes;
+                }
+            } else {
+                // Direct data: ROC bank tag is the slot fallback
+                fillPayload(h, rocId, roc.tag(), roc.payload(), roc.payloadBytes());
+            }
+        }
+
+        h.records++;
+        return true;
+    }
+
+public:
+    bool mapFile(const std::string& filename) {
+        if (!mapped.open(filename)) {
+            return false;
+        }
+        base = mapped.data();
+        fileSize = mapped.size();
+
+        if (fileSize < evio6::HEADER_BYTES) {
+            std::cerr << "ERROR: File too small for EVIO6 file header: " << filename << std::endl;
+            return false;
+        }
+        if (!FileView(base, fileSize).header().hasExpectedId()) {
+            std::cerr << "ERROR: Not an EVIO6 file (bad file ID or magic): " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Index records by hopping the record length chain (touches headers only)
+     */
+    void indexRecords() {
+        FileView file(base, fileSize);
+        RecordRange records = file.records();
+        size_t end = file.header().recordsOffset();
+
+        for (auto it = records.begin(); it != records.end(); ++it) {
+            if ((*it).isTrailer()) {
+                return;  // File trailer (record index) ends the records
+            }
+            if (!(*it).hasExpectedMagic()) {
+                std::cerr << "WARNING: Bad record header at offset " << it.offset()
+                          << ", stopping index" << std::endl;
+                return;
+            }
+            end = it.offset() + (*it).sizeBytes();
+            recordIndex.emplace_back(it.offset(), end);
+        }
+
+        // The length chain stops early at a truncated or corrupt record
+        if (end < fileSize) {
+            std::cerr << "WARNING: Truncated or bad record at offset " << end << std::endl;
+        }
+    }
+
+    /**
+     * Decode all indexed records on numThreads threads and merge the results
+     */
+    FADCHistograms run(int numThreads) {
+        numThreads = std::max(1, std::min<int>(numThreads, std::max<size_t>(1, recordIndex.size())));
+        std::vector<FADCHistograms> perThread(numThreads);
+        std::vector<std::thread> workers;
+
+        // Contiguous record ranges, balanced by bytes
+        size_t totalBytes = recordIndex.empty() ? 0 : recordIndex.back().second - recordIndex.front().first;
+        size_t rec = 0;
+        for (int t = 0; t < numThreads; t++) {
+            size_t first = rec;
+            size_t target = recordIndex.empty() ? 0
+                          : recordIndex.front().first + totalBytes * (t + 1) / numThreads;
+            while (rec < recordIndex.size() && (recordIndex[rec].first < target || t == numThreads - 1)) {
+                rec++;
+            }
+            size_t last = rec;
+
+            workers.emplace_back([this, first, last, &perThread, t]() {
+                for (size_t r = first; r < last; r++) {
+                    RecordView record(base + recordIndex[r].first,
+                                             recordIndex[r].second - recordIndex[r].first);
+                    if (!histogramRecord(record, perThread[t])) {
+                        perThread[t].malformedRecords++;
+                    }
+                }
+            });
+        }
+
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        FADCHistograms total;
+        for (const auto& h : perThread) {
+            total.merge(h);
+        }
+        return total;
+    }
+
+    size_t recordCount() const { return recordIndex.size(); }
+    size_t bytesMapped() const { return fileSize; }
+};
+
+bool writeHistograms(const FADCHistograms& h, const std::string& prefix) {
+    std::ofstream channels(prefix + "_channels.csv");
+    std::ofstream charge(prefix + "_charge.csv");
+    std::ofstream time(prefix + "_time.csv");
+    if (!channels || !charge || !time) {
+        std::cerr << "ERROR: Cannot create histogram files with prefix: " << prefix << std::endl;
+        return false;
+    }
+
+    // Sorted by crate, slot, channel
+    std::vector<std::pair<uint64_t, FADCHistograms::ChannelStats>> sorted(h.channels.begin(), h.channels.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    channels << "crate,slot,channel,hits,mean_charge\n";
+    for (const auto& [key, stats] : sorted) {
+        channels << ((key >> 24) & 0xFFFF) << "," << ((key >> 8) & 0xFFFF) << "," << (key & 0xFF) << ","
+                 << stats.hits << "," << std::fixed << std::setprecision(2)
+                 << (stats.hits > 0 ? static_cast<double>(stats.chargeSum) / stats.hits : 0.0) << "\n";
+    }
+
+    charge << "charge,count\n";
+    for (size_t i = 0; i < h.charge.size(); i++) {
+        if (h.charge[i] > 0) charge << i << "," << h.charge[i] << "\n";
+    }
+
+    time << "time_ns,count\n";
+    for (size_t i = 0; i < h.timeInFrame.size(); i++) {
+        if (h.timeInFrame[i] > 0) time << (i * FADC250::TIME_BIN_NS) << "," << h.timeInFrame[i] << "\n";
+    }
+
+    return true;
+}
+
+template <typename Order>
+int runHistograms(const std::string& filename, int numThreads, const std::string& outPrefix) {
+    auto start = std::chrono::steady_clock::now();
+
+    FADCHistogrammer<Order> histogrammer;
+    if (!histogrammer.mapFile(filename)) {
+        return 1;
+    }
+    histogrammer.indexRecords();
+    FADCHistograms h = histogrammer.run(numThreads);
+
+    if (!writeHistograms(h, outPrefix)) {
+        return 1;
+    }
+
+    double elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "\n=== Histogram Summary ===\n";
+    std::cout << "Threads: " << numThreads << "\n";
+    std::cout << "Records: " << h.records << " decoded, " << h.malformedRecords << " malformed ("
+              << histogrammer.recordCount() << " indexed)\n";
+    std::cout << "Hits: " << h.hits << "\n";
+    std::cout << "Channels: " << h.channels.size() << "\n";
+    std::cout << "Elapsed: " << std::fixed << std::setprecision(3) << elapsedSec << " sec ("
+              << std::setprecision(1)
+              << (elapsedSec > 0 ? histogrammer.bytesMapped() / elapsedSec / (1024.0 * 1024.0) : 0.0)
+              << " MB/sec)\n";
+    std::cout << "Output: " << outPrefix << "_{channels,charge,time}.csv\n";
+    std::cout << "=========================\n";
+
+    return h.malformedRecords == 0 ? 0 : 1;
+}
+
+/**
+ * Byte order of a file's headers, from the magic number of its file header
+ * (UNKNOWN if unreadable; the big-endian reader then reports the bad header)
+ */
+evio6::DataByteOrder readFileByteOrder(const std::string& filename) {
+    uint8_t header[evio6::HEADER_BYTES];
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return evio6::DataByteOrder::UNKNOWN;
+    }
+    return evio6::detectByteOrder(header, sizeof(header));
+}
+
+template <typename Order>
+int runParser(const std::string& filename, bool verbose, bool fadcVerbose, bool timeOrdered) {
+    EVIO6Parser<Order> parser(verbose, fadcVerbose, timeOrdered);
+
+    if (!parser.loadFile(filename)) {
+        return 1;
+    }
+
+    parser.parse();
+
+    const auto& result = parser.getResult();
+    result.print();
+
+    return result.success ? 0 : 1;
+}
+
 void printHelp(const char* progName) {
     std::cout << "EVIO6 Event Parser and Validator\n";
     std::cout << "=================================\n\n";
@@ -917,7 +1222,17 @@ void printHelp(const char* progName) {
     std::cout << "                  - Slot: Module slot number (0-20)\n";
     std::cout << "                  - Channel: ADC channel (0-15)\n";
     std::cout << "                  - Charge: Integrated pulse charge (13-bit ADC)\n";
-    std::cout << "                  - Time: Absolute hit time in nanoseconds\n\n";
+    std::cout << "                  - Time: Absolute hit time in nanoseconds\n";
+    std::cout << "  --time-ordered  Print FADC250 hits per aggregated frame as one time-ordered\n";
+    std::cout << "                  stream across all ROCs and slots (k-way merge of the\n";
+    std::cout << "                  per-slot runs), prefixed with the frame number\n";
+    std::cout << "  --histograms    Decode all records in parallel and write FADC250 summary\n";
+    std::cout << "                  histograms instead of parsing output:\n";
+    std::cout << "                  - hits and mean charge per crate/slot/channel\n";
+    std::cout << "                  - charge spectrum and hit time within frame\n";
+    std::cout << "  --hist-out P    Histogram output prefix (default: <evio_file>.hist)\n";
+    std::cout << "                  writes P_channels.csv, P_charge.csv, P_time.csv\n";
+    std::cout << "  --threads N     Decoder threads for --histograms (default: all cores)\n\n";
     std::cout << "Exit Codes:\n";
     std::cout << "  0  File is valid EVIO6 format\n";
     std::cout << "  1  Validation errors or file cannot be opened\n\n";
@@ -928,6 +1243,10 @@ void printHelp(const char* progName) {
     std::cout << "  " << progName << " frames_thread0_file0000.evio --verbose\n\n";
     std::cout << "  # Decode and display FADC250 hits\n";
     std::cout << "  " << progName << " frames_thread0_file0000.evio --fadc-verbose\n\n";
+    std::cout << "  # Decode FADC250 hits as a time-ordered stream per frame\n";
+    std::cout << "  " << progName << " frames_thread0_file0000.evio --time-ordered\n\n";
+    std::cout << "  # Summarize a whole file as FADC250 histograms on 16 threads\n";
+    std::cout << "  " << progName << " frames_thread0_file0000.evio --histograms --threads 16\n\n";
     std::cout << "  # Show both structure and FADC250 data\n";
     std::cout << "  " << progName << " frames_thread0_file0000.evio --verbose --fadc-verbose\n\n";
 }
@@ -941,6 +1260,10 @@ int main(int argc, char* argv[]) {
     std::string filename;
     bool verbose = false;
     bool fadcVerbose = false;
+    bool timeOrdered = false;
+    bool histograms = false;
+    std::string histPrefix;
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -952,6 +1275,18 @@ int main(int argc, char* argv[]) {
             verbose = true;
         } else if (arg == "--fadc-verbose") {
             fadcVerbose = true;
+        } else if (arg == "--time-ordered") {
+            timeOrdered = true;
+        } else if (arg == "--histograms") {
+            histograms = true;
+        } else if (arg == "--hist-out" && i + 1 < argc) {
+            histPrefix = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            numThreads = std::atoi(argv[++i]);
+            if (numThreads < 1) {
+                std::cerr << "ERROR: --threads must be at least 1\n";
+                return 1;
+            }
         } else if (arg[0] != '-') {
             // First non-option argument is the filename
             if (filename.empty()) {
@@ -974,22 +1309,28 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // Header byte order, fixed per file: picks the reader instantiation
+    const bool littleEndian = readFileByteOrder(filename) == evio6::DataByteOrder::LITTLE;
+
+    if (histograms) {
+        std::cout << "EVIO6 Event Parser - FADC250 Histograms\n";
+        std::cout << "=======================================\n";
+        std::cout << "File: " << filename << "\n";
+        std::cout << "Byte Order: " << (littleEndian ? "little-endian" : "big-endian") << "\n";
+        const std::string prefix = histPrefix.empty() ? filename + ".hist" : histPrefix;
+        return littleEndian ? runHistograms<evio6::LittleEndian>(filename, numThreads, prefix)
+                            : runHistograms<evio6::BigEndian>(filename, numThreads, prefix);
+    }
+
     std::cout << "EVIO6 Event Parser and Validator\n";
     std::cout << "=================================\n";
     std::cout << "File: " << filename << "\n";
     std::cout << "Verbose: " << (verbose ? "enabled" : "disabled") << "\n";
-    std::cout << "FADC Verbose: " << (fadcVerbose ? "enabled" : "disabled") << "\n\n";
-
-    EVIO6Parser parser(verbose, fadcVerbose);
+    std::cout << "FADC Verbose: " << (fadcVerbose ? "enabled" : "disabled") << "\n";
+    std::cout << "Time Ordered: " << (timeOrdered ? "enabled" : "disabled") << "\n";
 
-    if (!parser.loadFile(filename)) {
-        return 1;
-    }
+    std::cout << "Byte Order: " << (littleEndian ? "little-endian" : "big-endian") << "\n\n";
 
-    parser.parse();
-
-    const auto& result = parser.getResult();
-    result.print();
-
-    return result.success ? 0 : 1;
+    return littleEndian ? runParser<evio6::LittleEndian>(filename, verbose, fadcVerbose, timeOrdered)
+                        : runParser<evio6::BigEndian>(filename, verbose, fadcVerbose, timeOrdered);
 }
@@ -0,0 +1,149 @@
+/**
+ * FADC250 Hit Types and Frame-Level Time Ordering
+ *
+ * Shared by evio_event_parser and the benchmark suite.
+ *
+ * Each FADC250 payload bank decodes into a run of hits already sorted by
+ * time (see EVIO6Parser::decodeFADC250Payload). An aggregated frame holds one
+ * such run per (ROC, slot), so a globally time-ordered hit stream for the
+ * frame only needs a k-way merge of those runs - O(n log k) for n hits in
+ * k runs, instead of the O(n log n) full sort of their concatenation.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#ifndef CODA_FB_FADC250_HPP
+#define CODA_FB_FADC250_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+/**
+ * FADC250 Data Word Format (32 bits):
+ * Bit 31:    0 (data word identifier, 1=header)
+ * Bits 17-30: Time offset (14 bits, 0-16383, in 4ns bins)
+ * Bits 13-16: Channel number (4 bits, 0-15)
+ * Bits 0-12:  Integrated charge (13 bits, 0-8191)
+ */
+namespace FADC250 {
+    constexpr uint32_t HEADER_BIT = 0x80000000;
+    constexpr int CHANNELS = 16;
+    constexpr int CHARGE_BINS = 8192;   // 13-bit charge
+    constexpr int TIME_BINS = 16384;    // 14-bit time offset
+    constexpr int TIME_BIN_NS = 4;
+
+    inline bool isHeader(uint32_t word) { return (word & HEADER_BIT) != 0; }
+    inline int charge(uint32_t word) { return word & 0x1FFF; }                  // Bits 0-12
+    inline int channel(uint32_t word) { return (word >> 13) & 0x000F; }         // Bits 13-16
+    inline uint32_t timeBin(uint32_t word) { return (word >> 17) & 0x3FFF; }    // Bits 17-30
+}
+
+// FADC250 Hit data structure
+struct FADCHit {
+    int crate;        // ROC ID
+    int slot;         // Payload ID (slot number)
+    int channel;      // Channel number (0-15)
+    int charge;       // Integrated charge (13 bits)
+    uint64_t time;    // Absolute hit time in nanoseconds
+
+    FADCHit(int c, int s, int ch, int q, uint64_t t)
+        : crate(c), slot(s), channel(ch), charge(q), time(t) {}
+
+    FADCHit() : crate(0), slot(0), channel(0), charge(0), time(0) {}
+};
+
+// One time-sorted run of hits (one decoded payload bank)
+using FADCHitRun = std::vector<FADCHit>;
+
+/**
+ * Merge time-sorted hit runs into one time-ordered stream
+ *
+ * K-way heap merge: the heap holds the head of every non-empty run. After
+ * emitting the top hit, its cursor is advanced in place and sifted down once
+ * (replace-top), so each output hit costs a single O(log k) sift instead of a
+ * pop followed by a push. Hits with equal times keep run order (lower run
+ * index first), which makes the result identical to a stable sort of the
+ * runs' concatenation.
+ *
+ * @param runs    Hit runs, each already sorted by time
+ * @param merged  Output stream (cleared first)
+ */
+inline void mergeTimeOrdered(const std::vector<FADCHitRun>& runs, std::vector<FADCHit>& merged) {
+    merged.clear();
+
+    size_t total = 0;
+    for (const auto& run : runs) {
+        total += run.size();
+    }
+    merged.reserve(total);
+
+    // Cursor into one run: heap entries are ordered by (time, run index)
+    struct Cursor {
+        uint64_t time;
+        const FADCHit* next;
+        const FADCHit* end;
+        uint32_t run;
+    };
+    auto before = [](const Cursor& a, const Cursor& b) {
+        return a.time != b.time ? a.time < b.time : a.run < b.run;
+    };
+
+    std::vector<Cursor> heap;
+    heap.reserve(runs.size());
+    for (size_t r = 0; r < runs.size(); r++) {
+        if (!runs[r].empty()) {
+            const FADCHit* first = runs[r].data();
+            heap.push_back({first->time, first, first + runs[r].size(), static_cast<uint32_t>(r)});
+        }
+    }
+
+    // Fast paths: nothing to merge
+    if (heap.empty()) {
+        return;
+    }
+    if (heap.size() == 1) {
+        merged.insert(merged.end(), heap[0].next, heap[0].end);
+        return;
+    }
+
+    // Restore the heap property below position i (min-heap on 'before')
+    auto siftDown = [&heap, &before](size_t i) {
+        const size_t n = heap.size();
+        Cursor c = heap[i];
+        while (true) {
+            size_t child = 2 * i + 1;
+            if (child >= n) break;
+            if (child + 1 < n && before(heap[child + 1], heap[child])) child++;
+            if (!before(heap[child], c)) break;
+            heap[i] = heap[child];
+            i = child;
+        }
+        heap[i] = c;
+    };
+
+    for (size_t i = heap.size() / 2; i-- > 0; ) {
+        siftDown(i);
+    }
+
+    while (true) {
+        Cursor& top = heap[0];
+        merged.push_back(*top.next);
+
+        if (++top.next != top.end) {
+            top.time = top.next->time;
+        } else {
+            // Run exhausted: move the last cursor to the top
+            top = heap.back();
+            heap.pop_back();
+            if (heap.size() == 1) {
+                merged.insert(merged.end(), heap[0].next, heap[0].end);
+                return;
+            }
+        }
+        siftDown(0);
+    }
+}
+
+#endif // CODA_FB_FADC250_HPP
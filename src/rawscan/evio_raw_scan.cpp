@@ -0,0 +1,309 @@
+/**
+ * Raw Capture Scanner and Indexer
+ *
+ * Validates the raw captures written in reassembly-only mode (events.bin:
+ * reassembled CODA ROC frames back to back, no EVIO6 file header), which
+ * evio_event_parser cannot read, and writes a per-frame index so replay and
+ * offline building can seek straight to frames.
+ *
+ * The capture is memory-mapped and walked with evio6::RawCaptureScanner:
+ * the ROC bank length after the 0xc0da0100 magic (word 8) gives each frame's
+ * extent, so only the block header and the first words of each ROC bank are
+ * touched and the scan runs at the speed the file can be read.
+ *
+ * Checks per frame: magic number (either byte order), block header length,
+ * block length vs. ROC bank length, ROC bank type, SIB and TSS tags. Per ROC:
+ * frame number continuity (gaps and frames going backwards).
+ *
+ * Outputs:
+ *  - Binary index (default <capture>.idx): RawIndexHeader + one
+ *    RawIndexEntry per frame (offset, length, ROC ID, frame number,
+ *    timestamp, flags); see evio6/evio6_raw.hpp
+ *  - Optional CSV with the same columns
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "evio6/evio6_raw.hpp"
+#include "evio6/evio6_file.hpp"
+
+/**
+ * Frame number continuity of one ROC
+ */
+struct RocSummary {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint32_t firstFrame = 0;
+    uint32_t lastFrame = 0;
+    uint64_t gaps = 0;         // Frame number jumped forward by more than one
+    uint64_t backwards = 0;    // Frame number repeated or went back
+};
+
+/**
+ * Binary index writer (header rewritten with the entry count on close)
+ */
+class IndexWriter {
+private:
+    std::ofstream out;
+    std::vector<evio6::RawIndexEntry> batch;
+    uint64_t count = 0;
+    std::string path;
+
+    static constexpr size_t BATCH_ENTRIES = 64 * 1024;
+
+    bool flush() {
+        out.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(evio6::RawIndexEntry));
+        batch.clear();
+        return static_cast<bool>(out);
+    }
+
+public:
+    bool open(const std::string& file) {
+        path = file;
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "ERROR: Cannot create index file: " << path << std::endl;
+            return false;
+        }
+        evio6::RawIndexHeader header = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        batch.reserve(BATCH_ENTRIES);
+        return static_cast<bool>(out);
+    }
+
+    bool add(const evio6::RawFrame& frame) {
+        batch.push_back(evio6::toIndexEntry(frame));
+        count++;
+        return batch.size() < BATCH_ENTRIES || flush();
+    }
+
+    bool close(uint64_t captureBytes) {
+        if (!out.is_open()) return true;
+        bool ok = flush();
+
+        evio6::RawIndexHeader header = {};
+        header.magic = evio6::RAW_INDEX_MAGIC;
+        header.version = evio6::RAW_INDEX_VERSION;
+        header.byteOrderMark = evio6::RAW_INDEX_BYTE_ORDER_MARK;
+        header.entryBytes = sizeof(evio6::RawIndexEntry);
+        header.entryCount = count;
+        header.captureBytes = captureBytes;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.close();
+
+        ok = ok && !out.fail();
+        if (!ok) {
+            std::cerr << "ERROR: Failed writing index file: " << path << std::endl;
+        }
+        return ok;
+    }
+};
+
+struct ScanOptions {
+    std::string indexPath;     // Empty: <capture>.idx
+    bool writeIndex = true;
+    std::string csvPath;
+    bool verbose = false;
+};
+
+/**
+ * Scan one capture; returns false if it has errors
+ */
+bool scanCapture(const std::string& path, const ScanOptions& options) {
+    evio6::MappedFile capture;
+    if (!capture.open(path)) {
+        return false;
+    }
+
+    IndexWriter index;
+    std::string indexPath = options.indexPath.empty() ? path + ".idx" : options.indexPath;
+    if (options.writeIndex && !index.open(indexPath)) {
+        return false;
+    }
+
+    std::ofstream csv;
+    if (!options.csvPath.empty()) {
+        csv.open(options.csvPath, std::ios::trunc);
+        if (!csv) {
+            std::cerr << "ERROR: Cannot create CSV file: " << options.csvPath << std::endl;
+            return false;
+        }
+        csv << "offset,length,roc_id,frame_number,timestamp,stream_status,flags\n";
+    }
+
+    // ========================================================================
+    // Walk the capture
+    // ========================================================================
+    auto start = std::chrono::steady_clock::now();
+
+    evio6::RawCaptureScanner scanner(capture.data(), capture.size());
+    std::map<uint16_t, RocSummary> rocs;
+    uint64_t swappedFrames = 0;
+    uint64_t lengthMismatches = 0;
+    uint64_t badStructure = 0;
+    bool ioOk = true;
+
+    evio6::RawFrame frame;
+    while (scanner.next(frame)) {
+        RocSummary& roc = rocs[frame.rocId];
+        if (roc.frames == 0) {
+            roc.firstFrame = frame.frameNumber;
+        } else {
+            // Wrap-safe: 32-bit frame numbers roll over in long runs
+            int32_t step = evio6::frameDistance(roc.lastFrame, frame.frameNumber);
+            if (step > 1) {
+                roc.gaps++;
+            } else if (step <= 0) {
+                roc.backwards++;
+            }
+        }
+        roc.lastFrame = frame.frameNumber;
+        roc.frames++;
+        roc.bytes += frame.length;
+
+        if (frame.flags & evio6::RawFlag::BYTE_SWAPPED) swappedFrames++;
+        if (frame.flags & evio6::RawFlag::LENGTH_MISMATCH) lengthMismatches++;
+        if (frame.flags & evio6::RawFlag::BAD_STRUCTURE) badStructure++;
+
+        if (options.verbose && (frame.flags & ~evio6::RawFlag::BYTE_SWAPPED)) {
+            std::cerr << "WARNING: Frame at offset " << frame.offset << " (ROC " << frame.rocId
+                      << ", frame " << frame.frameNumber << "):"
+                      << ((frame.flags & evio6::RawFlag::LENGTH_MISMATCH) ? " block/ROC bank length mismatch" : "")
+                      << ((frame.flags & evio6::RawFlag::BAD_STRUCTURE) ? " bad header structure" : "")
+                      << std::endl;
+        }
+
+        if (options.writeIndex && ioOk && !index.add(frame)) {
+            ioOk = false;
+        }
+        if (csv.is_open()) {
+            csv << frame.offset << ',' << frame.length << ',' << frame.rocId << ','
+                << frame.frameNumber << ',' << frame.timestamp << ','
+                << static_cast<int>(frame.streamStatus) << ',' << static_cast<int>(frame.flags) << '\n';
+        }
+    }
+
+    if (options.writeIndex) {
+        ioOk = index.close(capture.size()) && ioOk;
+    }
+    if (csv.is_open()) {
+        csv.close();
+        if (csv.fail()) {
+            std::cerr << "ERROR: Failed writing CSV file: " << options.csvPath << std::endl;
+            ioOk = false;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // ========================================================================
+    // Summary
+    // ========================================================================
+    std::cout << "=== Raw Capture Scan: " << path << " ===\n";
+    std::cout << "Capture Size: " << capture.size() << " bytes\n";
+    std::cout << "Frames: " << scanner.framesFound << " (" << rocs.size() << " ROCs)\n";
+    for (const auto& [rocId, roc] : rocs) {
+        std::cout << "  ROC " << std::setw(5) << rocId
+                  << ": frames=" << roc.frames
+                  << " bytes=" << roc.bytes
+                  << " frame_numbers=" << roc.firstFrame << ".." << roc.lastFrame
+                  << " gaps=" << roc.gaps
+                  << " backwards=" << roc.backwards << "\n";
+    }
+    std::cout << "Frames Not In Host Byte Order: " << swappedFrames << "\n";
+    std::cout << "Block/ROC Bank Length Mismatches: " << lengthMismatches << "\n";
+    std::cout << "Bad Header Structure: " << badStructure << "\n";
+    std::cout << "Resyncs: " << scanner.resyncs << " (" << scanner.skippedBytes << " bytes skipped)\n";
+    std::cout << "Truncated Tail: " << scanner.truncatedBytes << " bytes\n";
+    if (options.writeIndex) {
+        std::cout << "Index: " << indexPath << "\n";
+    }
+    if (!options.csvPath.empty()) {
+        std::cout << "CSV: " << options.csvPath << "\n";
+    }
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Elapsed: " << elapsed << " sec ("
+              << std::setprecision(1) << (elapsed > 0 ? capture.size() / elapsed / 1e6 : 0.0)
+              << " MB/sec)\n";
+
+    bool ok = ioOk && scanner.badFrames == 0 && scanner.resyncs == 0 && scanner.truncatedBytes == 0;
+    std::cout << "Status: " << (ok ? "SUCCESS" : "ERRORS FOUND") << "\n";
+    std::cout << "==========================\n";
+    return ok;
+}
+
+void printHelp(const char* progName) {
+    std::cout << "Raw Capture Scanner and Indexer\n\n";
+    std::cout << "Validates reassembly-only captures (concatenated CODA ROC frames, e.g.\n";
+    std::cout << "events.bin) and writes a per-frame index.\n\n";
+    std::cout << "Usage: " << progName << " <capture>... [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help        Show this help message\n";
+    std::cout << "  --index FILE      Index output path (single capture only; default: <capture>.idx)\n";
+    std::cout << "  --no-index        Validate only, do not write an index\n";
+    std::cout << "  --csv FILE        Also write the index as CSV (single capture only)\n";
+    std::cout << "  -v, --verbose     Report every bad frame\n\n";
+    std::cout << "Index format: see src/evio6/evio6_raw.hpp (RawIndexHeader, RawIndexEntry)\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " /data/run42/events.bin --csv /data/run42/events.csv\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    ScanOptions options;
+    std::vector<std::string> captures;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            printHelp(argv[0]);
+            return 0;
+        } else if (arg == "--index" && i + 1 < argc) {
+            options.indexPath = argv[++i];
+        } else if (arg == "--no-index") {
+            options.writeIndex = false;
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csvPath = argv[++i];
+        } else if (arg == "-v" || arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg[0] != '-') {
+            captures.push_back(arg);
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    if (captures.empty()) {
+        std::cerr << "ERROR: No capture files specified\n";
+        printHelp(argv[0]);
+        return 1;
+    }
+    if (captures.size() > 1 && (!options.indexPath.empty() || !options.csvPath.empty())) {
+        std::cerr << "ERROR: --index and --csv take a single capture\n";
+        return 1;
+    }
+
+    bool ok = true;
+    for (const auto& capture : captures) {
+        ok = scanCapture(capture, options) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,358 @@
+/**
+ * EVIO6 Truncated File Recovery
+ *
+ * After a crash or power loss the last file of a run ends in a partial
+ * record, has no trailer, and its file header still carries the placeholder
+ * record count and trailer position. This tool makes such a file readable
+ * again, in place:
+ *
+ *  - The records are found by hopping the record length chain: only the
+ *    14-word record header of each record is read (pread through a 16 KB
+ *    window that small records share), so the cost is proportional to the
+ *    number of records, not to the file size.
+ *  - The hop stops at the first record whose header is not a valid EVIO-6
+ *    record header (length, version, magic) or that runs past the end of
+ *    the file, or at an existing trailer.
+ *  - The last records found are then checked in full with
+ *    validateAggregatedRecord(): a record whose header made it to disk but
+ *    whose payload did not is dropped as well, back to the first complete one.
+ *  - The file is truncated after that record, a trailer holding the
+ *    (record length, event count) index is appended, and the file header
+ *    is patched with the record count, trailer position and trailer-index
+ *    bit. All other file header words (file number, user header) are kept.
+ *
+ * The trailer is written and synced before the header, so an interrupted
+ * recovery can simply be run again. Files in either header byte order are
+ * handled; the order is taken from the file header magic number.
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "evio6/evio6_view.hpp"
+#include "evio6/evio6_validate.hpp"
+#include "evio6/evio6_writer.hpp"
+
+struct RecoverOptions {
+    bool dryRun = false;
+    bool verbose = false;
+};
+
+/**
+ * Outcome of the header hop over one file
+ */
+struct HopResult {
+    std::vector<uint64_t> offsets;   // Start of each complete record
+    std::vector<uint32_t> index;     // (length bytes, event count) per record
+    uint32_t lastRecordNumber = 0;
+    uint64_t stopOffset = 0;         // End of the last complete record
+    bool foundTrailer = false;       // Hop ended at an existing trailer
+    uint64_t trailerBytes = 0;
+    const char* stopReason = "end of file";
+};
+
+/**
+ * Read exactly bytes at offset; false on a short read or error
+ */
+static bool readAt(int fd, uint8_t* out, size_t bytes, uint64_t offset) {
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = pread(fd, out + done, bytes - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool writeAt(int fd, const uint8_t* data, size_t bytes, uint64_t offset) {
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = pwrite(fd, data + done, bytes - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * Record headers read through a small window: one pread per record when
+ * records are large, one per window when many small records share it
+ */
+class HeaderReader {
+private:
+    int fd;
+    uint64_t fileBytes;
+    std::vector<uint8_t> window;
+    uint64_t windowStart = 0;
+    size_t windowBytes = 0;
+
+public:
+    static constexpr size_t WINDOW_BYTES = 16 * 1024;
+
+    HeaderReader(int file, uint64_t bytes) : fd(file), fileBytes(bytes), window(WINDOW_BYTES) {}
+
+    // Pointer to the header at offset, or nullptr if it cannot be read
+    const uint8_t* header(uint64_t offset) {
+        if (offset < windowStart || offset + evio6::HEADER_BYTES > windowStart + windowBytes) {
+            size_t want = static_cast<size_t>(std::min<uint64_t>(WINDOW_BYTES, fileBytes - offset));
+            if (want < evio6::HEADER_BYTES || !readAt(fd, window.data(), want, offset)) return nullptr;
+            windowStart = offset;
+            windowBytes = want;
+        }
+        return window.data() + (offset - windowStart);
+    }
+};
+
+/**
+ * Hop the record length chain from firstOffset, reading record headers only
+ */
+template <typename Order>
+HopResult hopRecords(int fd, uint64_t firstOffset, uint64_t fileBytes) {
+    HopResult hop;
+    HeaderReader reader(fd, fileBytes);
+    uint64_t pos = firstOffset;
+
+    while (pos < fileBytes) {
+        const uint8_t* header = reader.header(pos);
+        if (header == nullptr) {
+            hop.stopReason = "partial record header";
+            break;
+        }
+
+        evio6::BasicRecordView<Order> record(header, evio6::HEADER_BYTES);
+        if (record.headerLength() != evio6::HEADER_WORDS || record.version() != evio6::VERSION ||
+            !record.hasExpectedMagic() || record.lengthWords() < evio6::HEADER_WORDS) {
+            hop.stopReason = "invalid record header";
+            break;
+        }
+        if (record.sizeBytes() > fileBytes - pos) {
+            hop.stopReason = "partial record";
+            break;
+        }
+        if (record.isTrailer()) {
+            hop.foundTrailer = true;
+            hop.trailerBytes = record.sizeBytes();
+            hop.stopReason = "trailer";
+            break;
+        }
+
+        hop.offsets.push_back(pos);
+        hop.index.push_back(static_cast<uint32_t>(record.sizeBytes()));
+        hop.index.push_back(record.eventCount());
+        hop.lastRecordNumber = record.recordNumber();
+        pos += record.sizeBytes();
+    }
+
+    hop.stopOffset = pos;
+    return hop;
+}
+
+/**
+ * Recover one file; returns false if it could not be recovered
+ */
+template <typename Order>
+bool recoverFile(const std::string& path, int fd, uint64_t fileBytes, const uint8_t* fileHeader,
+                 const RecoverOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+
+    evio6::BasicFileHeaderView<Order> header(fileHeader, evio6::HEADER_BYTES);
+    if (!header.valid() || header.fileId() != evio6::FILE_ID || header.recordsOffset() > fileBytes) {
+        std::cerr << "ERROR: Invalid EVIO6 file header: " << path << std::endl;
+        return false;
+    }
+
+    HopResult hop = hopRecords<Order>(fd, header.recordsOffset(), fileBytes);
+
+    // The hop only saw headers: check the tail records in full, dropping any
+    // whose payload did not make it to disk
+    uint64_t droppedRecords = 0;
+    std::vector<uint8_t> record;
+    while (!hop.offsets.empty()) {
+        uint64_t offset = hop.offsets.back();
+        size_t bytes = hop.index[hop.index.size() - evio6::TRAILER_INDEX_WORDS_PER_RECORD];
+        record.resize(bytes);
+        evio6::RecordError error = evio6::RecordError::TRUNCATED;
+        if (readAt(fd, record.data(), bytes, offset)) {
+            error = evio6::validateAggregatedRecord<Order>(record.data(), bytes);
+        }
+        if (error == evio6::RecordError::NONE) {
+            hop.lastRecordNumber = evio6::BasicRecordView<Order>(record.data(), bytes).recordNumber();
+            break;
+        }
+        if (options.verbose) {
+            std::cerr << "WARNING: Dropping record at offset " << offset << ": "
+                      << evio6::recordErrorName(error) << std::endl;
+        }
+        hop.offsets.pop_back();
+        hop.index.resize(hop.index.size() - evio6::TRAILER_INDEX_WORDS_PER_RECORD);
+        hop.stopOffset = offset;
+        hop.foundTrailer = false;
+        droppedRecords++;
+    }
+
+    const size_t recordCount = hop.offsets.size();
+    const uint64_t trailerPosition = hop.stopOffset;
+    const uint64_t recoveredBytes = trailerPosition + evio6::trailerBytes(recordCount);
+    const uint64_t cutBytes = fileBytes > trailerPosition ? fileBytes - trailerPosition : 0;
+
+    // Already closed properly: trailer right after the last record, header pointing at it
+    bool complete = hop.foundTrailer && droppedRecords == 0 &&
+                    trailerPosition + hop.trailerBytes == fileBytes &&
+                    header.recordCount() == recordCount &&
+                    header.trailerPosition() == trailerPosition &&
+                    header.hasTrailerIndex();
+
+    bool ok = true;
+    if (!complete && !options.dryRun) {
+        uint32_t recordNumber = recordCount > 0 ? hop.lastRecordNumber + 1 : 1;
+        std::vector<uint8_t> trailer(evio6::trailerBytes(recordCount));
+        evio6::encodeTrailer<Order>(trailer.data(), recordNumber, hop.index.data(), recordCount);
+
+        // Patch the existing header in place, keeping file number and user header
+        uint8_t patched[evio6::HEADER_BYTES];
+        std::memcpy(patched, fileHeader, sizeof(patched));
+        Order::store(patched + evio6::FileWord::RECORD_COUNT * 4, static_cast<uint32_t>(recordCount));
+        Order::store(patched + evio6::FileWord::BIT_INFO * 4,
+                     header.bitInfoVersion() | evio6::BitInfo::TRAILER_WITH_INDEX);
+        Order::store(patched + evio6::FileWord::TRAILER_POS_LO * 4, static_cast<uint32_t>(trailerPosition & 0xFFFFFFFF));
+        Order::store(patched + evio6::FileWord::TRAILER_POS_HI * 4, static_cast<uint32_t>(trailerPosition >> 32));
+
+        if (!writeAt(fd, trailer.data(), trailer.size(), trailerPosition) ||
+            ftruncate(fd, static_cast<off_t>(recoveredBytes)) != 0 ||
+            fdatasync(fd) != 0 ||
+            !writeAt(fd, patched, sizeof(patched), 0) ||
+            fdatasync(fd) != 0) {
+            std::cerr << "ERROR: Failed writing " << path << ": " << std::strerror(errno) << std::endl;
+            ok = false;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // ========================================================================
+    // Summary
+    // ========================================================================
+    std::cout << "=== Recover: " << path << " ===\n";
+    std::cout << "Byte Order: " << (Order::IS_BIG ? "big-endian" : "little-endian") << "\n";
+    std::cout << "File Size: " << fileBytes << " bytes\n";
+    std::cout << "Records: " << recordCount << " (header said " << header.recordCount() << ")\n";
+    std::cout << "Hop Stopped At: " << hop.stopReason << "\n";
+    std::cout << "Dropped Incomplete Records: " << droppedRecords << "\n";
+    if (complete) {
+        std::cout << "Action: none, file already has a trailer and a final header\n";
+    } else {
+        std::cout << "Truncated Tail: " << cutBytes << " bytes\n";
+        std::cout << "Trailer Position: " << trailerPosition << "\n";
+        std::cout << "Recovered Size: " << recoveredBytes << " bytes\n";
+        std::cout << "Action: " << (options.dryRun ? "none (dry run)" : (ok ? "recovered" : "failed")) << "\n";
+    }
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Elapsed: " << elapsed << " sec\n";
+    std::cout << "==========================\n";
+    return ok;
+}
+
+bool recoverPath(const std::string& path, const RecoverOptions& options) {
+    int fd = ::open(path.c_str(), options.dryRun ? O_RDONLY : O_RDWR);
+    if (fd < 0) {
+        std::cerr << "ERROR: Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Only headers are read, scattered over the file: no readahead
+    posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+
+    struct stat st;
+    uint8_t fileHeader[evio6::HEADER_BYTES];
+    bool ok = false;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < evio6::HEADER_BYTES ||
+        !readAt(fd, fileHeader, sizeof(fileHeader), 0)) {
+        std::cerr << "ERROR: File shorter than an EVIO6 file header: " << path << std::endl;
+    } else {
+        uint64_t fileBytes = static_cast<uint64_t>(st.st_size);
+        switch (evio6::detectByteOrder(fileHeader, sizeof(fileHeader))) {
+            case evio6::DataByteOrder::BIG:
+                ok = recoverFile<evio6::BigEndian>(path, fd, fileBytes, fileHeader, options);
+                break;
+            case evio6::DataByteOrder::LITTLE:
+                ok = recoverFile<evio6::LittleEndian>(path, fd, fileBytes, fileHeader, options);
+                break;
+            default:
+                std::cerr << "ERROR: Bad file header magic number: " << path << std::endl;
+                break;
+        }
+    }
+
+    ::close(fd);
+    return ok;
+}
+
+void printHelp(const char* progName) {
+    std::cout << "EVIO6 Truncated File Recovery\n\n";
+    std::cout << "Cuts a file that ends in a partial record (crash, power loss) back to its\n";
+    std::cout << "last complete record, appends a trailer with a record index and patches\n";
+    std::cout << "the file header. The file is modified in place.\n\n";
+    std::cout << "Usage: " << progName << " <file>... [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help        Show this help message\n";
+    std::cout << "  -n, --dry-run     Report what would be done, do not modify the file\n";
+    std::cout << "  -v, --verbose     Report every dropped record\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " /data/run42/frames_thread3_file0007.evio\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    RecoverOptions options;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            printHelp(argv[0]);
+            return 0;
+        } else if (arg == "-n" || arg == "--dry-run") {
+            options.dryRun = true;
+        } else if (arg == "-v" || arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg[0] != '-') {
+            files.push_back(arg);
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    if (files.empty()) {
+        std::cerr << "ERROR: No files specified\n";
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    bool ok = true;
+    for (const auto& file : files) {
+        ok = recoverPath(file, options) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,919 @@
+/**
+ * CODA Secondary Aggregator (SAGG)
+ *
+ * One coda-fb node builds what its NICs and cores can take. Larger ROC sets
+ * are split over several coda-fb nodes (primary aggregators), each building
+ * 0xFF60 frames for its own ROCs, and this program merges their frames:
+ *
+ *  - Inputs are the upstream nodes' outputs: an ET system each (the local
+ *    ET system of a node is shared memory), attached through a blocking
+ *    station, or the node's EVIO6 files (frame-ordered, e.g. evio_merge
+ *    output), memory-mapped.
+ *  - Upstream frames are parsed in place: record header, 0xFF60 bank, TSS
+ *    and AIS only. ROC banks are not walked or re-validated; each upstream
+ *    frame contributes its AIS entries and its ROC banks as one block.
+ *  - Frames are aligned by 64-bit event number (record user register 1,
+ *    or the unwrapped TSS frame number for files without it). A frame with
+ *    parts from every input is written at once. Otherwise it is written
+ *    partial once every ordered (file) input has moved past its event number,
+ *    or once it has waited --timeout ms for the missing inputs.
+ *  - The merged frame gets a new record header, 0xFF60 bank, SIB, TSS (frame
+ *    number, average timestamp) and an AIS with all upstream entries; the
+ *    ROC bank blocks are copied once, from the ET event or mapped file
+ *    straight into the output buffer or output ET event. ET events are
+ *    handed back upstream after their frame has been written.
+ *
+ * Output: rolled-over EVIO6 files with trailer indexes ({prefix}_file{NNNN}.evio)
+ * and/or an ET system (GRAND_CENTRAL), headers big-endian.
+ *
+ * ET inputs and output need the ET library (built with it when found).
+ *
+ * Copyright (c) 2024, Jefferson Science Associates
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <csignal>
+#include <filesystem>
+#include <glob.h>
+
+#include "evio6/evio6_view.hpp"
+#include "evio6/evio6_writer.hpp"
+#include "evio6/evio6_file.hpp"
+
+#ifdef ENABLE_FRAME_BUILDER
+#include <et.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static std::atomic<bool> stopRequested{false};
+
+static void stopHandler(int) {
+    stopRequested = true;
+}
+
+// ============================================================================
+// Upstream Frames
+// ============================================================================
+
+/**
+ * One upstream aggregated frame, parsed in place (data not owned)
+ */
+struct UpstreamFrame {
+    uint64_t eventNumber = 0;
+    uint64_t timestamp = 0;
+    bool errorFlag = false;                  // Stream status bit 7 of the upstream frame
+    std::vector<evio6::SliceRef> entries;    // AIS entries (rocId, status)
+    evio6::RocBlock rocs{nullptr, 0};        // All ROC banks of the frame
+    size_t input = 0;
+    void* event = nullptr;                   // ET event to hand back (null for files)
+    std::shared_ptr<const evio6::MappedFile> mapping;  // Keeps file data mapped
+};
+
+/**
+ * Parse the frame metadata of one record (ROC banks are left alone)
+ *
+ * @return false if the record is not an aggregated frame
+ */
+template <typename Order>
+bool parseUpstream(const uint8_t* data, size_t bytes, evio6::FrameNumberUnwrapper& unwrap,
+                   UpstreamFrame& frame) {
+    evio6::BasicRecordView<Order> record(data, bytes);
+    if (!record.valid() || !record.hasExpectedMagic() || record.isTrailer()) return false;
+
+    evio6::BasicAggregatedBankView<Order> bank = evio6::aggregatedBank(record);
+    if (!bank.valid() || !bank.hasExpectedTag()) return false;
+    evio6::BasicStreamInfoBankView<Order> sib = bank.streamInfo();
+    if (!sib.valid() || !sib.hasExpectedTag()) return false;
+    evio6::BasicTimeSliceSegmentView<Order> tss = sib.timeSlice();
+    if (!tss.valid() || !tss.hasExpectedTag()) return false;
+    evio6::BasicAggregationInfoSegmentView<Order> ais = sib.aggregationInfo();
+    if (!ais.valid() || !ais.hasExpectedTag()) return false;
+
+    uint32_t frameNumber = tss.frameNumber();
+    uint64_t registered = record.userRegister1();
+    int64_t unwrapped = unwrap(frameNumber);
+    frame.eventNumber = (static_cast<uint32_t>(registered) == frameNumber)
+                            ? registered : static_cast<uint64_t>(unwrapped);
+    frame.timestamp = tss.timestamp();
+    frame.errorFlag = (bank.streamStatus() & 0x80) != 0;
+
+    frame.entries.clear();
+    for (size_t i = 0; i < ais.rocCount(); i++) {
+        frame.entries.push_back({nullptr, 0, ais.rocId(i), ais.rocStatus(i)});
+    }
+    auto rocs = bank.rocBanks();
+    frame.rocs = {rocs.data(), rocs.sizeBytes()};
+    return true;
+}
+
+bool parseUpstream(const uint8_t* data, size_t bytes, evio6::FrameNumberUnwrapper& unwrap,
+                   UpstreamFrame& frame) {
+    if (bytes < evio6::HEADER_BYTES) return false;
+    if (evio6::loadBE32(data + evio6::RecordWord::MAGIC * 4) == evio6::MAGIC_SWAPPED) {
+        return parseUpstream<evio6::LittleEndian>(data, bytes, unwrap, frame);
+    }
+    return parseUpstream<evio6::BigEndian>(data, bytes, unwrap, frame);
+}
+
+// ============================================================================
+// Inputs
+// ============================================================================
+
+/**
+ * One upstream coda-fb node
+ */
+class FrameInput {
+public:
+    std::string name;
+    uint64_t frames = 0;       // Aggregated frames received
+    uint64_t malformed = 0;    // Records that are not aggregated frames (skipped)
+    bool finished = false;
+
+    explicit FrameInput(const std::string& inputName) : name(inputName) {}
+    virtual ~FrameInput() = default;
+
+    /**
+     * Append the frames available now (waiting up to waitMs for the first)
+     */
+    virtual void poll(std::vector<UpstreamFrame>& out, int waitMs, size_t index) = 0;
+
+    // Inputs that deliver frames in event number order (files)
+    virtual bool ordered() const { return false; }
+
+    // Event number below which an ordered input delivers nothing more
+    virtual uint64_t frontier() const { return 0; }
+
+    // Frame written (or dropped): give its buffer back
+    virtual void release(UpstreamFrame&) {}
+    virtual void flushReleased() {}
+};
+
+/**
+ * EVIO6 files of one node, in order, memory-mapped one at a time
+ */
+class FileInput : public FrameInput {
+private:
+    std::vector<std::string> files;
+    size_t nextFile = 0;
+    std::shared_ptr<evio6::MappedFile> mapped;
+    evio6::FrameNumberUnwrapper unwrap;
+    size_t pos = 0;
+    size_t end = 0;
+    uint64_t lastEvent = 0;
+
+    static constexpr size_t FRAMES_PER_POLL = 64;
+
+    bool openNextFile() {
+        while (nextFile < files.size()) {
+            const std::string& path = files[nextFile++];
+            auto file = std::make_shared<evio6::MappedFile>();
+            if (!file->open(path)) continue;
+
+            evio6::DataByteOrder order = evio6::detectByteOrder(file->data(), file->size());
+            size_t first = 0;
+            if (order == evio6::DataByteOrder::LITTLE) {
+                evio6::BasicFileView<evio6::LittleEndian> view(file->data(), file->size());
+                if (view.valid()) first = view.header().recordsOffset();
+            } else if (order == evio6::DataByteOrder::BIG) {
+                evio6::FileView view(file->data(), file->size());
+                if (view.valid()) first = view.header().recordsOffset();
+            }
+            if (first == 0) {
+                std::cerr << "WARNING: Not an EVIO6 file, skipped: " << path << std::endl;
+                continue;
+            }
+            mapped = std::move(file);
+            pos = first;
+            end = mapped->size();
+            return true;
+        }
+        return false;
+    }
+
+public:
+    uint64_t outOfOrder = 0;
+
+    FileInput(const std::string& pattern, std::vector<std::string> paths)
+        : FrameInput(pattern), files(std::move(paths)) {}
+
+    void poll(std::vector<UpstreamFrame>& out, int, size_t index) override {
+        size_t added = 0;
+        while (added < FRAMES_PER_POLL) {
+            if (!mapped || pos + evio6::HEADER_BYTES > end) {
+                mapped.reset();
+                if (!openNextFile()) {
+                    finished = true;
+                    return;
+                }
+            }
+
+            const uint8_t* data = mapped->data() + pos;
+            const bool little = evio6::detectByteOrder(data, end - pos) == evio6::DataByteOrder::LITTLE;
+            size_t bytes = static_cast<size_t>(little ? evio6::LittleEndian::load(data)
+                                                      : evio6::BigEndian::load(data)) * 4;
+            if (bytes < evio6::HEADER_BYTES || bytes > end - pos) {
+                std::cerr << "WARNING: Truncated or bad record at offset " << pos << " in "
+                          << files[nextFile - 1] << ", remainder skipped" << std::endl;
+                mapped.reset();
+                continue;
+            }
+            pos += bytes;
+
+            UpstreamFrame frame;
+            if (!parseUpstream(data, bytes, unwrap, frame)) {
+                bool trailer = little ? evio6::BasicRecordView<evio6::LittleEndian>(data, bytes).isTrailer()
+                                      : evio6::RecordView(data, bytes).isTrailer();
+                if (!trailer) malformed++;
+                continue;
+            }
+            if (frames > 0 && frame.eventNumber < lastEvent) outOfOrder++;
+            lastEvent = std::max(lastEvent, frame.eventNumber);
+            frame.input = index;
+            frame.mapping = mapped;
+            out.push_back(std::move(frame));
+            frames++;
+            added++;
+        }
+    }
+
+    bool ordered() const override { return true; }
+    uint64_t frontier() const override { return finished ? UINT64_MAX : lastEvent; }
+};
+
+#ifdef ENABLE_FRAME_BUILDER
+/**
+ * ET system of one node, read through a blocking station of our own
+ */
+class EtInput : public FrameInput {
+private:
+    et_sys_id system = nullptr;
+    et_stat_id station = 0;
+    et_att_id attachment = 0;
+    evio6::FrameNumberUnwrapper unwrap;
+    std::vector<et_event*> toPut;
+
+    static constexpr int CHUNK = 64;
+
+public:
+    uint64_t etErrors = 0;
+
+    explicit EtInput(const std::string& spec) : FrameInput(spec) {}
+
+    ~EtInput() override {
+        if (system) {
+            flushReleased();
+            et_station_detach(system, attachment);
+            et_close(system);
+        }
+    }
+
+    /**
+     * Open the node's ET system and attach to (or create) the station
+     *
+     * @param file  ET system file
+     * @param host  Host (empty: broadcast)
+     * @param port  Server port (0: default)
+     */
+    bool open(const std::string& file, const std::string& host, int port, const std::string& stationName) {
+        et_openconfig openConfig;
+        et_open_config_init(&openConfig);
+        if (!host.empty()) {
+            et_open_config_sethost(openConfig, host.c_str());
+            et_open_config_setcast(openConfig, ET_DIRECT);
+        } else {
+            et_open_config_setcast(openConfig, ET_BROADCAST);
+        }
+        if (port > 0) {
+            et_open_config_setserverport(openConfig, static_cast<unsigned short>(port));
+        }
+        et_open_config_setwait(openConfig, ET_OPEN_WAIT);
+        struct timespec timeout;
+        timeout.tv_sec = 10;
+        timeout.tv_nsec = 0;
+        et_open_config_settimeout(openConfig, timeout);
+        int status = et_open(&system, file.c_str(), openConfig);
+        et_open_config_destroy(openConfig);
+        if (status != ET_OK) {
+            std::cerr << "ERROR: Failed to open ET system '" << name << "': " << status << std::endl;
+            system = nullptr;
+            return false;
+        }
+
+        // Blocking, select-all: every frame of the node comes through here
+        et_statconfig stationConfig;
+        et_station_config_init(&stationConfig);
+        et_station_config_setblock(stationConfig, ET_STATION_BLOCKING);
+        et_station_config_setselect(stationConfig, ET_STATION_SELECT_ALL);
+        et_station_config_setuser(stationConfig, ET_STATION_USER_MULTI);
+        status = et_station_create(system, &station, stationName.c_str(), stationConfig);
+        et_station_config_destroy(stationConfig);
+        if (status != ET_OK && status != ET_EXISTS) {
+            std::cerr << "ERROR: Failed to create ET station '" << stationName << "' on '" << name
+                      << "': " << status << std::endl;
+            return false;
+        }
+        status = et_station_attach(system, station, &attachment);
+        if (status != ET_OK) {
+            std::cerr << "ERROR: Failed to attach to ET station '" << stationName << "' on '" << name
+                      << "': " << status << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void poll(std::vector<UpstreamFrame>& out, int waitMs, size_t index) override {
+        et_event* events[CHUNK];
+        int count = 0;
+        struct timespec wait;
+        wait.tv_sec = waitMs / 1000;
+        wait.tv_nsec = static_cast<long>(waitMs % 1000) * 1000000L;
+
+        int status = et_events_get(system, attachment, events, waitMs > 0 ? ET_TIMED : ET_ASYNC,
+                                   &wait, CHUNK, &count);
+        if (status == ET_ERROR_TIMEOUT || status == ET_ERROR_EMPTY) return;
+        if (status != ET_OK) {
+            if (etErrors++ == 0) {
+                std::cerr << "ERROR: et_events_get failed on '" << name << "': " << status << std::endl;
+            }
+            return;
+        }
+
+        for (int i = 0; i < count; i++) {
+            void* data = nullptr;
+            size_t length = 0;
+            et_event_getdata(events[i], &data);
+            et_event_getlength(events[i], &length);
+
+            UpstreamFrame frame;
+            if (!parseUpstream(static_cast<const uint8_t*>(data), length, unwrap, frame)) {
+                malformed++;
+                toPut.push_back(events[i]);
+                continue;
+            }
+            frame.input = index;
+            frame.event = events[i];
+            out.push_back(std::move(frame));
+            frames++;
+        }
+    }
+
+    void release(UpstreamFrame& frame) override {
+        if (frame.event) {
+            toPut.push_back(static_cast<et_event*>(frame.event));
+            frame.event = nullptr;
+        }
+    }
+
+    void flushReleased() override {
+        if (toPut.empty()) return;
+        int status = et_events_put(system, attachment, toPut.data(), static_cast<int>(toPut.size()));
+        if (status != ET_OK && etErrors++ == 0) {
+            std::cerr << "ERROR: et_events_put failed on '" << name << "': " << status << std::endl;
+        }
+        toPut.clear();
+    }
+};
+
+/**
+ * Parse "et:FILE[@HOST[:PORT]]"
+ */
+bool parseEtSpec(const std::string& spec, std::string& file, std::string& host, int& port) {
+    std::string rest = spec.substr(3);
+    size_t at = rest.find('@');
+    file = rest.substr(0, at);
+    host.clear();
+    port = 0;
+    if (at != std::string::npos) {
+        std::string hostPort = rest.substr(at + 1);
+        size_t colon = hostPort.rfind(':');
+        host = hostPort.substr(0, colon);
+        if (colon != std::string::npos) {
+            port = std::atoi(hostPort.c_str() + colon + 1);
+            if (port <= 0) return false;
+        }
+    }
+    return !file.empty();
+}
+#endif
+
+// ============================================================================
+// Merged Output
+// ============================================================================
+
+class MergedOutput {
+private:
+    std::unique_ptr<evio6::FileWriter> files;
+#ifdef ENABLE_FRAME_BUILDER
+    et_sys_id etSystem = nullptr;
+    et_att_id etAttachment = 0;
+    size_t etEventSize = 0;
+#endif
+
+public:
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t errors = 0;
+
+    ~MergedOutput() { close(); }
+
+    void openFiles(const std::string& dir, const std::string& prefix, uint64_t maxFileBytes) {
+        files = std::make_unique<evio6::FileWriter>(dir, prefix, maxFileBytes);
+    }
+
+#ifdef ENABLE_FRAME_BUILDER
+    bool openET(const std::string& file, const std::string& host, int port, size_t eventSize) {
+        et_openconfig openConfig;
+        et_open_config_init(&openConfig);
+        if (!host.empty()) {
+            et_open_config_sethost(openConfig, host.c_str());
+            et_open_config_setcast(openConfig, ET_DIRECT);
+        } else {
+            et_open_config_setcast(openConfig, ET_BROADCAST);
+        }
+        if (port > 0) {
+            et_open_config_setserverport(openConfig, static_cast<unsigned short>(port));
+        }
+        et_open_config_setwait(openConfig, ET_OPEN_WAIT);
+        struct timespec timeout;
+        timeout.tv_sec = 10;
+        timeout.tv_nsec = 0;
+        et_open_config_settimeout(openConfig, timeout);
+        int status = et_open(&etSystem, file.c_str(), openConfig);
+        et_open_config_destroy(openConfig);
+        if (status != ET_OK) {
+            std::cerr << "ERROR: Failed to open output ET system '" << file << "': " << status << std::endl;
+            etSystem = nullptr;
+            return false;
+        }
+        status = et_station_attach(etSystem, 0, &etAttachment);  // GRAND_CENTRAL
+        if (status != ET_OK) {
+            std::cerr << "ERROR: Failed to attach to GRAND_CENTRAL: " << status << std::endl;
+            et_close(etSystem);
+            etSystem = nullptr;
+            return false;
+        }
+        etEventSize = eventSize;
+        return true;
+    }
+#endif
+
+    /**
+     * Write one merged frame to every output
+     */
+    bool write(const evio6::FrameInfo& info, const std::vector<evio6::SliceRef>& entries,
+               const std::vector<evio6::RocBlock>& blocks) {
+        const size_t recordBytes = evio6::mergedRecordBytes(entries.size(), blocks.data(), blocks.size());
+        bool ok = true;
+
+        if (files && !files->writeMergedRecord(info, entries.data(), entries.size(), blocks.data(), blocks.size())) {
+            ok = false;
+        }
+
+#ifdef ENABLE_FRAME_BUILDER
+        if (etSystem) {
+            et_event* event = nullptr;
+            int numRead = 0;
+            struct timespec timeout;
+            timeout.tv_sec = 2;
+            timeout.tv_nsec = 0;
+            int status = et_events_new(etSystem, etAttachment, &event, ET_TIMED, &timeout,
+                                       etEventSize, 1, &numRead);
+            if (status != ET_OK) {
+                std::cerr << "ERROR: Failed to get new ET event: " << status << std::endl;
+                ok = false;
+            } else {
+                void* data = nullptr;
+                size_t length = 0;
+                et_event_getdata(event, &data);
+                et_event_getlength(event, &length);
+                if (recordBytes > length) {
+                    std::cerr << "ERROR: Merged frame too large for ET event: " << recordBytes
+                              << " > " << length << std::endl;
+                    et_events_dump(etSystem, etAttachment, &event, 1);
+                    ok = false;
+                } else {
+                    evio6::encodeMergedRecord(static_cast<uint8_t*>(data), info, entries.data(), entries.size(),
+                                              blocks.data(), blocks.size());
+                    et_event_setlength(event, recordBytes);
+                    if (et_events_put(etSystem, etAttachment, &event, 1) != ET_OK) {
+                        std::cerr << "ERROR: Failed to put ET event" << std::endl;
+                        ok = false;
+                    }
+                }
+            }
+        }
+#endif
+
+        if (ok) {
+            frames++;
+            bytes += recordBytes;
+        } else {
+            errors++;
+        }
+        return ok;
+    }
+
+    bool close() {
+        bool ok = true;
+        if (files) {
+            ok = files->close();
+        }
+#ifdef ENABLE_FRAME_BUILDER
+        if (etSystem) {
+            et_station_detach(etSystem, etAttachment);
+            et_close(etSystem);
+            etSystem = nullptr;
+        }
+#endif
+        return ok;
+    }
+
+    uint32_t filesWritten() const { return files ? files->filesWritten() : 0; }
+};
+
+// ============================================================================
+// Alignment
+// ============================================================================
+
+/**
+ * Upstream frames waiting for the other inputs, by event number
+ */
+class FrameAligner {
+private:
+    struct Pending {
+        std::vector<UpstreamFrame> parts;
+        uint64_t inputMask = 0;      // Inputs present (bit per input)
+        std::chrono::steady_clock::time_point firstSeen;
+    };
+
+    std::vector<std::unique_ptr<FrameInput>>& inputs;
+    MergedOutput& output;
+    int timeoutMs;
+    uint64_t allInputs;
+    std::map<uint64_t, Pending> pending;
+    uint64_t decidedBelow = 0;       // Event numbers below this were written partial (or late)
+    uint32_t recordNumber = 1;
+
+    std::vector<evio6::SliceRef> entries;
+    std::vector<evio6::RocBlock> blocks;
+
+    void emit(uint64_t eventNumber, std::vector<UpstreamFrame>& parts) {
+        entries.clear();
+        blocks.clear();
+        uint64_t timestampSum = 0;
+        bool error = false;
+
+        std::sort(parts.begin(), parts.end(),
+                  [](const UpstreamFrame& a, const UpstreamFrame& b) { return a.input < b.input; });
+        for (const auto& part : parts) {
+            entries.insert(entries.end(), part.entries.begin(), part.entries.end());
+            blocks.push_back(part.rocs);
+            timestampSum += part.timestamp / parts.size();
+            error = error || part.errorFlag;
+        }
+
+        evio6::FrameInfo info;
+        info.recordNumber = recordNumber++;
+        info.frameNumber = static_cast<uint32_t>(eventNumber);
+        info.eventNumber = eventNumber;
+        info.timestamp = timestampSum;
+        info.streamStatus = static_cast<uint8_t>(((error ? 1 : 0) << 7) | (entries.size() & 0x7F));
+        output.write(info, entries, blocks);
+
+        for (auto& part : parts) {
+            inputs[part.input]->release(part);
+        }
+    }
+
+public:
+    uint64_t complete = 0;
+    uint64_t partial = 0;
+    uint64_t late = 0;           // Parts that arrived after their frame was written partial
+    uint64_t duplicates = 0;     // Second part from the same input for one frame
+
+    FrameAligner(std::vector<std::unique_ptr<FrameInput>>& in, MergedOutput& out, int timeout)
+        : inputs(in), output(out), timeoutMs(timeout),
+          allInputs(in.size() >= 64 ? ~0ULL : (1ULL << in.size()) - 1) {}
+
+    void add(UpstreamFrame&& frame) {
+        uint64_t key = frame.eventNumber;
+        if (key < decidedBelow && pending.find(key) == pending.end()) {
+            // Its frame is already out: write this part on its own
+            late++;
+            partial++;
+            std::vector<UpstreamFrame> parts;
+            parts.push_back(std::move(frame));
+            emit(key, parts);
+            return;
+        }
+
+        auto [it, inserted] = pending.try_emplace(key);
+        Pending& p = it->second;
+        if (inserted) {
+            p.firstSeen = std::chrono::steady_clock::now();
+        }
+        uint64_t bit = 1ULL << std::min<size_t>(frame.input, 63);
+        if (p.inputMask & bit) duplicates++;
+        p.inputMask |= bit;
+        p.parts.push_back(std::move(frame));
+
+        if (p.inputMask == allInputs) {
+            complete++;
+            emit(key, p.parts);
+            pending.erase(it);
+        }
+    }
+
+    /**
+     * Write the oldest frames that can no longer be completed: every ordered
+     * input is past them, or they waited out the timeout (all if force)
+     */
+    void flush(bool force) {
+        uint64_t frontier = UINT64_MAX;
+        for (const auto& input : inputs) {
+            frontier = std::min(frontier, input->ordered() ? input->frontier() : 0);
+        }
+        auto now = std::chrono::steady_clock::now();
+
+        while (!pending.empty()) {
+            auto it = pending.begin();
+            bool timedOut = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                now - it->second.firstSeen).count() > timeoutMs;
+            if (!force && it->first >= frontier && !timedOut) break;
+
+            partial++;
+            emit(it->first, it->second.parts);
+            decidedBelow = std::max(decidedBelow, it->first + 1);
+            pending.erase(it);
+        }
+    }
+
+    size_t waiting() const { return pending.size(); }
+};
+
+// ============================================================================
+// Main
+// ============================================================================
+
+void printHelp(const char* progName) {
+    std::cout << "CODA Secondary Aggregator\n\n";
+    std::cout << "Merges the aggregated frames of several coda-fb nodes, each building\n";
+    std::cout << "part of the ROC set, into one stream of time frames.\n\n";
+    std::cout << "Usage: " << progName << " --input SRC --input SRC... [options]\n\n";
+    std::cout << "Inputs (one per upstream node, at least two):\n";
+#ifdef ENABLE_FRAME_BUILDER
+    std::cout << "  et:FILE[@HOST[:PORT]]  Node's ET system, read through a blocking station\n";
+#endif
+    std::cout << "  'PATTERN'              Node's EVIO6 files (glob, read in name order;\n";
+    std::cout << "                         must be frame-ordered, e.g. evio_merge output)\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help              Show this help message\n";
+    std::cout << "  --input SRC             Add an upstream node (repeatable)\n";
+    std::cout << "  --out-dir D             Write merged frames to files in D\n";
+    std::cout << "  --out-prefix P          Output file prefix (default: frames_sagg)\n";
+    std::cout << "  --max-file-size GB      Output file rollover size (default: 2)\n";
+#ifdef ENABLE_FRAME_BUILDER
+    std::cout << "  --et-file FILE          Put merged frames into this ET system\n";
+    std::cout << "  --et-host HOST          Output ET host (default: broadcast)\n";
+    std::cout << "  --et-port N             Output ET port (default: 0, ET default)\n";
+    std::cout << "  --et-event-size BYTES   Output ET event size (default: 2097152)\n";
+    std::cout << "  --station NAME          Input ET station name (default: sagg)\n";
+#endif
+    std::cout << "  --timeout MS            Wait for missing nodes before writing a partial\n";
+    std::cout << "                          frame (default: 1000)\n";
+    std::cout << "  --stats-interval S      Periodic statistics, 0 = off (default: 10)\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " --input et:/tmp/et_node1@node1:23911 --input et:/tmp/et_node2@node2:23911 "
+              << "--out-dir /data/run42\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> inputSpecs;
+    std::string outDir;
+    std::string outPrefix = "frames_sagg";
+    double maxFileSizeGB = 2.0;
+    std::string etFile;
+    std::string etHost;
+    int etPort = 0;
+    size_t etEventSize = 2 * 1024 * 1024;
+    std::string stationName = "sagg";
+    int timeoutMs = 1000;
+    int statsInterval = 10;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            printHelp(argv[0]);
+            return 0;
+        } else if (arg == "--input" && i + 1 < argc) {
+            inputSpecs.push_back(argv[++i]);
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (arg == "--out-prefix" && i + 1 < argc) {
+            outPrefix = argv[++i];
+        } else if (arg == "--max-file-size" && i + 1 < argc) {
+            maxFileSizeGB = std::atof(argv[++i]);
+        } else if (arg == "--et-file" && i + 1 < argc) {
+            etFile = argv[++i];
+        } else if (arg == "--et-host" && i + 1 < argc) {
+            etHost = argv[++i];
+        } else if (arg == "--et-port" && i + 1 < argc) {
+            etPort = std::atoi(argv[++i]);
+        } else if (arg == "--et-event-size" && i + 1 < argc) {
+            etEventSize = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--station" && i + 1 < argc) {
+            stationName = argv[++i];
+        } else if (arg == "--timeout" && i + 1 < argc) {
+            timeoutMs = std::atoi(argv[++i]);
+        } else if (arg == "--stats-interval" && i + 1 < argc) {
+            statsInterval = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    if (inputSpecs.size() < 2) {
+        std::cerr << "ERROR: At least two --input nodes are needed\n";
+        return 1;
+    }
+    if (outDir.empty() && etFile.empty()) {
+        std::cerr << "ERROR: No output (--out-dir or --et-file)\n";
+        return 1;
+    }
+    if (maxFileSizeGB <= 0 || timeoutMs < 1 || statsInterval < 0) {
+        std::cerr << "ERROR: --max-file-size and --timeout must be positive\n";
+        return 1;
+    }
+#ifndef ENABLE_FRAME_BUILDER
+    (void)etPort;
+    (void)etEventSize;
+    if (!etFile.empty()) {
+        std::cerr << "ERROR: ET output needs a build with the ET library\n";
+        return 1;
+    }
+#endif
+
+    // ========================================================================
+    // Open inputs and outputs
+    // ========================================================================
+    std::vector<std::unique_ptr<FrameInput>> inputs;
+    for (const auto& spec : inputSpecs) {
+        if (spec.rfind("et:", 0) == 0) {
+#ifdef ENABLE_FRAME_BUILDER
+            std::string file, host;
+            int port;
+            if (!parseEtSpec(spec, file, host, port)) {
+                std::cerr << "ERROR: Bad ET input '" << spec << "' (et:FILE[@HOST[:PORT]])\n";
+                return 1;
+            }
+            auto input = std::make_unique<EtInput>(spec);
+            if (!input->open(file, host, port, stationName)) {
+                return 1;
+            }
+            inputs.push_back(std::move(input));
+#else
+            std::cerr << "ERROR: ET input '" << spec << "' needs a build with the ET library\n";
+            return 1;
+#endif
+        } else {
+            glob_t matches;
+            std::vector<std::string> paths;
+            if (glob(spec.c_str(), 0, nullptr, &matches) == 0) {
+                for (size_t i = 0; i < matches.gl_pathc; i++) {
+                    paths.push_back(matches.gl_pathv[i]);
+                }
+            }
+            globfree(&matches);
+            if (paths.empty()) {
+                std::cerr << "ERROR: No files match input '" << spec << "'\n";
+                return 1;
+            }
+            inputs.push_back(std::make_unique<FileInput>(spec, std::move(paths)));
+        }
+    }
+    if (inputs.size() > 64) {
+        std::cerr << "ERROR: At most 64 inputs\n";
+        return 1;
+    }
+
+    MergedOutput output;
+    if (!outDir.empty()) {
+        std::error_code ec;
+        fs::create_directories(outDir, ec);
+        if (ec) {
+            std::cerr << "ERROR: Cannot create output directory: " << outDir << " (" << ec.message() << ")\n";
+            return 1;
+        }
+        output.openFiles(outDir, outPrefix, static_cast<uint64_t>(maxFileSizeGB * 1024 * 1024 * 1024));
+    }
+#ifdef ENABLE_FRAME_BUILDER
+    if (!etFile.empty() && !output.openET(etFile, etHost, etPort, etEventSize)) {
+        return 1;
+    }
+#endif
+
+    signal(SIGINT, stopHandler);
+    signal(SIGTERM, stopHandler);
+
+    std::cout << "CODA Secondary Aggregator\n";
+    std::cout << "=========================\n";
+    for (size_t i = 0; i < inputs.size(); i++) {
+        std::cout << "Input " << i << ": " << inputs[i]->name << "\n";
+    }
+    if (!outDir.empty()) std::cout << "Output: " << outDir << "/" << outPrefix << "_file*.evio\n";
+    if (!etFile.empty()) std::cout << "Output: ET " << etFile << "\n";
+    std::cout << "Timeout: " << timeoutMs << " ms\n\n";
+
+    // ========================================================================
+    // Merge loop
+    // ========================================================================
+    auto start = std::chrono::steady_clock::now();
+    auto nextReport = start + std::chrono::seconds(statsInterval);
+    FrameAligner aligner(inputs, output, timeoutMs);
+    std::vector<UpstreamFrame> batch;
+
+    while (!stopRequested) {
+        // Ordered inputs are read only while they are the furthest behind,
+        // so the others do not run ahead and fill the aligner
+        uint64_t orderedFrontier = UINT64_MAX;
+        bool active = false;
+        for (const auto& input : inputs) {
+            if (input->finished) continue;
+            active = true;
+            if (input->ordered()) orderedFrontier = std::min(orderedFrontier, input->frontier());
+        }
+        if (!active) break;
+
+        batch.clear();
+        for (size_t i = 0; i < inputs.size(); i++) {
+            FrameInput& input = *inputs[i];
+            if (input.finished || (input.ordered() && input.frontier() > orderedFrontier)) continue;
+            input.poll(batch, batch.empty() ? 10 : 0, i);
+        }
+        for (auto& frame : batch) {
+            aligner.add(std::move(frame));
+        }
+        aligner.flush(false);
+        for (auto& input : inputs) {
+            input->flushReleased();
+        }
+
+        if (statsInterval > 0 && std::chrono::steady_clock::now() >= nextReport) {
+            nextReport += std::chrono::seconds(statsInterval);
+            std::cout << "[SAGG] merged " << output.frames << " frames (" << aligner.complete << " complete, "
+                      << aligner.partial << " partial), " << aligner.waiting() << " waiting" << std::endl;
+        }
+    }
+
+    aligner.flush(true);
+    for (auto& input : inputs) {
+        input->flushReleased();
+    }
+    bool ok = output.close() && output.errors == 0;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // ========================================================================
+    // Summary
+    // ========================================================================
+    std::cout << "\n=== Secondary Aggregation Summary ===\n";
+    for (size_t i = 0; i < inputs.size(); i++) {
+        std::cout << "Input " << i << ": " << inputs[i]->frames << " frames, "
+                  << inputs[i]->malformed << " malformed\n";
+    }
+    std::cout << "Frames Written: " << output.frames << " (" << aligner.complete << " complete, "
+              << aligner.partial << " partial)\n";
+    std::cout << "Late Parts: " << aligner.late << "\n";
+    std::cout << "Duplicate Parts: " << aligner.duplicates << "\n";
+    std::cout << "Output Errors: " << output.errors << "\n";
+    if (!outDir.empty()) {
+        std::cout << "Files Written: " << output.filesWritten() << "\n";
+    }
+    std::cout << "Bytes Written: " << output.bytes << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Elapsed: " << elapsed << " sec ("
+              << std::setprecision(1) << (elapsed > 0 ? output.frames / elapsed : 0.0) << " frames/sec)\n";
+    std::cout << "Status: " << (ok ? "SUCCESS" : "ERRORS FOUND") << "\n";
+    std::cout << "=====================================\n";
+    return ok ? 0 : 1;
+}